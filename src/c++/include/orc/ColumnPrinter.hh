@@ -31,6 +31,17 @@
 
 namespace orc {
 
+  /**
+   * How FLOAT and DOUBLE values are written.
+   */
+  enum FloatFormat {
+    // printf's %.7g for FLOAT and %.14g for DOUBLE, which may lose
+    // precision
+    FloatFormat_FIXED_PRECISION = 0,
+    // the shortest text that reads back as exactly the same value
+    FloatFormat_SHORTEST = 1
+  };
+
   class ColumnPrinter {
   protected:
     std::string &buffer;
@@ -41,11 +52,69 @@ namespace orc {
     ColumnPrinter(std::string&);
     virtual ~ColumnPrinter();
     virtual void printRow(uint64_t rowId) = 0;
+
+    /**
+     * Print rows [0, numRows) of the current batch one after another,
+     * rendering a whole column at a time instead of a value at a time.
+     * On return, row i occupies [offsets[i], offsets[i+1]) of the buffer
+     * and offsets[0] is the size the buffer had before the call.
+     */
+    virtual void printRows(uint64_t numRows, std::vector<uint64_t>& offsets);
+
+    /**
+     * Print rows [0, numRows) of the current batch, each one followed by
+     * a newline. The output is the same as calling printRow for each row,
+     * but it is rendered column by column.
+     */
+    void printBatch(uint64_t numRows);
+
     // should be called once at the start of each batch of rows
     virtual void reset(const ColumnVectorBatch& batch);
   };
 
   ORC_UNIQUE_PTR<ColumnPrinter> createColumnPrinter(std::string&,
-                                                    const Type* type);
+                                                    const Type* type,
+                                                    FloatFormat floatFormat =
+                                                FloatFormat_FIXED_PRECISION);
+
+  /**
+   * A destination for printed rows. Printers render into getBuffer() and
+   * commit() hands the text over to be written once enough of it has
+   * collected. The buffer is the same string object for the life of the
+   * sink, so it can be passed to createColumnPrinter.
+   */
+  class OutputSink {
+  public:
+    virtual ~OutputSink();
+
+    /**
+     * The buffer to append printed text to.
+     */
+    virtual std::string& getBuffer() = 0;
+
+    /**
+     * Write the buffer out if it has reached the sink's buffer size. The
+     * buffer is empty afterwards if it was written.
+     */
+    virtual void commit() = 0;
+
+    /**
+     * Write out everything in the buffer and wait until it has all been
+     * written. Any error from an earlier write is thrown here or from
+     * commit.
+     */
+    virtual void flush() = 0;
+  };
+
+  /**
+   * Create a sink that writes to a file descriptor, which stays open. Full
+   * buffers are written by a background thread while the caller renders
+   * into a second buffer, so printing and I/O overlap.
+   * @param fd the file descriptor to write to
+   * @param bufferSize the number of bytes to collect before writing
+   */
+  ORC_UNIQUE_PTR<OutputSink> createFileDescriptorSink(int fd,
+                                                      uint64_t bufferSize =
+                                                      4 * 1024 * 1024);
 }
 #endif
@@ -51,7 +51,10 @@ namespace orc {
 
     /**
      * Read length bytes from the file starting at offset into
-     * the buffer starting at buf.
+     * the buffer starting at buf. When RowReaderOptions::setPrefetchDepth
+     * is set, read, getData and prefetch are also called from background
+     * threads, so they must be safe to call concurrently. The streams that
+     * readFile returns for local files are.
      * @param buf the starting position of a buffer.
      * @param length the number of bytes to read.
      * @param offset the position in the stream to read from.
@@ -64,6 +67,24 @@ namespace orc {
      * Get the name of the stream for error messages.
      */
     virtual const std::string& getName() const = 0;
+
+    /**
+     * Get the bytes of the file without copying them, if the stream can.
+     * A memory mapped file can; the default implementation can't.
+     * @param offset the position in the stream of the first byte
+     * @param length the number of bytes
+     * @return the bytes, valid for the life of the stream, or nullptr if
+     *   they have to be read with read()
+     */
+    virtual const char* getData(uint64_t offset, uint64_t length);
+
+    /**
+     * Hint that the given bytes are about to be read in order. The default
+     * implementation does nothing.
+     * @param offset the position in the stream of the first byte
+     * @param length the number of bytes
+     */
+    virtual void prefetch(uint64_t offset, uint64_t length);
   };
 
   /**
@@ -108,12 +129,30 @@ namespace orc {
    */
   ORC_UNIQUE_PTR<InputStream> readFile(const std::string& path);
 
+  /**
+   * Create a stream to a local file or HDFS file if path begins with
+   * "hdfs://". Local files are memory mapped if the options ask for it.
+   * @param path the name of the file in the local file system or HDFS
+   * @param options the options for reading the file
+   */
+  ORC_UNIQUE_PTR<InputStream> readFile(const std::string& path,
+                                       const ReaderOptions& options);
+
   /**
    * Create a stream to a local file.
    * @param path the name of the file in the local file system
    */
   ORC_UNIQUE_PTR<InputStream> readLocalFile(const std::string& path);
 
+  /**
+   * Create a stream to a local file.
+   * @param path the name of the file in the local file system
+   * @param useMemoryMapping whether to map the file into memory and
+   *   hand out its bytes without copying them
+   */
+  ORC_UNIQUE_PTR<InputStream> readLocalFile(const std::string& path,
+                                            bool useMemoryMapping);
+
   /**
    * Create a stream to an HDFS file.
    * @param path the uri of the file in HDFS
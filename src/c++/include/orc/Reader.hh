@@ -37,6 +37,108 @@ namespace orc {
   // classes that hold data members so we can maintain binary compatibility
   struct ReaderOptionsPrivate;
   struct RowReaderOptionsPrivate;
+  struct ReaderMetricsPrivate;
+  struct ReaderMetricsCounters;
+
+  class SearchArgument;
+
+  /**
+   * The reads of one kind of stream. A read that covers streams of several
+   * kinds counts as a read of each of them.
+   */
+  struct StreamReadMetrics {
+    uint64_t readCalls;
+    uint64_t bytesRead;
+  };
+
+  /**
+   * The work of one compression codec. Chunks that were stored
+   * uncompressed count toward the bytes, but not toward the blocks or the
+   * time.
+   */
+  struct DecompressionMetrics {
+    uint64_t blocks;
+    uint64_t compressedBytes;
+    uint64_t decompressedBytes;
+    uint64_t nanoseconds;
+  };
+
+  /**
+   * The work of the reader of one column. The time of a column includes
+   * the time of its children.
+   */
+  struct DecodeMetrics {
+    uint64_t calls;
+    uint64_t values;
+    uint64_t nanoseconds;
+  };
+
+  /**
+   * Counters of the work that row readers do, to tell whether reading a
+   * file is bound by I/O, decompression or decoding. One object may be
+   * shared by the readers of many files on many threads. Each row reader
+   * counts on its own and adds its counts to this object at stripe
+   * boundaries, when it reaches the end of the file, when it is destroyed
+   * and when RowReader::getReaderMetrics is called.
+   *
+   * Streams that are handed out from a memory mapped file count as read
+   * when the reader prefetches them. The top-level column is timed in
+   * RowReader::next and every nested column is timed separately, so the
+   * time of a column includes the time of its children.
+   */
+  class ReaderMetrics {
+  private:
+    ORC_UNIQUE_PTR<ReaderMetricsPrivate> privateBits;
+
+    friend void addReaderMetrics(ReaderMetrics& metrics,
+                                 ReaderMetricsCounters& counters);
+
+  public:
+    ReaderMetrics();
+    virtual ~ReaderMetrics();
+
+    /**
+     * Get the reads from the file by stream kind.
+     */
+    std::map<StreamKind, StreamReadMetrics> getStreamReads() const;
+
+    /**
+     * Get the decompression work by codec.
+     */
+    std::map<CompressionKind, DecompressionMetrics> getDecompression() const;
+
+    /**
+     * Get the decoding work by column id.
+     */
+    std::map<uint64_t, DecodeMetrics> getColumnDecoding() const;
+
+    /**
+     * Get the number of stripes that were read.
+     */
+    uint64_t getStripesRead() const;
+
+    /**
+     * Get the number of stripes that predicate push down skipped.
+     */
+    uint64_t getStripesSkipped() const;
+
+    /**
+     * Get the number of row groups in the stripes that were read that
+     * were not skipped.
+     */
+    uint64_t getRowGroupsRead() const;
+
+    /**
+     * Get the number of row groups that predicate push down skipped,
+     * including those of the skipped stripes.
+     */
+    uint64_t getRowGroupsSkipped() const;
+
+    /**
+     * Set all of the counters back to zero.
+     */
+    void reset();
+  };
 
   /**
    * Options for creating a Reader.
@@ -81,6 +183,19 @@ namespace orc {
      */
     ReaderOptions& setTailLocation(uint64_t offset);
 
+    /**
+     * Set whether readFile maps local files into memory, so the stripe
+     * data is decoded in place instead of being copied into buffers.
+     * The file must not be truncated while it is mapped. Defaults to false.
+     */
+    ReaderOptions& setUseMemoryMapping(bool useMemoryMapping);
+
+    /**
+     * Set the object that the row readers of this file add their counters
+     * to. Defaults to none, which doesn't count anything.
+     */
+    ReaderOptions& setReaderMetrics(std::shared_ptr<ReaderMetrics> metrics);
+
     /**
      * Get the stream to write warnings or errors to.
      */
@@ -101,6 +216,40 @@ namespace orc {
      * Get the memory allocator.
      */
     MemoryPool* getMemoryPool() const;
+
+    /**
+     * Should readFile map local files into memory?
+     */
+    bool getUseMemoryMapping() const;
+
+    /**
+     * Get the object that the row readers add their counters to.
+     */
+    std::shared_ptr<ReaderMetrics> getReaderMetrics() const;
+  };
+
+  /**
+   * Picks the rows that a RowReader returns. See
+   * RowReaderOptions::setRowFilter.
+   */
+  class RowFilter {
+  public:
+    virtual ~RowFilter();
+
+    /**
+     * Choose the rows of a batch to keep.
+     *
+     * With RowReaderOptions::setEnableLazyDecoding, a dictionary encoded
+     * string column arrives as an EncodedStringVectorBatch whose data and
+     * length are not filled in. Read such a column through its index and
+     * dictionary (StringDictionary::getValueByIndex); check the type of the
+     * field with dynamic_cast before using data and length.
+     * @param batch a StructVectorBatch whose fields hold the filter
+     *    columns, in the order they were given to setRowFilter
+     * @param keep one entry for each row of the batch, all true on entry.
+     *    Set the entries of the rows to drop to false.
+     */
+    virtual void filter(const ColumnVectorBatch& batch, char* keep) const = 0;
   };
 
   /**
@@ -196,6 +345,98 @@ namespace orc {
      */
     bool getEnableLazyDecoding() const;
 
+    /**
+     * Set a search argument for predicate push down. The row reader uses
+     * the file, stripe and row group statistics and any bloom filters to
+     * skip the stripes and row groups where no row can match. The rows
+     * that are read are not filtered further.
+     */
+    RowReaderOptions& searchArgument(ORC_UNIQUE_PTR<SearchArgument> sargs);
+
+    /**
+     * Get the search argument for predicate push down, if any.
+     */
+    std::shared_ptr<SearchArgument> getSearchArgument() const;
+
+    /**
+     * Read the selected columns of each stripe with a few large reads
+     * into one buffer instead of reading each stream in small pieces.
+     * The buffer holds the selected data of a whole stripe, so this trades
+     * memory for fewer reads. Defaults to false.
+     */
+    RowReaderOptions& setEnableCoalescedReads(bool enable);
+
+    /**
+     * Should the stripe data be read with coalesced reads?
+     */
+    bool getEnableCoalescedReads() const;
+
+    /**
+     * Set the largest gap in bytes between two streams that are still
+     * read together when reads are coalesced. The bytes in the gap are
+     * read and thrown away. Defaults to 1 MB.
+     */
+    RowReaderOptions& setCoalescedReadGap(uint64_t gap);
+
+    /**
+     * Get the largest gap between two streams that are read together.
+     */
+    uint64_t getCoalescedReadGap() const;
+
+    /**
+     * Set the number of stripes to read ahead on background threads while
+     * the current stripe is decoded. Each prefetched stripe holds its
+     * selected data in memory, whether or not reads are coalesced. The
+     * input stream is read from the background threads, so it must be
+     * thread-safe; see InputStream::read. Defaults to 0, which reads each
+     * stripe when it is needed.
+     */
+    RowReaderOptions& setPrefetchDepth(uint64_t depth);
+
+    /**
+     * Get the number of stripes to read ahead.
+     */
+    uint64_t getPrefetchDepth() const;
+
+    /**
+     * Limit the memory that each batch takes up. next reads as many rows
+     * as are expected to fit in the given number of bytes, but never more
+     * than the capacity of the batch. The size of a row is the larger of
+     * the estimate from the statistics of the stripe and the sizes of the
+     * recent batches. Defaults to 0, which always fills the batch.
+     */
+    RowReaderOptions& setBatchMemoryBudget(uint64_t bytes);
+
+    /**
+     * Get the memory budget of a batch in bytes.
+     */
+    uint64_t getBatchMemoryBudget() const;
+
+    /**
+     * Only return the rows that pass a filter. For each batch, the filter
+     * columns are read first and passed to the filter. The other selected
+     * columns are only decoded for the rows it keeps, and the batches that
+     * next returns hold just those rows. The file must have a struct as
+     * the top-level object.
+     * @param fields the fields of the top-level struct that the filter
+     *    looks at, numbered as for include. They must be selected
+     *    and given only once.
+     * @param filter the filter
+     * @return this
+     */
+    RowReaderOptions& setRowFilter(const std::list<uint64_t>& fields,
+                                   std::shared_ptr<RowFilter> filter);
+
+    /**
+     * Get the row filter, if any.
+     */
+    std::shared_ptr<RowFilter> getRowFilter() const;
+
+    /**
+     * Get the fields that the row filter looks at.
+     */
+    const std::list<uint64_t>& getRowFilterFields() const;
+
     /**
      * Were the field ids set?
      */
@@ -484,6 +725,13 @@ namespace orc {
      */
     virtual std::map<uint32_t, BloomFilterIndex>
     getBloomFilters(uint32_t stripeIndex, const std::set<uint32_t>& included) const = 0;
+
+    /**
+     * Get the counters that the row readers of this file add to.
+     * @return the counters or nullptr if ReaderOptions::setReaderMetrics
+     *   wasn't called
+     */
+    virtual const ReaderMetrics* getReaderMetrics() const;
   };
 
   /**
@@ -528,6 +776,7 @@ namespace orc {
 
     /**
      * Get the row number of the first row in the previously read batch.
+     * With a row filter, that row may not be in the batch.
      * @return the row number of the previous batch.
      */
     virtual uint64_t getRowNumber() const = 0;
@@ -538,6 +787,12 @@ namespace orc {
      */
     virtual void seekToRow(uint64_t rowNumber) = 0;
 
+    /**
+     * Add the counts of this reader to the shared counters and get them.
+     * @return the counters or nullptr if ReaderOptions::setReaderMetrics
+     *   wasn't called
+     */
+    virtual const ReaderMetrics* getReaderMetrics();
   };
 }
 
@@ -217,6 +217,39 @@ namespace orc {
      * Get version of BloomFilter
      */
     BloomFilterVersion getBloomFilterVersion() const;
+
+    /**
+     * Set the number of worker threads that encode and compress the
+     * top-level columns of the file in parallel. Each column's streams are
+     * still written to the file in the usual order, so the file is the same
+     * as one written without workers. The memory pool must be safe to use
+     * from several threads at once. Defaults to 0, which does all the work
+     * on the thread that adds the rows.
+     */
+    WriterOptions& setWorkerThreads(uint64_t threads);
+
+    /**
+     * Get the number of worker threads.
+     */
+    uint64_t getWorkerThreads() const;
+
+    /**
+     * Set the number of finished stripes that may be waiting to be written
+     * by a background thread. While they are dictionary encoded, compressed
+     * and written, a fresh set of column writers takes the rows of the next
+     * stripe, so add doesn't stall whenever a stripe fills up. Each waiting
+     * stripe keeps its buffers, so memory use grows by up to this many
+     * stripes. Each set of column writers decides on dictionary encoding
+     * from the first stripe it writes. The memory pool must be safe to use
+     * from several threads at once. Defaults to 0, which writes each stripe
+     * on the thread that adds the rows.
+     */
+    WriterOptions& setMaxStripesInFlight(uint64_t stripes);
+
+    /**
+     * Get the number of stripes that may be waiting to be written.
+     */
+    uint64_t getMaxStripesInFlight() const;
   };
 
   class Writer {
@@ -0,0 +1,205 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "BitExpand.hh"
+#include "CpuInfo.hh"
+
+#include <string.h>
+
+#ifdef HAS_SSE2
+#include <emmintrin.h>
+#endif
+#ifdef HAS_AVX2
+#include <immintrin.h>
+#endif
+
+namespace orc {
+
+  static void expandByte(unsigned char byte, char* output) {
+    for (int bit = 0; bit < 8; ++bit) {
+      output[bit] = static_cast<char>((byte >> (7 - bit)) & 1);
+    }
+  }
+
+  /**
+   * Expand the bits of a partial last byte, which has to come first as the
+   * expansion works backwards.
+   * @return the number of bits that are set
+   */
+  static uint64_t expandTail(const char* input, uint64_t numBits,
+                             char* output) {
+    uint64_t fullBytes = numBits / 8;
+    uint64_t setBits = 0;
+    if (numBits % 8 != 0) {
+      unsigned char byte = static_cast<unsigned char>(input[fullBytes]);
+      for (uint64_t bit = 0; bit < numBits % 8; ++bit) {
+        char value = static_cast<char>((byte >> (7 - bit)) & 1);
+        output[fullBytes * 8 + bit] = value;
+        setBits += static_cast<uint64_t>(value);
+      }
+    }
+    return setBits;
+  }
+
+  uint64_t expandBitsScalar(const char* input, uint64_t numBits,
+                            char* output) {
+    uint64_t setBits = expandTail(input, numBits, output);
+    for (uint64_t i = numBits / 8; i > 0; --i) {
+      unsigned char byte = static_cast<unsigned char>(input[i - 1]);
+      expandByte(byte, output + (i - 1) * 8);
+      setBits += static_cast<uint64_t>(countSetBits(byte));
+    }
+    return setBits;
+  }
+
+#ifdef HAS_SSE2
+  uint64_t expandBitsSse2(const char* input, uint64_t numBits,
+                          char* output) {
+    // byte k of each group of 8 tests bit 7 - k
+    const __m128i bitMask = _mm_set_epi8(1, 2, 4, 8, 16, 32, 64, -128,
+                                         1, 2, 4, 8, 16, 32, 64, -128);
+    const __m128i one = _mm_set1_epi8(1);
+    uint64_t setBits = expandTail(input, numBits, output);
+    uint64_t i = numBits / 8;
+    if (i % 2 != 0) {
+      unsigned char byte = static_cast<unsigned char>(input[i - 1]);
+      expandByte(byte, output + (i - 1) * 8);
+      setBits += static_cast<uint64_t>(countSetBits(byte));
+      i -= 1;
+    }
+    for (; i > 0; i -= 2) {
+      uint16_t pair;
+      memcpy(&pair, input + i - 2, sizeof(pair));
+      // copy each of the two bytes across 8 bytes of the register
+      __m128i bytes = _mm_cvtsi32_si128(pair);
+      bytes = _mm_unpacklo_epi8(bytes, bytes);
+      bytes = _mm_unpacklo_epi16(bytes, bytes);
+      bytes = _mm_unpacklo_epi32(bytes, bytes);
+      __m128i bits = _mm_and_si128(
+        _mm_cmpeq_epi8(_mm_and_si128(bytes, bitMask), bitMask), one);
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(output + (i - 2) * 8),
+                       bits);
+      setBits += static_cast<uint64_t>(countSetBits(pair));
+    }
+    return setBits;
+  }
+#endif
+
+#ifdef HAS_AVX2
+  __attribute__((target("avx2")))
+  uint64_t expandBitsAvx2(const char* input, uint64_t numBits,
+                          char* output) {
+    // byte k of each group of 8 comes from input byte k / 8 and tests
+    // bit 7 - k % 8
+    const __m256i spread = _mm256_setr_epi8(0, 0, 0, 0, 0, 0, 0, 0,
+                                            1, 1, 1, 1, 1, 1, 1, 1,
+                                            2, 2, 2, 2, 2, 2, 2, 2,
+                                            3, 3, 3, 3, 3, 3, 3, 3);
+    const __m256i bitMask = _mm256_setr_epi8(-128, 64, 32, 16, 8, 4, 2, 1,
+                                             -128, 64, 32, 16, 8, 4, 2, 1,
+                                             -128, 64, 32, 16, 8, 4, 2, 1,
+                                             -128, 64, 32, 16, 8, 4, 2, 1);
+    const __m256i one = _mm256_set1_epi8(1);
+    uint64_t setBits = expandTail(input, numBits, output);
+    uint64_t i = numBits / 8;
+    for (; i % 4 != 0; --i) {
+      unsigned char byte = static_cast<unsigned char>(input[i - 1]);
+      expandByte(byte, output + (i - 1) * 8);
+      setBits += static_cast<uint64_t>(countSetBits(byte));
+    }
+    for (; i > 0; i -= 4) {
+      uint32_t word;
+      memcpy(&word, input + i - 4, sizeof(word));
+      __m256i bytes = _mm256_shuffle_epi8(
+        _mm256_set1_epi32(static_cast<int>(word)), spread);
+      __m256i bits = _mm256_and_si256(
+        _mm256_cmpeq_epi8(_mm256_and_si256(bytes, bitMask), bitMask), one);
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(output + (i - 4) * 8),
+                          bits);
+      setBits += static_cast<uint64_t>(countSetBits(word));
+    }
+    return setBits;
+  }
+#endif
+
+  void expandBytesToLongsScalar(int64_t* buffer, uint64_t numValues) {
+    for(size_t i=numValues - 1; i < numValues; --i) {
+      buffer[i] = reinterpret_cast<char *>(buffer)[i];
+    }
+  }
+
+#ifdef HAS_AVX2
+  __attribute__((target("avx2")))
+  void expandBytesToLongsAvx2(int64_t* buffer, uint64_t numValues) {
+    const char* bytes = reinterpret_cast<const char*>(buffer);
+    uint64_t i = numValues;
+    for (; i % 16 != 0; --i) {
+      buffer[i - 1] = bytes[i - 1];
+    }
+    for (; i > 0; i -= 16) {
+      // load all 16 bytes before the stores overwrite them
+      __m128i chunk =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + i - 16));
+      __m256i* output = reinterpret_cast<__m256i*>(buffer + i - 16);
+      _mm256_storeu_si256(output + 3,
+                          _mm256_cvtepi8_epi64(_mm_srli_si128(chunk, 12)));
+      _mm256_storeu_si256(output + 2,
+                          _mm256_cvtepi8_epi64(_mm_srli_si128(chunk, 8)));
+      _mm256_storeu_si256(output + 1,
+                          _mm256_cvtepi8_epi64(_mm_srli_si128(chunk, 4)));
+      _mm256_storeu_si256(output, _mm256_cvtepi8_epi64(chunk));
+    }
+  }
+#endif
+
+  typedef uint64_t (*BitExpander)(const char* input, uint64_t numBits,
+                                  char* output);
+  typedef void (*ByteWidener)(int64_t* buffer, uint64_t numValues);
+
+  static BitExpander chooseBitExpander() {
+#ifdef HAS_AVX2
+    if (cpuSupportsAvx2()) {
+      return expandBitsAvx2;
+    }
+#endif
+#ifdef HAS_SSE2
+    return expandBitsSse2;
+#else
+    return expandBitsScalar;
+#endif
+  }
+
+  static ByteWidener chooseByteWidener() {
+#ifdef HAS_AVX2
+    if (cpuSupportsAvx2()) {
+      return expandBytesToLongsAvx2;
+    }
+#endif
+    return expandBytesToLongsScalar;
+  }
+
+  uint64_t expandBits(const char* input, uint64_t numBits, char* output) {
+    static const BitExpander expand = chooseBitExpander();
+    return expand(input, numBits, output);
+  }
+
+  void expandBytesToLongs(int64_t* buffer, uint64_t numValues) {
+    static const ByteWidener widen = chooseByteWidener();
+    widen(buffer, numValues);
+  }
+}
@@ -0,0 +1,63 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ORC_BIT_EXPAND_HH
+#define ORC_BIT_EXPAND_HH
+
+#include "Adaptor.hh"
+
+#include <stdint.h>
+
+namespace orc {
+
+  /**
+   * Expand the first numBits bits of input, most significant bit first,
+   * into one byte per bit that is 0 or 1. The expansion works backwards
+   * from the last bit, so output may be the same buffer as input.
+   * @return the number of bits that are set
+   */
+  uint64_t expandBits(const char* input, uint64_t numBits, char* output);
+
+  /**
+   * Expand an array of bytes in place to the corresponding array of longs.
+   * Has to work backwards so that the data isn't clobbered during the
+   * expansion.
+   * @param buffer the array of chars and array of longs that need to be
+   *        expanded
+   * @param numValues the number of bytes to convert to longs
+   */
+  void expandBytesToLongs(int64_t* buffer, uint64_t numValues);
+
+  /**
+   * The variants that expandBits and expandBytesToLongs pick from, based on
+   * what the processor supports. They are declared here for testing.
+   */
+  uint64_t expandBitsScalar(const char* input, uint64_t numBits,
+                            char* output);
+  void expandBytesToLongsScalar(int64_t* buffer, uint64_t numValues);
+#ifdef HAS_SSE2
+  uint64_t expandBitsSse2(const char* input, uint64_t numBits, char* output);
+#endif
+#ifdef HAS_AVX2
+  // requires cpuSupportsAvx2()
+  uint64_t expandBitsAvx2(const char* input, uint64_t numBits, char* output);
+  void expandBytesToLongsAvx2(int64_t* buffer, uint64_t numValues);
+#endif
+}
+
+#endif
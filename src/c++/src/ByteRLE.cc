@@ -21,6 +21,7 @@
 #include <string.h>
 #include <utility>
 
+#include "BitExpand.hh"
 #include "ByteRLE.hh"
 #include "orc/Exceptions.hh"
 
@@ -299,6 +300,16 @@ namespace orc {
     // PASS
   }
 
+  uint64_t ByteRleDecoder::nextCountZeros(char* data, uint64_t numValues,
+                                          char* notNull) {
+    next(data, numValues, notNull);
+    uint64_t zeros = 0;
+    for (uint64_t i = 0; i < numValues; ++i) {
+      zeros += data[i] == 0 ? 1 : 0;
+    }
+    return zeros;
+  }
+
   class ByteRleDecoderImpl: public ByteRleDecoder {
   public:
     ByteRleDecoderImpl(std::unique_ptr<SeekableInputStream> input);
@@ -502,9 +513,16 @@ namespace orc {
      */
     virtual void next(char* data, uint64_t numValues, char* notNull);
 
+    virtual uint64_t nextCountZeros(char* data, uint64_t numValues,
+                                    char* notNull);
+
   protected:
     size_t remainingBits;
     char lastByte;
+
+  private:
+    // next, returning the number of values that are 1
+    uint64_t readBits(char* data, uint64_t numValues, char* notNull);
   };
 
   BooleanRleDecoderImpl::BooleanRleDecoderImpl
@@ -549,8 +567,20 @@ namespace orc {
 
   void BooleanRleDecoderImpl::next(char* data, uint64_t numValues,
                                    char* notNull) {
+    readBits(data, numValues, notNull);
+  }
+
+  uint64_t BooleanRleDecoderImpl::nextCountZeros(char* data,
+                                                 uint64_t numValues,
+                                                 char* notNull) {
+    return numValues - readBits(data, numValues, notNull);
+  }
+
+  uint64_t BooleanRleDecoderImpl::readBits(char* data, uint64_t numValues,
+                                           char* notNull) {
     // next spot to fill in
     uint64_t position = 0;
+    uint64_t setBits = 0;
 
     // use up any remaining bits
     if (notNull) {
@@ -559,6 +589,7 @@ namespace orc {
           remainingBits -= 1;
           data[position] = (static_cast<unsigned char>(lastByte) >>
                             remainingBits) & 0x1;
+          setBits += static_cast<uint64_t>(data[position]);
         } else {
           data[position] = 0;
         }
@@ -567,8 +598,9 @@ namespace orc {
     } else {
       while(remainingBits > 0 && position < numValues) {
         remainingBits -= 1;
-        data[position++] = (static_cast<unsigned char>(lastByte) >>
-                            remainingBits) & 0x1;
+        data[position] = (static_cast<unsigned char>(lastByte) >>
+                          remainingBits) & 0x1;
+        setBits += static_cast<uint64_t>(data[position++]);
       }
     }
 
@@ -593,27 +625,21 @@ namespace orc {
       ByteRleDecoderImpl::next(data + position, bytesRead, nullptr);
       lastByte = data[position + bytesRead - 1];
       remainingBits = bytesRead * 8 - nonNulls;
-      // expand the array backwards so that we don't clobber the data
-      uint64_t bitsLeft = bytesRead * 8 - remainingBits;
+      setBits += expandBits(data + position, nonNulls, data + position);
       if (notNull) {
-        for(int64_t i=static_cast<int64_t>(numValues) - 1;
-            i >= static_cast<int64_t>(position); --i) {
-          if (notNull[i]) {
-            uint64_t shiftPosn = (-bitsLeft) % 8;
-            data[i] = (data[position + (bitsLeft - 1) / 8] >> shiftPosn) & 0x1;
-            bitsLeft -= 1;
+        // move each value back to its row, working from the end so that
+        // nothing is overwritten before it has been moved
+        uint64_t source = position + nonNulls;
+        for (uint64_t i = numValues; source < i; --i) {
+          if (notNull[i - 1]) {
+            data[i - 1] = data[--source];
           } else {
-            data[i] = 0;
+            data[i - 1] = 0;
           }
         }
-      } else {
-        for(int64_t i=static_cast<int64_t>(numValues) - 1;
-            i >= static_cast<int64_t>(position); --i, --bitsLeft) {
-          uint64_t shiftPosn = (-bitsLeft) % 8;
-          data[i] = (data[position + (bitsLeft - 1) / 8] >> shiftPosn) & 0x1;
-        }
       }
     }
+    return setBits;
   }
 
   std::unique_ptr<ByteRleDecoder> createBooleanRleDecoder
@@ -79,6 +79,16 @@ namespace orc {
      *    pointer is not null, positions that are false are skipped.
      */
     virtual void next(char* data, uint64_t numValues, char* notNull) = 0;
+
+    /**
+     * Read a number of values into the batch, just as next does, and count
+     * the ones that are 0. Read from a PRESENT stream, that is the number
+     * of nulls.
+     * @return the number of values that are 0, including the ones masked
+     *    by notNull
+     */
+    virtual uint64_t nextCountZeros(char* data, uint64_t numValues,
+                                    char* notNull);
   };
 
   /**
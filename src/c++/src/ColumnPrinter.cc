@@ -17,16 +17,18 @@
  */
 
 #include "orc/ColumnPrinter.hh"
+#include "orc/Exceptions.hh"
 #include "orc/orc-config.hh"
 
 #include "Adaptor.hh"
+#include "JsonEscape.hh"
+#include "NumberFormat.hh"
 
 #include <limits>
 #include <sstream>
 #include <stdexcept>
-#include <time.h>
+#include <string.h>
 #include <typeinfo>
-#include <ctype.h>
 
 #ifndef _WIN32
 #include <math.h>
@@ -38,6 +40,55 @@
 
 namespace orc {
 
+  /**
+   * Base for printers of primitive columns. The derived class provides a
+   * non-virtual printValue(rowId) for non-null rows, which lets printRows
+   * render the whole column in a tight loop without any virtual calls.
+   */
+  template <class Derived>
+  class LeafColumnPrinter: public ColumnPrinter {
+  public:
+    LeafColumnPrinter(std::string& _buffer): ColumnPrinter(_buffer) {}
+    void printRow(uint64_t rowId) override;
+    void printRows(uint64_t numRows, std::vector<uint64_t>& offsets) override;
+  };
+
+  /**
+   * Formats a number of days since the epoch as a proleptic Gregorian
+   * date in the layout strftime uses for "%Y-%m-%d". The text of the last
+   * day is kept, since the values of a batch usually fall on a few days.
+   */
+  class DateFormatter {
+  private:
+    int64_t day;
+    bool valid;
+    // the year can have up to 11 characters
+    char text[20];
+    size_t length;
+
+  public:
+    DateFormatter(): day(0), valid(false), length(0) {}
+
+    /**
+     * Append the date to the buffer. Returns false if the year doesn't
+     * fit in a struct tm, which is when gmtime would have failed.
+     */
+    bool write(std::string& buffer, int64_t days) {
+      if (!valid || days != day) {
+        if (!format(days)) {
+          return false;
+        }
+        day = days;
+        valid = true;
+      }
+      buffer.append(text, length);
+      return true;
+    }
+
+  private:
+    bool format(int64_t days);
+  };
+
   class VoidColumnPrinter: public ColumnPrinter {
   public:
     VoidColumnPrinter(std::string&);
@@ -46,102 +97,122 @@ namespace orc {
     void reset(const ColumnVectorBatch& batch) override;
   };
 
-  class BooleanColumnPrinter: public ColumnPrinter {
+  class BooleanColumnPrinter: public LeafColumnPrinter<BooleanColumnPrinter> {
   private:
     const int64_t* data;
   public:
     BooleanColumnPrinter(std::string&);
     ~BooleanColumnPrinter() override {}
-    void printRow(uint64_t rowId) override;
+    void printValue(uint64_t rowId);
     void reset(const ColumnVectorBatch& batch) override;
   };
 
-  class LongColumnPrinter: public ColumnPrinter {
+  class LongColumnPrinter: public LeafColumnPrinter<LongColumnPrinter> {
   private:
     const int64_t* data;
   public:
     LongColumnPrinter(std::string&);
     ~LongColumnPrinter() override {}
-    void printRow(uint64_t rowId) override;
+    void printValue(uint64_t rowId);
     void reset(const ColumnVectorBatch& batch) override;
   };
 
-  class DoubleColumnPrinter: public ColumnPrinter {
+  class DoubleColumnPrinter: public LeafColumnPrinter<DoubleColumnPrinter> {
   private:
     const double* data;
     const bool isFloat;
+    const FloatFormat floatFormat;
 
   public:
-    DoubleColumnPrinter(std::string&, const Type& type);
+    DoubleColumnPrinter(std::string&, const Type& type,
+                        FloatFormat floatFormat);
     virtual ~DoubleColumnPrinter() override {}
-    void printRow(uint64_t rowId) override;
+    void printValue(uint64_t rowId);
     void reset(const ColumnVectorBatch& batch) override;
   };
 
-  class TimestampColumnPrinter: public ColumnPrinter {
+  class TimestampColumnPrinter: public LeafColumnPrinter<TimestampColumnPrinter> {
   private:
     const int64_t* seconds;
     const int64_t* nanoseconds;
+    DateFormatter dateFormatter;
 
   public:
     TimestampColumnPrinter(std::string&);
     ~TimestampColumnPrinter() override {}
-    void printRow(uint64_t rowId) override;
+    void printValue(uint64_t rowId);
     void reset(const ColumnVectorBatch& batch) override;
   };
 
-  class DateColumnPrinter: public ColumnPrinter {
+  class DateColumnPrinter: public LeafColumnPrinter<DateColumnPrinter> {
   private:
     const int64_t* data;
+    DateFormatter dateFormatter;
 
   public:
     DateColumnPrinter(std::string&);
     ~DateColumnPrinter() override {}
-    void printRow(uint64_t rowId) override;
+    void printValue(uint64_t rowId);
     void reset(const ColumnVectorBatch& batch) override;
   };
 
-  class Decimal64ColumnPrinter: public ColumnPrinter {
+  class Decimal64ColumnPrinter: public LeafColumnPrinter<Decimal64ColumnPrinter> {
   private:
     const int64_t* data;
     int32_t scale;
   public:
     Decimal64ColumnPrinter(std::string&);
     ~Decimal64ColumnPrinter() override {}
-    void printRow(uint64_t rowId) override;
+    void printValue(uint64_t rowId);
     void reset(const ColumnVectorBatch& batch) override;
   };
 
-  class Decimal128ColumnPrinter: public ColumnPrinter {
+  class Decimal128ColumnPrinter: public LeafColumnPrinter<Decimal128ColumnPrinter> {
   private:
     const Int128* data;
     int32_t scale;
   public:
     Decimal128ColumnPrinter(std::string&);
     ~Decimal128ColumnPrinter() override {}
-    void printRow(uint64_t rowId) override;
+    void printValue(uint64_t rowId);
     void reset(const ColumnVectorBatch& batch) override;
   };
 
-  class StringColumnPrinter: public ColumnPrinter {
+  /**
+   * Prints STRING, VARCHAR and CHAR columns. Dictionary encoded batches
+   * from lazy decoding are printed from a cache of the quoted dictionary
+   * entries, which is built once per dictionary, so each distinct value is
+   * only escaped once per stripe.
+   */
+  class StringColumnPrinter: public LeafColumnPrinter<StringColumnPrinter> {
   private:
     const char* const * start;
     const int64_t* length;
+    // the dictionary index of each row when the batch is encoded
+    const int64_t* index;
+    // kept alive so that a new dictionary can't reuse its address
+    std::shared_ptr<StringDictionary> dictionary;
+    // entry i quoted is [quotedOffsets[i], quotedOffsets[i+1]) of quoted
+    std::string quoted;
+    std::vector<uint64_t> quotedOffsets;
+
+    void quoteDictionary();
+
   public:
     StringColumnPrinter(std::string&);
     virtual ~StringColumnPrinter() override {}
-    void printRow(uint64_t rowId) override;
+    void printValue(uint64_t rowId);
     void reset(const ColumnVectorBatch& batch) override;
   };
 
-  class BinaryColumnPrinter: public ColumnPrinter {
+  class BinaryColumnPrinter: public LeafColumnPrinter<BinaryColumnPrinter> {
   private:
     const char* const * start;
     const int64_t* length;
   public:
     BinaryColumnPrinter(std::string&);
     virtual ~BinaryColumnPrinter() override {}
-    void printRow(uint64_t rowId) override;
+    void printValue(uint64_t rowId);
     void reset(const ColumnVectorBatch& batch) override;
   };
 
@@ -149,11 +220,15 @@ namespace orc {
   private:
     const int64_t* offsets;
     std::unique_ptr<ColumnPrinter> elementPrinter;
+    std::vector<uint64_t> elementOffsets;
+    std::string rows;
 
   public:
-    ListColumnPrinter(std::string&, const Type& type);
+    ListColumnPrinter(std::string&, const Type& type,
+                        FloatFormat floatFormat);
     virtual ~ListColumnPrinter() override {}
     void printRow(uint64_t rowId) override;
+    void printRows(uint64_t numRows, std::vector<uint64_t>& offsets) override;
     void reset(const ColumnVectorBatch& batch) override;
   };
 
@@ -162,11 +237,16 @@ namespace orc {
     const int64_t* offsets;
     std::unique_ptr<ColumnPrinter> keyPrinter;
     std::unique_ptr<ColumnPrinter> elementPrinter;
+    std::vector<uint64_t> keyOffsets;
+    std::vector<uint64_t> elementOffsets;
+    std::string rows;
 
   public:
-    MapColumnPrinter(std::string&, const Type& type);
+    MapColumnPrinter(std::string&, const Type& type,
+                       FloatFormat floatFormat);
     virtual ~MapColumnPrinter() override {}
     void printRow(uint64_t rowId) override;
+    void printRows(uint64_t numRows, std::vector<uint64_t>& offsets) override;
     void reset(const ColumnVectorBatch& batch) override;
   };
 
@@ -177,7 +257,8 @@ namespace orc {
     std::vector<std::unique_ptr<ColumnPrinter>> fieldPrinter;
 
   public:
-    UnionColumnPrinter(std::string&, const Type& type);
+    UnionColumnPrinter(std::string&, const Type& type,
+                         FloatFormat floatFormat);
     void printRow(uint64_t rowId) override;
     void reset(const ColumnVectorBatch& batch) override;
   };
@@ -186,9 +267,13 @@ namespace orc {
   private:
     std::vector<std::unique_ptr<ColumnPrinter>> fieldPrinter;
     std::vector<std::string> fieldNames;
+    std::vector<std::vector<uint64_t>> fieldOffsets;
+    std::string rows;
   public:
-    StructColumnPrinter(std::string&, const Type& type);
+    StructColumnPrinter(std::string&, const Type& type,
+                          FloatFormat floatFormat);
     void printRow(uint64_t rowId) override;
+    void printRows(uint64_t numRows, std::vector<uint64_t>& offsets) override;
     void reset(const ColumnVectorBatch& batch) override;
   };
 
@@ -204,105 +289,11 @@ namespace orc {
     file.append("null", sizeof("null")-1);
   }
 
-  static const uint8_t UTF8_T[] = {
-    0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0, // 00..1f
-    0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0, // 20..3f
-    0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0, // 40..5f
-    0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0, // 60..7f
-    1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,9,9,9,9,9,9,9,9,9,9,9,9,9,9,9,9, // 80..9f
-    7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,7, // a0..bf
-    8,8,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2, // c0..df
-    0xa,0x3,0x3,0x3,0x3,0x3,0x3,0x3,0x3,0x3,0x3,0x3,0x3,0x4,0x3,0x3, // e0..ef
-    0xb,0x6,0x6,0x6,0x5,0x8,0x8,0x8,0x8,0x8,0x8,0x8,0x8,0x8,0x8,0x8, // f0..ff
-    0x0,0x1,0x2,0x3,0x5,0x8,0x7,0x1,0x1,0x1,0x4,0x6,0x1,0x1,0x1,0x1, // s0..s0
-    1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,0,1,1,1,1,1,0,1,0,1,1,1,1,1,1, // s1..s2
-    1,2,1,1,1,1,1,2,1,2,1,1,1,1,1,1,1,1,1,1,1,1,1,2,1,1,1,1,1,1,1,1, // s3..s4
-    1,2,1,1,1,1,1,1,1,2,1,1,1,1,1,1,1,1,1,1,1,1,1,3,1,3,1,1,1,1,1,1, // s5..s6
-    1,3,1,1,1,1,1,3,1,3,1,1,1,1,1,1,1,3,1,1,1,1,1,1,1,1,1,1,1,1,1,1, // s7..s8
-  };
-
-  bool isUtf8String(const char *ptr, size_t len) {
-    const uint32_t state_utf8 = 0;
-    const uint32_t state_not_utf8 = 1;
-
-    uint32_t state = state_utf8;
-    for (size_t i = 0; i < len; i++) {
-        uint8_t type = UTF8_T[(uint8_t) ptr[i]];
-        state = UTF8_T[256 + state * 16 + type];
-        if (state == state_not_utf8) {
-            break;
-        }
-    }
-    return state == state_utf8;
-  }
-
-  const char *JSON_HEX_CHARS = "0123456789abcdefABCDEF";
-
-  inline void writeQuotedChar(std::string& buffer, char ch) {
-    // The following characters must be escaped according to JSON specification.
-    switch (ch) {
-    case '\\':
-      writeString(buffer, "\\\\", 2);
-      break;
-    case '\b':
-      writeString(buffer, "\\b", 2);
-      break;
-    case '\f':
-      writeString(buffer, "\\f", 2);
-      break;
-    case '\n':
-      writeString(buffer, "\\n", 2);
-      break;
-    case '\r':
-      writeString(buffer, "\\r", 2);
-      break;
-    case '\t':
-      writeString(buffer, "\\t", 2);
-      break;
-    case '"':
-      writeString(buffer, "\\\"", 2);
-      break;
-    default:
-      if (iscntrl(ch)) {
-        writeString(buffer, "\\u00", sizeof("\\u00")-1);
-        writeChar(buffer, JSON_HEX_CHARS[ch >> 4]);
-        writeChar(buffer, JSON_HEX_CHARS[ch & 0xf]);
-      } else {
-        writeChar(buffer, ch);
-      }
-      break;
-    }
-  }
-
-  // Writes characters as valid UTF-8 JSON string escaped with double-quotes.
+  // Writes the bytes as a JSON string escaped with double-quotes.
   void writeQuotedString(std::string& buffer, const char *ptr, int64_t len) {
-      writeChar(buffer, '"');
-
-      if (!isUtf8String(ptr, len)) {
-        for(int64_t i = 0; i < len; ++i) {
-          char ch = ptr[i];
-          writeQuotedChar(buffer, ch);
-        }
-      }
-      else {
-        for(int64_t i = 0; i < len; ++i) {
-          char ch = ptr[i];
-          if ((ch & 0xe0) == 0xc0) { // 2-byte UTF-8
-            writeString(buffer, ptr + i, 2);
-            i += 1;
-          } else if ((ch & 0xf0) == 0xe0) { // 3-byte UTF-8
-            writeString(buffer, ptr + i, 3);
-            i += 2;
-          } else if ((ch & 0xf8) == 0xf0) { // 4-byte UTF-8
-            writeString(buffer, ptr + i, 4);
-            i += 3;
-          } else {
-            writeQuotedChar(buffer, ch);
-          }
-        }
-      }
-      
-      writeChar(buffer, '"');
+    writeChar(buffer, '"');
+    writeJsonEscaped(buffer, ptr, static_cast<size_t>(len));
+    writeChar(buffer, '"');
   }
 
   ColumnPrinter::ColumnPrinter(std::string& _buffer
@@ -324,8 +315,87 @@ namespace orc {
     }
   }
 
+  void ColumnPrinter::printRows(uint64_t numRows,
+                                std::vector<uint64_t>& offsets) {
+    offsets.resize(numRows + 1);
+    offsets[0] = buffer.size();
+    for (uint64_t i = 0; i < numRows; ++i) {
+      printRow(i);
+      offsets[i + 1] = buffer.size();
+    }
+  }
+
+  void ColumnPrinter::printBatch(uint64_t numRows) {
+    std::vector<uint64_t> offsets;
+    printRows(numRows, offsets);
+    // Insert a newline after each row, moving the rows back to front so
+    // that it can be done in place.
+    buffer.resize(buffer.size() + numRows);
+    char* data = &buffer[0];
+    for (uint64_t i = numRows; i > 0; --i) {
+      uint64_t rowStart = offsets[i - 1];
+      uint64_t rowLength = offsets[i] - rowStart;
+      data[offsets[i] + i - 1] = '\n';
+      memmove(data + rowStart + i - 1, data + rowStart, rowLength);
+    }
+  }
+
+  template <class Derived>
+  void LeafColumnPrinter<Derived>::printRow(uint64_t rowId) {
+    if (hasNulls && !notNull[rowId]) {
+      writeNull(buffer);
+    } else {
+      static_cast<Derived*>(this)->printValue(rowId);
+    }
+  }
+
+  template <class Derived>
+  void LeafColumnPrinter<Derived>::printRows(uint64_t numRows,
+                                             std::vector<uint64_t>& offsets) {
+    Derived* self = static_cast<Derived*>(this);
+    offsets.resize(numRows + 1);
+    offsets[0] = buffer.size();
+    if (!hasNulls) {
+      for (uint64_t i = 0; i < numRows; ++i) {
+        self->printValue(i);
+        offsets[i + 1] = buffer.size();
+      }
+    } else {
+      for (uint64_t i = 0; i < numRows; ++i) {
+        if (notNull[i]) {
+          self->printValue(i);
+        } else {
+          writeNull(buffer);
+        }
+        offsets[i + 1] = buffer.size();
+      }
+    }
+  }
+
+  /**
+   * Replace everything in the buffer after start with the given rows. The
+   * rows are appended rather than swapped in, so both strings keep the
+   * capacity they have grown to and the next batch doesn't allocate.
+   */
+  void replaceTail(std::string& buffer, uint64_t start,
+                   const std::string& rows) {
+    buffer.resize(start);
+    buffer.append(rows);
+  }
+
+  /**
+   * Copy a slice of the rendered column into out and advance out.
+   */
+  inline void copySlice(char*& out, const char* column,
+                        const std::vector<uint64_t>& offsets, uint64_t row) {
+    uint64_t length = offsets[row + 1] - offsets[row];
+    memcpy(out, column + offsets[row], length);
+    out += length;
+  }
+
   std::unique_ptr<ColumnPrinter> createColumnPrinter(std::string& buffer,
-                                                     const Type* type) {
+                                                     const Type* type,
+                                                     FloatFormat floatFormat) {
     ColumnPrinter *result = nullptr;
     if (type == nullptr) {
       result = new VoidColumnPrinter(buffer);
@@ -344,7 +414,7 @@ namespace orc {
 
       case FLOAT:
       case DOUBLE:
-        result = new DoubleColumnPrinter(buffer, *type);
+        result = new DoubleColumnPrinter(buffer, *type, floatFormat);
         break;
 
       case STRING:
@@ -362,15 +432,15 @@ namespace orc {
         break;
 
       case LIST:
-        result = new ListColumnPrinter(buffer, *type);
+        result = new ListColumnPrinter(buffer, *type, floatFormat);
         break;
 
       case MAP:
-        result = new MapColumnPrinter(buffer, *type);
+        result = new MapColumnPrinter(buffer, *type, floatFormat);
         break;
 
       case STRUCT:
-        result = new StructColumnPrinter(buffer, *type);
+        result = new StructColumnPrinter(buffer, *type, floatFormat);
         break;
 
       case DECIMAL:
@@ -386,7 +456,7 @@ namespace orc {
         break;
 
       case UNION:
-        result = new UnionColumnPrinter(buffer, *type);
+        result = new UnionColumnPrinter(buffer, *type, floatFormat);
         break;
 
       default:
@@ -410,7 +480,7 @@ namespace orc {
   }
 
   LongColumnPrinter::LongColumnPrinter(std::string& _buffer
-                                       ): ColumnPrinter(_buffer),
+                                       ): LeafColumnPrinter(_buffer),
                                           data(nullptr) {
     // PASS
   }
@@ -420,22 +490,19 @@ namespace orc {
     data = dynamic_cast<const LongVectorBatch&>(batch).data.data();
   }
 
-  void LongColumnPrinter::printRow(uint64_t rowId) {
-    if (hasNulls && !notNull[rowId]) {
-      writeNull(buffer);
-    } else {
-      char numBuffer[64];
-      auto len = snprintf(numBuffer, sizeof(numBuffer), "%" INT64_FORMAT_STRING "d",
-               static_cast<int64_t >(data[rowId]));
-      writeString(buffer, numBuffer, len);
-    }
+  void LongColumnPrinter::printValue(uint64_t rowId) {
+    char numBuffer[MAX_INT64_CHARS];
+    char* end = formatInt64(data[rowId], numBuffer);
+    buffer.append(numBuffer, static_cast<size_t>(end - numBuffer));
   }
 
   DoubleColumnPrinter::DoubleColumnPrinter(std::string& _buffer,
-                                           const Type& type
-                                           ): ColumnPrinter(_buffer),
+                                           const Type& type,
+                                           FloatFormat _floatFormat
+                                           ): LeafColumnPrinter(_buffer),
                                               data(nullptr),
-                                              isFloat(type.getKind() == FLOAT){
+                                              isFloat(type.getKind() == FLOAT),
+                                              floatFormat(_floatFormat) {
     // PASS
   }
 
@@ -444,25 +511,27 @@ namespace orc {
     data = dynamic_cast<const DoubleVectorBatch&>(batch).data.data();
   }
 
-  void DoubleColumnPrinter::printRow(uint64_t rowId) {
-    if (hasNulls && !notNull[rowId]) {
-      writeNull(buffer);
+  void DoubleColumnPrinter::printValue(uint64_t rowId) {
+    if (isnan(data[rowId])) {
+      writeString(buffer, "\"NaN\"", sizeof("\"NaN\"")-1);
+    } else if (isinf(data[rowId])) {
+      writeString(buffer, "\"Infinity\"", sizeof("\"Infinity\"")-1);
+    } else if (floatFormat == FloatFormat_SHORTEST) {
+      char numBuffer[MAX_DOUBLE_CHARS];
+      char* end = isFloat ?
+        formatFloat(static_cast<float>(data[rowId]), numBuffer) :
+        formatDouble(data[rowId], numBuffer);
+      buffer.append(numBuffer, static_cast<size_t>(end - numBuffer));
     } else {
-      if (isnan(data[rowId])) {
-        writeString(buffer, "\"NaN\"", sizeof("\"NaN\"")-1);
-      } else if (isinf(data[rowId])) {
-        writeString(buffer, "\"Infinity\"", sizeof("\"Infinity\"")-1);
-      } else {
-        char numBuffer[64];
-        auto len = snprintf(numBuffer, sizeof(numBuffer), isFloat ? "%.7g" : "%.14g",
-                 data[rowId]);
-        writeString(buffer, numBuffer, len);
-      }
+      char numBuffer[64];
+      auto len = snprintf(numBuffer, sizeof(numBuffer), isFloat ? "%.7g" : "%.14g",
+               data[rowId]);
+      writeString(buffer, numBuffer, len);
     }
   }
 
   Decimal64ColumnPrinter::Decimal64ColumnPrinter(std::string& _buffer
-                                                 ): ColumnPrinter(_buffer),
+                                                 ): LeafColumnPrinter(_buffer),
                                                     data(nullptr),
                                                     scale(0) {
     // PASS
@@ -503,17 +572,13 @@ namespace orc {
     }
   }
 
-  void Decimal64ColumnPrinter::printRow(uint64_t rowId) {
-    if (hasNulls && !notNull[rowId]) {
-      writeNull(buffer);
-    } else {
-      auto decimalString = toDecimalString(data[rowId], scale);
-      writeString(buffer, decimalString.c_str(), decimalString.length());
-    }
+  void Decimal64ColumnPrinter::printValue(uint64_t rowId) {
+    auto decimalString = toDecimalString(data[rowId], scale);
+    writeString(buffer, decimalString.c_str(), decimalString.length());
   }
 
   Decimal128ColumnPrinter::Decimal128ColumnPrinter(std::string& _buffer
-                                                   ): ColumnPrinter(_buffer),
+                                                   ): LeafColumnPrinter(_buffer),
                                                       data(nullptr),
                                                       scale(0) {
      // PASS
@@ -525,41 +590,71 @@ namespace orc {
      scale = dynamic_cast<const Decimal128VectorBatch&>(batch).scale;
    }
 
-   void Decimal128ColumnPrinter::printRow(uint64_t rowId) {
-     if (hasNulls && !notNull[rowId]) {
-       writeNull(buffer);
-     } else {
-       auto decimalString = data[rowId].toDecimalString(scale);
-       writeString(buffer, decimalString.c_str(), decimalString.length());
-     }
+   void Decimal128ColumnPrinter::printValue(uint64_t rowId) {
+     auto decimalString = data[rowId].toDecimalString(scale);
+     writeString(buffer, decimalString.c_str(), decimalString.length());
    }
 
   StringColumnPrinter::StringColumnPrinter(std::string& _buffer
-                                           ): ColumnPrinter(_buffer),
+                                           ): LeafColumnPrinter(_buffer),
                                               start(nullptr),
-                                              length(nullptr) {
+                                              length(nullptr),
+                                              index(nullptr) {
     // PASS
   }
 
   void StringColumnPrinter::reset(const ColumnVectorBatch& batch) {
     ColumnPrinter::reset(batch);
-    start = dynamic_cast<const StringVectorBatch&>(batch).data.data();
-    length = dynamic_cast<const StringVectorBatch&>(batch).length.data();
+    if (batch.isEncoded) {
+      const EncodedStringVectorBatch& encoded =
+        dynamic_cast<const EncodedStringVectorBatch&>(batch);
+      index = encoded.index.data();
+      if (encoded.dictionary != dictionary) {
+        dictionary = encoded.dictionary;
+        quoteDictionary();
+      }
+    } else {
+      index = nullptr;
+      start = dynamic_cast<const StringVectorBatch&>(batch).data.data();
+      length = dynamic_cast<const StringVectorBatch&>(batch).length.data();
+    }
   }
 
-  void StringColumnPrinter::printRow(uint64_t rowId) {
-    if (hasNulls && !notNull[rowId]) {
-      writeNull(buffer);
-    } else {
+  void StringColumnPrinter::quoteDictionary() {
+    const int64_t* entryOffsets = dictionary->dictionaryOffset.data();
+    const char* blob = dictionary->dictionaryBlob.data();
+    uint64_t numEntries = dictionary->dictionaryOffset.size() - 1;
+    quoted.clear();
+    quotedOffsets.resize(numEntries + 1);
+    quotedOffsets[0] = 0;
+    for (uint64_t i = 0; i < numEntries; ++i) {
+      writeQuotedString(quoted, blob + entryOffsets[i],
+                        entryOffsets[i + 1] - entryOffsets[i]);
+      quotedOffsets[i + 1] = quoted.size();
+    }
+  }
+
+  void StringColumnPrinter::printValue(uint64_t rowId) {
+    if (index == nullptr) {
       writeQuotedString(buffer, start[rowId], length[rowId]);
+      return;
+    }
+    uint64_t entry = static_cast<uint64_t>(index[rowId]);
+    // a negative index from a corrupt file is a huge entry here
+    if (entry >= quotedOffsets.size() - 1) {
+      throw ParseError("Entry index out of range in StringDictionaryColumn");
     }
+    buffer.append(quoted.data() + quotedOffsets[entry],
+                  quotedOffsets[entry + 1] - quotedOffsets[entry]);
   }
 
   ListColumnPrinter::ListColumnPrinter(std::string& _buffer,
-                                       const Type& type
+                                       const Type& type,
+                                       FloatFormat floatFormat
                                        ): ColumnPrinter(_buffer),
                                           offsets(nullptr) {
-    elementPrinter = createColumnPrinter(buffer, type.getSubtype(0));
+    elementPrinter = createColumnPrinter(buffer, type.getSubtype(0),
+                                         floatFormat);
   }
 
   void ListColumnPrinter::reset(const  ColumnVectorBatch& batch) {
@@ -584,12 +679,54 @@ namespace orc {
     }
   }
 
+  void ListColumnPrinter::printRows(uint64_t numRows,
+                                    std::vector<uint64_t>& rowOffsets) {
+    // Rows of a list with nulls may carry arbitrary offsets, so keep to the
+    // row at a time path for them.
+    if (hasNulls || numRows == 0 || offsets[0] != 0) {
+      ColumnPrinter::printRows(numRows, rowOffsets);
+      return;
+    }
+    const uint64_t start = buffer.size();
+    elementPrinter->printRows(static_cast<uint64_t>(offsets[numRows]),
+                              elementOffsets);
+
+    rowOffsets.resize(numRows + 1);
+    rowOffsets[0] = start;
+    for (uint64_t r = 0; r < numRows; ++r) {
+      uint64_t first = static_cast<uint64_t>(offsets[r]);
+      uint64_t last = static_cast<uint64_t>(offsets[r + 1]);
+      uint64_t length = 2 + elementOffsets[last] - elementOffsets[first];
+      if (last > first) {
+        length += last - first - 1;
+      }
+      rowOffsets[r + 1] = rowOffsets[r] + length;
+    }
+
+    rows.resize(rowOffsets[numRows] - start);
+    char* out = &rows[0];
+    const char* column = buffer.data();
+    for (uint64_t r = 0; r < numRows; ++r) {
+      *out++ = '[';
+      for (int64_t i = offsets[r]; i < offsets[r + 1]; ++i) {
+        if (i != offsets[r]) {
+          *out++ = ',';
+        }
+        copySlice(out, column, elementOffsets, static_cast<uint64_t>(i));
+      }
+      *out++ = ']';
+    }
+    replaceTail(buffer, start, rows);
+  }
+
   MapColumnPrinter::MapColumnPrinter(std::string& _buffer,
-                                     const Type& type
+                                     const Type& type,
+                                     FloatFormat floatFormat
                                      ): ColumnPrinter(_buffer),
                                         offsets(nullptr) {
-    keyPrinter = createColumnPrinter(buffer, type.getSubtype(0));
-    elementPrinter = createColumnPrinter(buffer, type.getSubtype(1));
+    keyPrinter = createColumnPrinter(buffer, type.getSubtype(0), floatFormat);
+    elementPrinter = createColumnPrinter(buffer, type.getSubtype(1),
+                                         floatFormat);
   }
 
   void MapColumnPrinter::reset(const  ColumnVectorBatch& batch) {
@@ -617,13 +754,59 @@ void MapColumnPrinter::printRow(uint64_t rowId) {
     }
   }
   
+  void MapColumnPrinter::printRows(uint64_t numRows,
+                                   std::vector<uint64_t>& rowOffsets) {
+    // Rows of a map with nulls may carry arbitrary offsets, so keep to the
+    // row at a time path for them.
+    if (hasNulls || numRows == 0 || offsets[0] != 0) {
+      ColumnPrinter::printRows(numRows, rowOffsets);
+      return;
+    }
+    const uint64_t start = buffer.size();
+    const uint64_t numEntries = static_cast<uint64_t>(offsets[numRows]);
+    keyPrinter->printRows(numEntries, keyOffsets);
+    elementPrinter->printRows(numEntries, elementOffsets);
+
+    rowOffsets.resize(numRows + 1);
+    rowOffsets[0] = start;
+    for (uint64_t r = 0; r < numRows; ++r) {
+      uint64_t first = static_cast<uint64_t>(offsets[r]);
+      uint64_t last = static_cast<uint64_t>(offsets[r + 1]);
+      uint64_t length = 2 + keyOffsets[last] - keyOffsets[first] +
+        elementOffsets[last] - elementOffsets[first] + (last - first);
+      if (last > first) {
+        length += last - first - 1;
+      }
+      rowOffsets[r + 1] = rowOffsets[r] + length;
+    }
+
+    rows.resize(rowOffsets[numRows] - start);
+    char* out = &rows[0];
+    const char* column = buffer.data();
+    for (uint64_t r = 0; r < numRows; ++r) {
+      *out++ = '{';
+      for (int64_t i = offsets[r]; i < offsets[r + 1]; ++i) {
+        if (i != offsets[r]) {
+          *out++ = ',';
+        }
+        copySlice(out, column, keyOffsets, static_cast<uint64_t>(i));
+        *out++ = ':';
+        copySlice(out, column, elementOffsets, static_cast<uint64_t>(i));
+      }
+      *out++ = '}';
+    }
+    replaceTail(buffer, start, rows);
+  }
+
   UnionColumnPrinter::UnionColumnPrinter(std::string& _buffer,
-                                           const Type& type
+                                           const Type& type,
+                                           FloatFormat floatFormat
                                          ): ColumnPrinter(_buffer),
                                             tags(nullptr),
                                             offsets(nullptr) {
     for(unsigned int i=0; i < type.getSubtypeCount(); ++i) {
-      fieldPrinter.push_back(createColumnPrinter(buffer, type.getSubtype(i)));
+      fieldPrinter.push_back(createColumnPrinter(buffer, type.getSubtype(i),
+                                                 floatFormat));
     }
   }
 
@@ -643,10 +826,9 @@ void MapColumnPrinter::printRow(uint64_t rowId) {
       writeNull(buffer);
     } else {
       writeString(buffer, "{\"tag\":", sizeof("{\"tag\":")-1);
-      char numBuffer[64];
-      auto len = snprintf(numBuffer, sizeof(numBuffer), "%" INT64_FORMAT_STRING "d",
-               static_cast<int64_t>(tags[rowId]));
-      writeString(buffer, numBuffer, len);
+      char numBuffer[MAX_INT64_CHARS];
+      char* end = formatUInt64(tags[rowId], numBuffer);
+      buffer.append(numBuffer, static_cast<size_t>(end - numBuffer));
       writeString(buffer, ",\"value\":", sizeof(",\"value\":")-1);
       fieldPrinter[tags[rowId]]->printRow(offsets[rowId]);
       writeChar(buffer, '}');
@@ -654,11 +836,13 @@ void MapColumnPrinter::printRow(uint64_t rowId) {
   }
 
   StructColumnPrinter::StructColumnPrinter(std::string& _buffer,
-                                           const Type& type
+                                           const Type& type,
+                                           FloatFormat floatFormat
                                            ): ColumnPrinter(_buffer) {
     for(unsigned int i=0; i < type.getSubtypeCount(); ++i) {
       fieldNames.push_back(type.getFieldName(i));
-      fieldPrinter.push_back(createColumnPrinter(buffer, type.getSubtype(i)));
+      fieldPrinter.push_back(createColumnPrinter(buffer, type.getSubtype(i),
+                                                 floatFormat));
     }
   }
 
@@ -690,29 +874,110 @@ void MapColumnPrinter::printRow(uint64_t rowId) {
     }
   }
 
+  void StructColumnPrinter::printRows(uint64_t numRows,
+                                      std::vector<uint64_t>& offsets) {
+    // The fields of a null struct may hold anything, so keep to the row at
+    // a time path for them.
+    if (hasNulls || numRows == 0) {
+      ColumnPrinter::printRows(numRows, offsets);
+      return;
+    }
+    const uint64_t start = buffer.size();
+    fieldOffsets.resize(fieldPrinter.size());
+    uint64_t fixedLength = 2;
+    for (size_t i = 0; i < fieldPrinter.size(); ++i) {
+      fieldPrinter[i]->printRows(numRows, fieldOffsets[i]);
+      // ,"name":
+      fixedLength += fieldNames[i].length() + 3 + (i != 0 ? 1 : 0);
+    }
+
+    offsets.resize(numRows + 1);
+    offsets[0] = start;
+    for (uint64_t r = 0; r < numRows; ++r) {
+      uint64_t length = fixedLength;
+      for (size_t i = 0; i < fieldPrinter.size(); ++i) {
+        length += fieldOffsets[i][r + 1] - fieldOffsets[i][r];
+      }
+      offsets[r + 1] = offsets[r] + length;
+    }
+
+    rows.resize(offsets[numRows] - start);
+    char* out = &rows[0];
+    const char* column = buffer.data();
+    for (uint64_t r = 0; r < numRows; ++r) {
+      *out++ = '{';
+      for (size_t i = 0; i < fieldPrinter.size(); ++i) {
+        if (i != 0) {
+          *out++ = ',';
+        }
+        *out++ = '"';
+        memcpy(out, fieldNames[i].data(), fieldNames[i].length());
+        out += fieldNames[i].length();
+        *out++ = '"';
+        *out++ = ':';
+        copySlice(out, column, fieldOffsets[i], r);
+      }
+      *out++ = '}';
+    }
+    replaceTail(buffer, start, rows);
+  }
+
+  static const char INVALID_DATE[] = "0000-00-00";
+  static const char INVALID_TIME[] = "0000-00-00 00:00:00";
+
+  static const int64_t SECONDS_PER_DAY = 24 * 60 * 60;
+
+  inline void writeTwoDigits(char* out, int64_t value) {
+    out[0] = static_cast<char>('0' + value / 10);
+    out[1] = static_cast<char>('0' + value % 10);
+  }
+
+  bool DateFormatter::format(int64_t days) {
+    // the days from 0000-03-01, which make up whole 400 year eras, must
+    // not overflow; gmtime fails long before that anyway
+    const int64_t MAX_DAYS = 1LL << 50;
+    if (days > MAX_DAYS || days < -MAX_DAYS) {
+      return false;
+    }
+    // civil_from_days from Howard Hinnant's "chrono-Compatible Low-Level
+    // Date Algorithms", with the year starting on the 1st of March
+    int64_t shifted = days + 719468;
+    int64_t era = (shifted >= 0 ? shifted : shifted - 146096) / 146097;
+    int64_t dayOfEra = shifted - era * 146097;
+    int64_t yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 -
+                         dayOfEra / 146096) / 365;
+    int64_t dayOfYear = dayOfEra -
+      (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    int64_t shiftedMonth = (5 * dayOfYear + 2) / 153;
+    int64_t dayOfMonth = dayOfYear - (153 * shiftedMonth + 2) / 5 + 1;
+    int64_t month = shiftedMonth < 10 ? shiftedMonth + 3 : shiftedMonth - 9;
+    int64_t year = yearOfEra + era * 400 + (month <= 2 ? 1 : 0);
+    if (year - 1900 > std::numeric_limits<int>::max() ||
+        year - 1900 < std::numeric_limits<int>::min()) {
+      return false;
+    }
+    // %Y doesn't pad the year
+    char* out = formatInt64(year, text);
+    *out++ = '-';
+    writeTwoDigits(out, month);
+    out[2] = '-';
+    writeTwoDigits(out + 3, dayOfMonth);
+    length = static_cast<size_t>(out + 5 - text);
+    return true;
+  }
+
   DateColumnPrinter::DateColumnPrinter(std::string& _buffer
-                                       ): ColumnPrinter(_buffer),
+                                       ): LeafColumnPrinter(_buffer),
                                           data(nullptr) {
     // PASS
   }
 
-  void DateColumnPrinter::printRow(uint64_t rowId) {
-    const char* invalidDate = "0000-00-00";
-    if (hasNulls && !notNull[rowId]) {
-      writeNull(buffer);
-    } else {
-      const time_t timeValue = data[rowId] * 24 * 60 * 60;
-      struct tm tmValue;
-      writeChar(buffer, '"');
-      if (!gmtime_r(&timeValue, &tmValue)) {
-        writeString(buffer, invalidDate, sizeof(invalidDate)-1);
-      } else {
-        char timeBuffer[11];
-        auto len = strftime(timeBuffer, sizeof(timeBuffer), "%Y-%m-%d", &tmValue);
-        writeString(buffer, timeBuffer, len);
-      }
-      writeChar(buffer, '"');
+  void DateColumnPrinter::printValue(uint64_t rowId) {
+    writeChar(buffer, '"');
+    if (!dateFormatter.write(buffer, data[rowId])) {
+      writeString(buffer, INVALID_DATE, sizeof(INVALID_DATE)-1);
     }
+    writeChar(buffer, '"');
   }
 
   void DateColumnPrinter::reset(const ColumnVectorBatch& batch) {
@@ -721,20 +986,16 @@ void MapColumnPrinter::printRow(uint64_t rowId) {
   }
 
   BooleanColumnPrinter::BooleanColumnPrinter(std::string& _buffer
-                                             ): ColumnPrinter(_buffer),
+                                             ): LeafColumnPrinter(_buffer),
                                                 data(nullptr) {
     // PASS
   }
 
-  void BooleanColumnPrinter::printRow(uint64_t rowId) {
-    if (hasNulls && !notNull[rowId]) {
-      writeNull(buffer);
+  void BooleanColumnPrinter::printValue(uint64_t rowId) {
+    if (data[rowId]) {
+      writeString(buffer, "true", sizeof("true")-1);
     } else {
-      if (data[rowId]) {
-        writeString(buffer, "true", sizeof("true")-1);
-      } else {
-        writeString(buffer, "false", sizeof("false")-1);
-      }
+      writeString(buffer, "false", sizeof("false")-1);
     }
   }
 
@@ -744,28 +1005,24 @@ void MapColumnPrinter::printRow(uint64_t rowId) {
   }
 
   BinaryColumnPrinter::BinaryColumnPrinter(std::string& _buffer
-                                           ): ColumnPrinter(_buffer),
+                                           ): LeafColumnPrinter(_buffer),
                                               start(nullptr),
                                               length(nullptr) {
     // PASS
   }
 
-  void BinaryColumnPrinter::printRow(uint64_t rowId) {
-    if (hasNulls && !notNull[rowId]) {
-      writeNull(buffer);
-    } else {
-      writeChar(buffer, '[');
-      for(int64_t i=0; i < length[rowId]; ++i) {
-        if (i != 0) {
-          writeChar(buffer, ',');
-        }
-        char numBuffer[64];
-        auto len = snprintf(numBuffer, sizeof(numBuffer), "%d",
-                 (static_cast<const int>(start[rowId][i]) & 0xff));
-        writeString(buffer, numBuffer, len);
+  void BinaryColumnPrinter::printValue(uint64_t rowId) {
+    writeChar(buffer, '[');
+    for(int64_t i=0; i < length[rowId]; ++i) {
+      if (i != 0) {
+        writeChar(buffer, ',');
       }
-      writeChar(buffer, ']');
+      char numBuffer[MAX_INT64_CHARS];
+      char* end = formatUInt64(static_cast<unsigned char>(start[rowId][i]),
+                               numBuffer);
+      buffer.append(numBuffer, static_cast<size_t>(end - numBuffer));
     }
+    writeChar(buffer, ']');
   }
 
   void BinaryColumnPrinter::reset(const ColumnVectorBatch& batch) {
@@ -775,48 +1032,71 @@ void MapColumnPrinter::printRow(uint64_t rowId) {
   }
 
   TimestampColumnPrinter::TimestampColumnPrinter(std::string& _buffer
-                                                 ): ColumnPrinter(_buffer),
+                                                 ): LeafColumnPrinter(_buffer),
                                                     seconds(nullptr),
                                                     nanoseconds(nullptr) {
     // PASS
   }
 
-  void TimestampColumnPrinter::printRow(uint64_t rowId) {
-    const char* invalidTime = "0000-00-00 00:00:00";
+  void TimestampColumnPrinter::printValue(uint64_t rowId) {
     const int64_t NANO_DIGITS = 9;
-    if (hasNulls && !notNull[rowId]) {
-      writeNull(buffer);
-    } else {
-      int64_t nanos = nanoseconds[rowId];
-      time_t secs = static_cast<time_t>(seconds[rowId]);
-      struct tm tmValue;
+    int64_t secs = seconds[rowId];
+    int64_t nanos = nanoseconds[rowId];
+    int64_t days = secs / SECONDS_PER_DAY;
+    int64_t secondOfDay = secs % SECONDS_PER_DAY;
+    if (secondOfDay < 0) {
+      days -= 1;
+      secondOfDay += SECONDS_PER_DAY;
+    }
+    writeChar(buffer, '"');
+    if (!dateFormatter.write(buffer, days)) {
+      writeString(buffer, INVALID_TIME, sizeof(INVALID_TIME)-1);
       writeChar(buffer, '"');
-      if (!gmtime_r(&secs, &tmValue)) {
-        writeString(buffer, invalidTime, sizeof(invalidTime)-1);
-        writeChar(buffer, '"');
-      } else {
-        char timeBuffer[20];
-        auto len = strftime(timeBuffer, sizeof(timeBuffer), "%Y-%m-%d %H:%M:%S", &tmValue);
-        writeString(buffer, timeBuffer, len);
-        writeChar(buffer, '.');
-        // remove trailing zeros off the back of the nanos value.
-        int64_t zeroDigits = 0;
-        if (nanos == 0) {
-          zeroDigits = 8;
-        } else {
-          while (nanos % 10 == 0) {
-            nanos /= 10;
-            zeroDigits += 1;
-          }
-        }
-        char numBuffer[64];
-        len = snprintf(numBuffer, sizeof(numBuffer),
-                 "%0*" INT64_FORMAT_STRING "d\"",
-                 static_cast<int>(NANO_DIGITS - zeroDigits),
-                 static_cast<int64_t >(nanos));
-        writeString(buffer, numBuffer, len);
+      return;
+    }
+
+    // " HH:MM:SS." then up to 9 digits of nanos and the closing quote
+    char timeBuffer[10 + NANO_DIGITS + 1];
+    timeBuffer[0] = ' ';
+    writeTwoDigits(timeBuffer + 1, secondOfDay / 3600);
+    timeBuffer[3] = ':';
+    writeTwoDigits(timeBuffer + 4, secondOfDay / 60 % 60);
+    timeBuffer[6] = ':';
+    writeTwoDigits(timeBuffer + 7, secondOfDay % 60);
+    timeBuffer[9] = '.';
+    char* out = timeBuffer + 10;
+    if (nanos == 0) {
+      *out++ = '0';
+    } else if (nanos > 0 && nanos < 1000000000) {
+      // remove trailing zeros off the back of the nanos value.
+      int64_t digits = NANO_DIGITS;
+      while (nanos % 10 == 0) {
+        nanos /= 10;
+        digits -= 1;
       }
+      for (int64_t i = digits - 1; i >= 0; --i) {
+        out[i] = static_cast<char>('0' + nanos % 10);
+        nanos /= 10;
+      }
+      out += digits;
+    } else {
+      // nanos out of range are rare enough to not need a fast path
+      writeString(buffer, timeBuffer, out - timeBuffer);
+      int64_t zeroDigits = 0;
+      while (nanos % 10 == 0) {
+        nanos /= 10;
+        zeroDigits += 1;
+      }
+      char numBuffer[64];
+      auto len = snprintf(numBuffer, sizeof(numBuffer),
+               "%0*" INT64_FORMAT_STRING "d\"",
+               static_cast<int>(NANO_DIGITS - zeroDigits),
+               static_cast<int64_t >(nanos));
+      writeString(buffer, numBuffer, len);
+      return;
     }
+    *out++ = '"';
+    writeString(buffer, timeBuffer, out - timeBuffer);
   }
 
   void TimestampColumnPrinter::reset(const ColumnVectorBatch& batch) {
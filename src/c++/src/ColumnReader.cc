@@ -19,13 +19,23 @@
 #include "orc/Int128.hh"
 
 #include "Adaptor.hh"
+#include "BitExpand.hh"
 #include "ByteRLE.hh"
 #include "ColumnReader.hh"
+#include "CpuInfo.hh"
 #include "orc/Exceptions.hh"
+#include "orc/Reader.hh"
+#include "ReaderMetrics.hh"
 #include "RLE.hh"
 
+#include <algorithm>
 #include <math.h>
 #include <iostream>
+#include <string.h>
+
+#ifdef HAS_AVX2
+#include <immintrin.h>
+#endif
 
 namespace orc {
 
@@ -33,6 +43,10 @@ namespace orc {
     // PASS
   }
 
+  ReaderMetricsCounters* StripeStreams::getMetricsCounters() const {
+    return nullptr;
+  }
+
   inline RleVersion convertRleVersion(proto::ColumnEncoding_Kind kind) {
     switch (static_cast<int64_t>(kind)) {
     case proto::ColumnEncoding_Kind_DIRECT:
@@ -49,7 +63,8 @@ namespace orc {
   ColumnReader::ColumnReader(const Type& type,
                              StripeStreams& stripe
                              ): columnId(type.getColumnId()),
-                                memoryPool(stripe.getMemoryPool()) {
+                                memoryPool(stripe.getMemoryPool()),
+                                metrics(stripe.getMetricsCounters()) {
     std::unique_ptr<SeekableInputStream> stream =
       stripe.getStream(columnId, proto::Stream_Kind_PRESENT, true);
     if (stream.get()) {
@@ -61,6 +76,22 @@ namespace orc {
     // PASS
   }
 
+  void ColumnReader::readChild(ColumnReader& child,
+                               ColumnVectorBatch& batch,
+                               uint64_t numValues,
+                               char* notNull,
+                               bool encoded) {
+    uint64_t start = metrics ? getMetricsTime() : 0;
+    if (encoded) {
+      child.nextEncoded(batch, numValues, notNull);
+    } else {
+      child.next(batch, numValues, notNull);
+    }
+    if (metrics) {
+      metrics->addDecode(child.columnId, numValues, getMetricsTime() - start);
+    }
+  }
+
   uint64_t ColumnReader::skip(uint64_t numValues) {
     ByteRleDecoder* decoder = notNullDecoder.get();
     if (decoder) {
@@ -97,13 +128,10 @@ namespace orc {
     ByteRleDecoder* decoder = notNullDecoder.get();
     if (decoder) {
       char* notNullArray = rowBatch.notNull.data();
-      decoder->next(notNullArray, numValues, incomingMask);
       // check to see if there are nulls in this batch
-      for(uint64_t i=0; i < numValues; ++i) {
-        if (!notNullArray[i]) {
-          rowBatch.hasNulls = true;
-          return;
-        }
+      if (decoder->nextCountZeros(notNullArray, numValues, incomingMask) > 0) {
+        rowBatch.hasNulls = true;
+        return;
       }
     } else if (incomingMask) {
       // If we don't have a notNull stream, copy the incomingMask
@@ -121,18 +149,10 @@ namespace orc {
     }
   }
 
-  /**
-   * Expand an array of bytes in place to the corresponding array of longs.
-   * Has to work backwards so that they data isn't clobbered during the
-   * expansion.
-   * @param buffer the array of chars and array of longs that need to be
-   *        expanded
-   * @param numValues the number of bytes to convert to longs
-   */
-  void expandBytesToLongs(int64_t* buffer, uint64_t numValues) {
-    for(size_t i=numValues - 1; i < numValues; --i) {
-      buffer[i] = reinterpret_cast<char *>(buffer)[i];
-    }
+  uint64_t ColumnReader::nextFiltered(ColumnVectorBatch&, uint64_t,
+                                      const RowFilter&,
+                                      const std::vector<uint64_t>&, bool) {
+    throw NotImplementedYet("Row filters are only supported on structs");
   }
 
   class BooleanColumnReader: public ColumnReader {
@@ -300,6 +320,12 @@ namespace orc {
     rle->seek(positions.at(columnId));
   }
 
+  // The low 3 bits of an encoded nanosecond value give the number of
+  // trailing decimal zeros that were dropped, less one.
+  static const uint64_t NANO_SCALE[8] = {
+    1, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000
+  };
+
   class TimestampColumnReader: public ColumnReader {
   private:
     std::unique_ptr<orc::RleDecoder> secondsRle;
@@ -362,22 +388,21 @@ namespace orc {
     int64_t *nanoBuffer = timestampBatch.nanoseconds.data();
     nanoRle->next(nanoBuffer, numValues, notNull);
 
-    // Construct the values
+    // Construct the values. The loops have no branches, so they run over
+    // the null rows as well, whose values are never looked at.
     for(uint64_t i=0; i < numValues; i++) {
-      if (notNull == nullptr || notNull[i]) {
-        uint64_t zeros = nanoBuffer[i] & 0x7;
-        nanoBuffer[i] >>= 3;
-        if (zeros != 0) {
-          for(uint64_t j = 0; j <= zeros; ++j) {
-            nanoBuffer[i] *= 10;
-          }
-        }
-        int64_t writerTime = secsBuffer[i] + epochOffset;
-        secsBuffer[i] = writerTimezone.convertToUTC(writerTime);
-        if (secsBuffer[i] < 0 && nanoBuffer[i] != 0) {
-          secsBuffer[i] -= 1;
-        }
-      }
+      uint64_t nanos = static_cast<uint64_t>(nanoBuffer[i]);
+      nanoBuffer[i] = static_cast<int64_t>((nanos >> 3) *
+                                           NANO_SCALE[nanos & 0x7]);
+      secsBuffer[i] = static_cast<int64_t>(
+        static_cast<uint64_t>(secsBuffer[i]) +
+        static_cast<uint64_t>(epochOffset));
+    }
+    writerTimezone.convertToUTC(secsBuffer, numValues, notNull);
+    for(uint64_t i=0; i < numValues; i++) {
+      uint64_t borrow = (secsBuffer[i] < 0 && nanoBuffer[i] != 0) ? 1 : 0;
+      secsBuffer[i] = static_cast<int64_t>(
+        static_cast<uint64_t>(secsBuffer[i]) - borrow);
     }
   }
 
@@ -388,6 +413,76 @@ namespace orc {
     nanoRle->seek(positions.at(columnId));
   }
 
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  static void copyDoubles(const char* input, double* output, uint64_t count) {
+    for (uint64_t i = 0; i < count; ++i) {
+      uint64_t bits = 0;
+      for (uint64_t j = 0; j < 8; ++j) {
+        bits |= static_cast<uint64_t>(
+          static_cast<unsigned char>(input[i * 8 + j])) << (j * 8);
+      }
+      memcpy(output + i, &bits, sizeof(bits));
+    }
+  }
+
+  static void widenFloatsScalar(const char* input, double* output,
+                                uint64_t count) {
+    for (uint64_t i = 0; i < count; ++i) {
+      uint32_t bits = 0;
+      for (uint32_t j = 0; j < 4; ++j) {
+        bits |= static_cast<uint32_t>(
+          static_cast<unsigned char>(input[i * 4 + j])) << (j * 8);
+      }
+      float value;
+      memcpy(&value, &bits, sizeof(value));
+      output[i] = static_cast<double>(value);
+    }
+  }
+#else
+  // The values are stored little endian, just as they are in memory.
+  static void copyDoubles(const char* input, double* output, uint64_t count) {
+    memcpy(output, input, count * sizeof(double));
+  }
+
+  static void widenFloatsScalar(const char* input, double* output,
+                                uint64_t count) {
+    for (uint64_t i = 0; i < count; ++i) {
+      float value;
+      memcpy(&value, input + i * sizeof(float), sizeof(value));
+      output[i] = static_cast<double>(value);
+    }
+  }
+#endif
+
+#ifdef HAS_AVX2
+  __attribute__((target("avx2")))
+  static void widenFloatsAvx2(const char* input, double* output,
+                              uint64_t count) {
+    uint64_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+      __m256 values = _mm256_loadu_ps(
+        reinterpret_cast<const float*>(input + i * sizeof(float)));
+      _mm256_storeu_pd(output + i,
+                       _mm256_cvtps_pd(_mm256_castps256_ps128(values)));
+      _mm256_storeu_pd(output + i + 4,
+                       _mm256_cvtps_pd(_mm256_extractf128_ps(values, 1)));
+    }
+    widenFloatsScalar(input + i * sizeof(float), output + i, count - i);
+  }
+#endif
+
+  typedef void (*FloatWidener)(const char* input, double* output,
+                               uint64_t count);
+
+  static FloatWidener chooseFloatWidener() {
+#ifdef HAS_AVX2
+    if (cpuSupportsAvx2()) {
+      return widenFloatsAvx2;
+    }
+#endif
+    return widenFloatsScalar;
+  }
+
   class DoubleColumnReader: public ColumnReader {
   public:
     DoubleColumnReader(const Type& type, StripeStreams& stripe);
@@ -438,6 +533,8 @@ namespace orc {
       float *result = reinterpret_cast<float*>(&bits);
       return static_cast<double>(*result);
     }
+
+    void readValues(double* output, uint64_t count);
   };
 
   DoubleColumnReader::DoubleColumnReader(const Type& type,
@@ -479,6 +576,32 @@ namespace orc {
     return numValues;
   }
 
+  /**
+   * Read count consecutive values into output. Whole values are copied or
+   * widened straight out of the stream's buffers; only a value that
+   * straddles two buffers is assembled a byte at a time.
+   */
+  void DoubleColumnReader::readValues(double* output, uint64_t count) {
+    static const FloatWidener widenFloats = chooseFloatWidener();
+    uint64_t i = 0;
+    while (i < count) {
+      uint64_t available =
+        static_cast<uint64_t>(bufferEnd - bufferPointer) / bytesPerValue;
+      if (available == 0) {
+        output[i++] = columnKind == FLOAT ? readFloat() : readDouble();
+        continue;
+      }
+      uint64_t n = std::min(available, count - i);
+      if (columnKind == FLOAT) {
+        widenFloats(bufferPointer, output + i, n);
+      } else {
+        copyDoubles(bufferPointer, output + i, n);
+      }
+      bufferPointer += n * bytesPerValue;
+      i += n;
+    }
+  }
+
   void DoubleColumnReader::next(ColumnVectorBatch& rowBatch,
                                 uint64_t numValues,
                                 char *notNull) {
@@ -487,30 +610,21 @@ namespace orc {
     notNull = rowBatch.hasNulls ? rowBatch.notNull.data() : nullptr;
     double* outArray = dynamic_cast<DoubleVectorBatch&>(rowBatch).data.data();
 
-    if (columnKind == FLOAT) {
-      if (notNull) {
-        for(size_t i=0; i < numValues; ++i) {
-          if (notNull[i]) {
-            outArray[i] = readFloat();
-          }
-        }
-      } else {
-        for(size_t i=0; i < numValues; ++i) {
-          outArray[i] = readFloat();
-        }
+    if (notNull) {
+      // read the non-null values to the front and then move each one back
+      // to its row, working from the end so nothing is overwritten early
+      uint64_t nonNulls = 0;
+      for (uint64_t i = 0; i < numValues; ++i) {
+        nonNulls += notNull[i] ? 1 : 0;
       }
-    } else {
-      if (notNull) {
-        for(size_t i=0; i < numValues; ++i) {
-          if (notNull[i]) {
-            outArray[i] = readDouble();
-          }
-        }
-      } else {
-        for(size_t i=0; i < numValues; ++i) {
-          outArray[i] = readDouble();
+      readValues(outArray, nonNulls);
+      for (uint64_t i = numValues; i > 0 && nonNulls < i; --i) {
+        if (notNull[i - 1]) {
+          outArray[i - 1] = outArray[--nonNulls];
         }
       }
+    } else {
+      readValues(outArray, numValues);
     }
   }
 
@@ -840,9 +954,244 @@ namespace orc {
     lengthRle->seek(positions.at(columnId));
   }
 
+  static void appendRows(ColumnVectorBatch& to, uint64_t toOffset,
+                         ColumnVectorBatch& from, uint64_t fromOffset,
+                         uint64_t count);
+
+  static void appendStrings(StringVectorBatch& to, uint64_t toOffset,
+                            StringVectorBatch& from,
+                            uint64_t fromOffset, uint64_t count) {
+    to.isEncoded = from.isEncoded;
+    if (from.isEncoded) {
+      EncodedStringVectorBatch& encodedTo =
+        dynamic_cast<EncodedStringVectorBatch&>(to);
+      EncodedStringVectorBatch& encodedFrom =
+        dynamic_cast<EncodedStringVectorBatch&>(from);
+      encodedTo.dictionary = encodedFrom.dictionary;
+      memcpy(encodedTo.index.data() + toOffset,
+             encodedFrom.index.data() + fromOffset, count * sizeof(int64_t));
+      return;
+    }
+    memcpy(to.length.data() + toOffset, from.length.data() + fromOffset,
+           count * sizeof(int64_t));
+    const char* notNull =
+      from.hasNulls ? from.notNull.data() + fromOffset : nullptr;
+    char* const* fromData = from.data.data() + fromOffset;
+    const int64_t* lengths = from.length.data() + fromOffset;
+
+    // Values in from's blob are copied to to's blob, since from is reused
+    // for the next rows. The others point into a dictionary that outlives
+    // the batch and are left where they are.
+    const uintptr_t blobStart = reinterpret_cast<uintptr_t>(from.blob.data());
+    const uintptr_t blobEnd = blobStart + from.blob.size();
+    uint64_t bytes = 0;
+    for (uint64_t i = 0; i < count; ++i) {
+      uintptr_t value = reinterpret_cast<uintptr_t>(fromData[i]);
+      if ((notNull == nullptr || notNull[i]) &&
+          value >= blobStart && value < blobEnd) {
+        bytes += static_cast<uint64_t>(lengths[i]);
+      }
+    }
+    uint64_t used = toOffset == 0 ? 0 : to.blob.size();
+    char* oldBlob = to.blob.data();
+    if (used + bytes > to.blob.capacity()) {
+      to.blob.reserve(std::max(used + bytes, 2 * to.blob.capacity()));
+    }
+    to.blob.resize(used + bytes);
+    char* blob = to.blob.data();
+    char** toData = to.data.data();
+    if (blob != oldBlob) {
+      // move the earlier rows that point into the old blob
+      for (uint64_t i = 0; i < toOffset; ++i) {
+        uintptr_t value = reinterpret_cast<uintptr_t>(toData[i]);
+        uintptr_t oldStart = reinterpret_cast<uintptr_t>(oldBlob);
+        if (to.notNull[i] && value >= oldStart && value < oldStart + used) {
+          toData[i] = blob + (value - oldStart);
+        }
+      }
+    }
+    for (uint64_t i = 0; i < count; ++i) {
+      uintptr_t value = reinterpret_cast<uintptr_t>(fromData[i]);
+      if ((notNull == nullptr || notNull[i]) &&
+          value >= blobStart && value < blobEnd) {
+        size_t length = static_cast<size_t>(lengths[i]);
+        memcpy(blob + used, fromData[i], length);
+        toData[toOffset + i] = blob + used;
+        used += length;
+      } else {
+        toData[toOffset + i] = fromData[i];
+      }
+    }
+  }
+
+  /**
+   * Copy the offsets of rows [fromOffset, fromOffset + count] of a list or
+   * map so that they continue from the offset of row toOffset.
+   */
+  static void appendOffsets(DataBuffer<int64_t>& to, uint64_t toOffset,
+                            DataBuffer<int64_t>& from,
+                            uint64_t fromOffset, uint64_t count) {
+    if (toOffset == 0) {
+      to[0] = 0;
+    }
+    int64_t shift = to[toOffset] - from[fromOffset];
+    for (uint64_t i = 1; i <= count; ++i) {
+      to[toOffset + i] = from[fromOffset + i] + shift;
+    }
+  }
+
+  static void appendUnion(UnionVectorBatch& to, uint64_t toOffset,
+                          UnionVectorBatch& from, uint64_t fromOffset,
+                          uint64_t count) {
+    const char* notNull =
+      from.hasNulls ? from.notNull.data() + fromOffset : nullptr;
+    size_t numChildren = to.children.size();
+    std::vector<uint64_t> base(numChildren, 0);
+    std::vector<uint64_t> first(numChildren, 0);
+    std::vector<uint64_t> counts(numChildren, 0);
+    for (size_t k = 0; k < numChildren && toOffset > 0; ++k) {
+      base[k] = to.children[k]->numElements;
+    }
+    memcpy(to.tags.data() + toOffset, from.tags.data() + fromOffset, count);
+    for (uint64_t i = 0; i < count; ++i) {
+      if (notNull == nullptr || notNull[i]) {
+        size_t tag = from.tags[fromOffset + i];
+        uint64_t offset = from.offsets[fromOffset + i];
+        if (counts[tag] == 0) {
+          first[tag] = offset;
+        }
+        to.offsets[toOffset + i] = base[tag] + offset - first[tag];
+        counts[tag] += 1;
+      }
+    }
+    for (size_t k = 0; k < numChildren; ++k) {
+      if (toOffset == 0 || counts[k] > 0) {
+        appendRows(*to.children[k], base[k], *from.children[k], first[k],
+                   counts[k]);
+      }
+    }
+  }
+
+  /**
+   * Copy rows [fromOffset, fromOffset + count) of a batch to the rows of
+   * another batch of the same type starting at toOffset. This is how the
+   * rows a RowFilter keeps are gathered into the output batch. Rows that
+   * were never read, such as those of columns that aren't selected, aren't
+   * copied.
+   */
+  static void appendRows(ColumnVectorBatch& to, uint64_t toOffset,
+                         ColumnVectorBatch& from, uint64_t fromOffset,
+                         uint64_t count) {
+    to.resize(toOffset + count);
+    if (toOffset == 0) {
+      to.hasNulls = false;
+    }
+    to.numElements = toOffset + count;
+    if (count == 0 || fromOffset + count > from.numElements) {
+      return;
+    }
+    if (from.hasNulls) {
+      const char* notNull = from.notNull.data() + fromOffset;
+      memcpy(to.notNull.data() + toOffset, notNull, count);
+      to.hasNulls = to.hasNulls || memchr(notNull, 0, count) != nullptr;
+    } else {
+      memset(to.notNull.data() + toOffset, 1, count);
+    }
+
+    if (LongVectorBatch* longs = dynamic_cast<LongVectorBatch*>(&to)) {
+      memcpy(longs->data.data() + toOffset,
+             dynamic_cast<LongVectorBatch&>(from).data.data() +
+               fromOffset, count * sizeof(int64_t));
+    } else if (DoubleVectorBatch* doubles =
+                 dynamic_cast<DoubleVectorBatch*>(&to)) {
+      memcpy(doubles->data.data() + toOffset,
+             dynamic_cast<DoubleVectorBatch&>(from).data.data() +
+               fromOffset, count * sizeof(double));
+    } else if (StringVectorBatch* strings =
+                 dynamic_cast<StringVectorBatch*>(&to)) {
+      appendStrings(*strings, toOffset,
+                    dynamic_cast<StringVectorBatch&>(from), fromOffset,
+                    count);
+    } else if (TimestampVectorBatch* timestamps =
+                 dynamic_cast<TimestampVectorBatch*>(&to)) {
+      TimestampVectorBatch& fromTimestamps =
+        dynamic_cast<TimestampVectorBatch&>(from);
+      memcpy(timestamps->data.data() + toOffset,
+             fromTimestamps.data.data() + fromOffset,
+             count * sizeof(int64_t));
+      memcpy(timestamps->nanoseconds.data() + toOffset,
+             fromTimestamps.nanoseconds.data() + fromOffset,
+             count * sizeof(int64_t));
+    } else if (Decimal64VectorBatch* decimals =
+                 dynamic_cast<Decimal64VectorBatch*>(&to)) {
+      Decimal64VectorBatch& fromDecimals =
+        dynamic_cast<Decimal64VectorBatch&>(from);
+      decimals->precision = fromDecimals.precision;
+      decimals->scale = fromDecimals.scale;
+      memcpy(decimals->values.data() + toOffset,
+             fromDecimals.values.data() + fromOffset,
+             count * sizeof(int64_t));
+    } else if (Decimal128VectorBatch* decimals =
+                 dynamic_cast<Decimal128VectorBatch*>(&to)) {
+      Decimal128VectorBatch& fromDecimals =
+        dynamic_cast<Decimal128VectorBatch&>(from);
+      decimals->precision = fromDecimals.precision;
+      decimals->scale = fromDecimals.scale;
+      std::copy(fromDecimals.values.data() + fromOffset,
+                fromDecimals.values.data() + fromOffset + count,
+                decimals->values.data() + toOffset);
+    } else if (StructVectorBatch* structs =
+                 dynamic_cast<StructVectorBatch*>(&to)) {
+      StructVectorBatch& fromStructs =
+        dynamic_cast<StructVectorBatch&>(from);
+      for (size_t k = 0; k < structs->fields.size(); ++k) {
+        appendRows(*structs->fields[k], toOffset, *fromStructs.fields[k],
+                   fromOffset, count);
+      }
+    } else if (ListVectorBatch* lists = dynamic_cast<ListVectorBatch*>(&to)) {
+      ListVectorBatch& fromLists =
+        dynamic_cast<ListVectorBatch&>(from);
+      appendOffsets(lists->offsets, toOffset, fromLists.offsets, fromOffset,
+                    count);
+      uint64_t childStart = static_cast<uint64_t>(fromLists.offsets[fromOffset]);
+      appendRows(*lists->elements,
+                 static_cast<uint64_t>(lists->offsets[toOffset]),
+                 *fromLists.elements, childStart,
+                 static_cast<uint64_t>(fromLists.offsets[fromOffset + count]) -
+                   childStart);
+    } else if (MapVectorBatch* maps = dynamic_cast<MapVectorBatch*>(&to)) {
+      MapVectorBatch& fromMaps = dynamic_cast<MapVectorBatch&>(from);
+      appendOffsets(maps->offsets, toOffset, fromMaps.offsets, fromOffset,
+                    count);
+      uint64_t childStart = static_cast<uint64_t>(fromMaps.offsets[fromOffset]);
+      uint64_t childCount =
+        static_cast<uint64_t>(fromMaps.offsets[fromOffset + count]) -
+        childStart;
+      uint64_t childOffset = static_cast<uint64_t>(maps->offsets[toOffset]);
+      appendRows(*maps->keys, childOffset, *fromMaps.keys, childStart,
+                 childCount);
+      appendRows(*maps->elements, childOffset, *fromMaps.elements, childStart,
+                 childCount);
+    } else if (UnionVectorBatch* unions =
+                 dynamic_cast<UnionVectorBatch*>(&to)) {
+      appendUnion(*unions, toOffset,
+                  dynamic_cast<UnionVectorBatch&>(from), fromOffset,
+                  count);
+    } else {
+      throw NotImplementedYet("Can't filter the rows of " + to.toString());
+    }
+  }
+
   class StructColumnReader: public ColumnReader {
   private:
     std::vector<std::unique_ptr<ColumnReader>> children;
+    std::vector<const Type*> childTypes;
+
+    // for nextFiltered: the filter columns as the filter sees them, the
+    // rows to keep, and a batch per child to read runs of kept rows into
+    std::unique_ptr<StructVectorBatch> filterBatch;
+    std::vector<char> keep;
+    std::vector<std::unique_ptr<ColumnVectorBatch>> runBatches;
 
   public:
     StructColumnReader(const Type& type, StripeStreams& stipe);
@@ -860,6 +1209,12 @@ namespace orc {
     void seekToRowGroup(
       std::unordered_map<uint64_t, PositionProvider>& positions) override;
 
+    uint64_t nextFiltered(ColumnVectorBatch& rowBatch,
+                          uint64_t numValues,
+                          const RowFilter& filter,
+                          const std::vector<uint64_t>& filterFields,
+                          bool encoded) override;
+
   private:
     template<bool encoded>
     void nextInternal(ColumnVectorBatch& rowBatch,
@@ -878,6 +1233,7 @@ namespace orc {
         const Type& child = *type.getSubtype(i);
         if (selectedColumns[static_cast<uint64_t>(child.getColumnId())]) {
           children.push_back(buildReader(child, stripe));
+          childTypes.push_back(&child);
         }
       }
       break;
@@ -914,16 +1270,10 @@ namespace orc {
                                 uint64_t numValues,
                                 char *notNull) {
     ColumnReader::next(rowBatch, numValues, notNull);
-    uint64_t i=0;
     notNull = rowBatch.hasNulls? rowBatch.notNull.data() : nullptr;
-    for(auto iter = children.begin(); iter != children.end(); ++iter, ++i) {
-      if (encoded) {
-        (*iter)->nextEncoded(*(dynamic_cast<StructVectorBatch&>(rowBatch).fields[i]),
-                    numValues, notNull);
-      } else {
-        (*iter)->next(*(dynamic_cast<StructVectorBatch&>(rowBatch).fields[i]),
-                    numValues, notNull);
-      }
+    StructVectorBatch& batch = dynamic_cast<StructVectorBatch&>(rowBatch);
+    for(size_t i = 0; i < children.size(); ++i) {
+      readChild(*children[i], *batch.fields[i], numValues, notNull, encoded);
     }
   }
 
@@ -936,6 +1286,116 @@ namespace orc {
     }
   }
 
+  uint64_t StructColumnReader::nextFiltered(ColumnVectorBatch& rowBatch,
+                                            uint64_t numValues,
+                                            const RowFilter& filter,
+                                            const std::vector<uint64_t>&
+                                              filterFields,
+                                            bool encoded) {
+    ColumnReader::next(rowBatch, numValues, nullptr);
+    char* notNull = rowBatch.hasNulls ? rowBatch.notNull.data() : nullptr;
+    StructVectorBatch& batch = dynamic_cast<StructVectorBatch&>(rowBatch);
+    if (filterBatch.get() == nullptr) {
+      filterBatch.reset(new StructVectorBatch(numValues, memoryPool));
+      for (uint64_t field : filterFields) {
+        filterBatch->fields.push_back(
+          childTypes[field]->createRowBatch(numValues, memoryPool,
+                                            encoded).release());
+      }
+      runBatches.resize(children.size());
+    }
+
+    // read the filter columns and let the filter pick the rows
+    filterBatch->resize(numValues);
+    filterBatch->numElements = numValues;
+    filterBatch->hasNulls = rowBatch.hasNulls;
+    if (notNull) {
+      memcpy(filterBatch->notNull.data(), notNull, numValues);
+    }
+    std::vector<int64_t> filterIndex(children.size(), -1);
+    for (size_t k = 0; k < filterFields.size(); ++k) {
+      filterIndex[filterFields[k]] = static_cast<int64_t>(k);
+      readChild(*children[filterFields[k]], *filterBatch->fields[k],
+                numValues, notNull, encoded);
+    }
+    keep.assign(numValues, 1);
+    filter.filter(*filterBatch, keep.data());
+
+    // the runs of rows that are kept, as pairs of start and length
+    std::vector<std::pair<uint64_t, uint64_t>> runs;
+    uint64_t kept = 0;
+    for (uint64_t row = 0; row < numValues; ) {
+      uint64_t end = row;
+      while (end < numValues && (keep[end] != 0) == (keep[row] != 0)) {
+        end += 1;
+      }
+      if (keep[row]) {
+        runs.push_back(std::make_pair(row, end - row));
+        kept += end - row;
+      }
+      row = end;
+    }
+
+    for (size_t i = 0; i < children.size(); ++i) {
+      ColumnVectorBatch& output = *batch.fields[i];
+      if (filterIndex[i] >= 0) {
+        ColumnVectorBatch& decoded =
+          *filterBatch->fields[static_cast<size_t>(filterIndex[i])];
+        appendRows(output, 0, decoded, 0, 0);
+        uint64_t outputRow = 0;
+        for (const auto& run : runs) {
+          appendRows(output, outputRow, decoded, run.first, run.second);
+          outputRow += run.second;
+        }
+      } else if (kept == numValues) {
+        readChild(*children[i], output, numValues, notNull, encoded);
+      } else {
+        if (runBatches[i].get() == nullptr) {
+          runBatches[i] = childTypes[i]->createRowBatch(1, memoryPool,
+                                                        encoded);
+        }
+        appendRows(output, 0, *runBatches[i], 0, 0);
+        uint64_t row = 0;
+        uint64_t outputRow = 0;
+        for (const auto& run : runs) {
+          // skip the rejected rows before the run; the child only has
+          // values for the rows where the struct isn't null
+          uint64_t skipped = run.first - row;
+          if (notNull) {
+            skipped = static_cast<uint64_t>(
+              std::count_if(notNull + row, notNull + run.first,
+                            [](char value) { return value != 0; }));
+          }
+          children[i]->skip(skipped);
+          readChild(*children[i], *runBatches[i], run.second,
+                    notNull ? notNull + run.first : nullptr, encoded);
+          appendRows(output, outputRow, *runBatches[i], 0, run.second);
+          outputRow += run.second;
+          row = run.first + run.second;
+        }
+        uint64_t skipped = numValues - row;
+        if (notNull) {
+          skipped = static_cast<uint64_t>(
+            std::count_if(notNull + row, notNull + numValues,
+                          [](char value) { return value != 0; }));
+        }
+        children[i]->skip(skipped);
+      }
+    }
+
+    // compact the struct's own nulls
+    if (notNull) {
+      uint64_t outputRow = 0;
+      for (const auto& run : runs) {
+        memmove(notNull + outputRow, notNull + run.first, run.second);
+        outputRow += run.second;
+      }
+      batch.hasNulls = memchr(notNull, 0, kept) != nullptr;
+    }
+    batch.numElements = kept;
+    return kept;
+  }
+
   class ListColumnReader: public ColumnReader {
   private:
     std::unique_ptr<ColumnReader> child;
@@ -1051,11 +1511,8 @@ namespace orc {
     offsets[numValues] = static_cast<int64_t>(totalChildren);
     ColumnReader *childReader = child.get();
     if (childReader) {
-      if (encoded) {
-        childReader->nextEncoded(*(listBatch.elements.get()), totalChildren, nullptr);
-      } else {
-        childReader->next(*(listBatch.elements.get()), totalChildren, nullptr);
-      }
+      readChild(*childReader, *(listBatch.elements.get()), totalChildren,
+                nullptr, encoded);
     }
   }
 
@@ -1196,19 +1653,13 @@ namespace orc {
     offsets[numValues] = static_cast<int64_t>(totalChildren);
     ColumnReader *rawKeyReader = keyReader.get();
     if (rawKeyReader) {
-      if (encoded) {
-        rawKeyReader->nextEncoded(*(mapBatch.keys.get()), totalChildren, nullptr);
-      } else {
-        rawKeyReader->next(*(mapBatch.keys.get()), totalChildren, nullptr);
-      }
+      readChild(*rawKeyReader, *(mapBatch.keys.get()), totalChildren,
+                nullptr, encoded);
     }
     ColumnReader *rawElementReader = elementReader.get();
     if (rawElementReader) {
-      if (encoded) {
-        rawElementReader->nextEncoded(*(mapBatch.elements.get()), totalChildren, nullptr);
-      } else {
-        rawElementReader->next(*(mapBatch.elements.get()), totalChildren, nullptr);
-      }
+      readChild(*rawElementReader, *(mapBatch.elements.get()), totalChildren,
+                nullptr, encoded);
     }
   }
 
@@ -1340,13 +1791,8 @@ namespace orc {
     // read the right number of each child column
     for(size_t i=0; i < numChildren; ++i) {
       if (childrenReader[i] != nullptr) {
-        if (encoded) {
-          childrenReader[i]->nextEncoded(*(unionBatch.children[i]),
-                                  static_cast<uint64_t>(counts[i]), nullptr);
-        } else {
-          childrenReader[i]->next(*(unionBatch.children[i]),
-                                  static_cast<uint64_t>(counts[i]), nullptr);
-        }
+        readChild(*childrenReader[i], *(unionBatch.children[i]),
+                  static_cast<uint64_t>(counts[i]), nullptr, encoded);
       }
     }
   }
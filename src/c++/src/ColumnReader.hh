@@ -30,6 +30,9 @@
 
 namespace orc {
 
+  class RowFilter;
+  struct ReaderMetricsCounters;
+
   class StripeStreams {
   public:
     virtual ~StripeStreams();
@@ -86,6 +89,12 @@ namespace orc {
      * @return the number of scale digits
      */
     virtual int32_t getForcedScaleOnHive11Decimal() const = 0;
+
+    /**
+     * Get the counters that the readers of the columns add their work to.
+     * @return the counters or nullptr if nothing is counted
+     */
+    virtual ReaderMetricsCounters* getMetricsCounters() const;
   };
 
   /**
@@ -96,6 +105,18 @@ namespace orc {
     std::unique_ptr<ByteRleDecoder> notNullDecoder;
     uint64_t columnId;
     MemoryPool& memoryPool;
+    // where the decode time of the children is counted, if anywhere
+    ReaderMetricsCounters* metrics;
+
+    /**
+     * Read the next group of values of a child column and count the time
+     * that it takes toward the child.
+     */
+    void readChild(ColumnReader& child,
+                   ColumnVectorBatch& batch,
+                   uint64_t numValues,
+                   char* notNull,
+                   bool encoded);
 
   public:
     ColumnReader(const Type& type, StripeStreams& stipe);
@@ -144,6 +165,23 @@ namespace orc {
     virtual void seekToRowGroup(
       std::unordered_map<uint64_t, PositionProvider>& positions);
 
+    /**
+     * Read the next group of rows of a struct and keep only the ones that
+     * pass the filter. The filter columns are read first. The other
+     * children are only decoded for the rows that are kept and skip the
+     * rest, and the batch is compacted down to the kept rows.
+     * @param rowBatch the memory to read into
+     * @param numValues the number of rows to read
+     * @param filter the filter that picks the rows
+     * @param filterFields the indexes of the filter columns in the children
+     * @param encoded should the children be read with nextEncoded
+     * @return the number of rows kept
+     */
+    virtual uint64_t nextFiltered(ColumnVectorBatch& rowBatch,
+                                  uint64_t numValues,
+                                  const RowFilter& filter,
+                                  const std::vector<uint64_t>& filterFields,
+                                  bool encoded);
   };
 
   /**
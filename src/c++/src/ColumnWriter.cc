@@ -24,6 +24,10 @@
 #include "RLE.hh"
 #include "Statistics.hh"
 #include "Timezone.hh"
+#include "WorkerPool.hh"
+
+#include <algorithm>
+#include <limits>
 
 namespace orc {
   StreamsFactory::~StreamsFactory() {
@@ -164,6 +168,10 @@ namespace orc {
     colStripeStatistics->reset();
   }
 
+  void ColumnWriter::mergeFileStatistics(const ColumnWriter& other) {
+    colFileStatistics->merge(*other.colFileStatistics);
+  }
+
   void ColumnWriter::mergeRowGroupStatsIntoStripeStats() {
     colStripeStatistics->merge(*colIndexStatistics);
     colIndexStatistics->reset();
@@ -272,6 +280,8 @@ namespace orc {
 
     virtual void mergeStripeStatsIntoFileStats() override;
 
+    virtual void mergeFileStatistics(const ColumnWriter& other) override;
+
     virtual void mergeRowGroupStatsIntoStripeStats() override;
 
     virtual void createRowIndexEntry() override;
@@ -283,7 +293,17 @@ namespace orc {
 
     virtual void reset() override;
 
-  private:
+  protected:
+    // for subclasses that build the children themselves
+    StructColumnWriter(
+                       const Type& type,
+                       const StreamsFactory& factory,
+                       const WriterOptions& options,
+                       bool buildChildren);
+
+    // update the statistics of the struct itself after adding rows
+    void updateStatistics(const char* notNull, uint64_t numValues);
+
     std::vector<std::unique_ptr<ColumnWriter>> children;
   };
 
@@ -291,10 +311,24 @@ namespace orc {
                                          const Type& type,
                                          const StreamsFactory& factory,
                                          const WriterOptions& options) :
+                                         StructColumnWriter(type,
+                                                            factory,
+                                                            options,
+                                                            true) {
+    // PASS
+  }
+
+  StructColumnWriter::StructColumnWriter(
+                                         const Type& type,
+                                         const StreamsFactory& factory,
+                                         const WriterOptions& options,
+                                         bool buildChildren) :
                                          ColumnWriter(type, factory, options) {
-    for(unsigned int i = 0; i < type.getSubtypeCount(); ++i) {
-      const Type& child = *type.getSubtype(i);
-      children.push_back(buildWriter(child, factory, options));
+    if (buildChildren) {
+      for(unsigned int i = 0; i < type.getSubtypeCount(); ++i) {
+        const Type& child = *type.getSubtype(i);
+        children.push_back(buildWriter(child, factory, options));
+      }
     }
 
     if (enableIndex) {
@@ -319,8 +353,11 @@ namespace orc {
     for (uint32_t i = 0; i < children.size(); ++i) {
       children[i]->add(*structBatch->fields[i], offset, numValues, notNull);
     }
+    updateStatistics(notNull, numValues);
+  }
 
-    // update stats
+  void StructColumnWriter::updateStatistics(const char* notNull,
+                                            uint64_t numValues) {
     if (!notNull) {
       colIndexStatistics->increase(numValues);
     } else {
@@ -388,6 +425,15 @@ namespace orc {
     }
   }
 
+  void StructColumnWriter::mergeFileStatistics(const ColumnWriter& other) {
+    ColumnWriter::mergeFileStatistics(other);
+    const StructColumnWriter& otherStruct =
+      dynamic_cast<const StructColumnWriter&>(other);
+    for (uint32_t i = 0; i < children.size(); ++i) {
+      children[i]->mergeFileStatistics(*otherStruct.children[i]);
+    }
+  }
+
   void StructColumnWriter::getFileStatistics(
     std::vector<proto::ColumnStatistics>& stats) const {
     ColumnWriter::getFileStatistics(stats);
@@ -427,6 +473,206 @@ namespace orc {
     }
   }
 
+  /**
+   * An OutputStream that collects a column's streams in memory, so that
+   * they can be encoded on a worker thread and written to the file later.
+   */
+  class ColumnStreamBuffer : public OutputStream {
+  public:
+    ColumnStreamBuffer(MemoryPool& pool): buffer(pool), used(0) {}
+
+    uint64_t getLength() const override {
+      return used;
+    }
+
+    uint64_t getNaturalWriteSize() const override {
+      return 128 * 1024;
+    }
+
+    void write(const void* buf, size_t length) override {
+      if (used + length > buffer.capacity()) {
+        buffer.reserve(std::max(used + length, buffer.capacity() * 2));
+      }
+      buffer.resize(used + length);
+      memcpy(buffer.data() + used, buf, length);
+      used += length;
+    }
+
+    const std::string& getName() const override {
+      static const std::string name = "ColumnStreamBuffer";
+      return name;
+    }
+
+    void close() override {
+      // PASS
+    }
+
+    // write the collected bytes to the file and empty the buffer
+    void writeTo(OutputStream* outStream) {
+      if (used > 0) {
+        outStream->write(buffer.data(), used);
+        used = 0;
+      }
+    }
+
+  private:
+    DataBuffer<char> buffer;
+    uint64_t used;
+  };
+
+  /**
+   * Sends the index streams and the data streams of a column to different
+   * places, since all index streams of a stripe precede its data streams.
+   */
+  class SplitStreamsFactory : public StreamsFactory {
+  public:
+    SplitStreamsFactory(std::unique_ptr<StreamsFactory> _indexFactory,
+                        std::unique_ptr<StreamsFactory> _dataFactory):
+                          indexFactory(std::move(_indexFactory)),
+                          dataFactory(std::move(_dataFactory)) {
+      // PASS
+    }
+
+    std::unique_ptr<BufferedOutputStream>
+                createStream(proto::Stream_Kind kind) const override {
+      if (kind == proto::Stream_Kind_ROW_INDEX ||
+          kind == proto::Stream_Kind_BLOOM_FILTER_UTF8) {
+        return indexFactory->createStream(kind);
+      }
+      return dataFactory->createStream(kind);
+    }
+
+  private:
+    std::unique_ptr<StreamsFactory> indexFactory;
+    std::unique_ptr<StreamsFactory> dataFactory;
+  };
+
+  /**
+   * The writer of the top-level struct when there are worker threads. Each
+   * child column, with its own children, is added, dictionary encoded and
+   * flushed on a worker. The children's streams collect in memory and are
+   * copied to the file in column order, so the stripe is laid out as it
+   * would be by StructColumnWriter.
+   */
+  class ParallelStructColumnWriter : public StructColumnWriter {
+  public:
+    ParallelStructColumnWriter(
+                               const Type& type,
+                               const StreamsFactory& factory,
+                               OutputStream* outStream,
+                               const WriterOptions& options,
+                               WorkerPool& pool);
+
+    virtual void add(ColumnVectorBatch& rowBatch,
+                     uint64_t offset,
+                     uint64_t numValues,
+                     const char* incomingMask) override;
+
+    virtual void flush(std::vector<proto::Stream>& streams) override;
+
+    virtual void writeIndex(
+      std::vector<proto::Stream> &streams) const override;
+
+    virtual void writeDictionary() override;
+
+  private:
+    // copy the children's buffered streams to the file in column order
+    void writeChildStreams(
+            const std::vector<std::unique_ptr<ColumnStreamBuffer>>& buffers,
+            const std::vector<std::vector<proto::Stream>>& childStreams,
+            std::vector<proto::Stream>& streams) const;
+
+    OutputStream* outStream;
+    WorkerPool& workerPool;
+    std::vector<std::unique_ptr<ColumnStreamBuffer>> indexBuffers;
+    std::vector<std::unique_ptr<ColumnStreamBuffer>> dataBuffers;
+    std::vector<std::unique_ptr<StreamsFactory>> childFactories;
+  };
+
+  ParallelStructColumnWriter::ParallelStructColumnWriter(
+                                         const Type& type,
+                                         const StreamsFactory& factory,
+                                         OutputStream* _outStream,
+                                         const WriterOptions& options,
+                                         WorkerPool& pool) :
+                                         StructColumnWriter(type,
+                                                            factory,
+                                                            options,
+                                                            false),
+                                         outStream(_outStream),
+                                         workerPool(pool) {
+    for (unsigned int i = 0; i < type.getSubtypeCount(); ++i) {
+      indexBuffers.push_back(std::unique_ptr<ColumnStreamBuffer>(
+                                   new ColumnStreamBuffer(memPool)));
+      dataBuffers.push_back(std::unique_ptr<ColumnStreamBuffer>(
+                                   new ColumnStreamBuffer(memPool)));
+      childFactories.push_back(std::unique_ptr<StreamsFactory>(
+        new SplitStreamsFactory(
+                     createStreamsFactory(options, indexBuffers.back().get()),
+                     createStreamsFactory(options, dataBuffers.back().get()))));
+      children.push_back(buildWriter(*type.getSubtype(i),
+                                     *childFactories.back(),
+                                     options));
+    }
+  }
+
+  void ParallelStructColumnWriter::add(
+                               ColumnVectorBatch& rowBatch,
+                               uint64_t offset,
+                               uint64_t numValues,
+                               const char* incomingMask) {
+    const StructVectorBatch* structBatch =
+      dynamic_cast<const StructVectorBatch *>(&rowBatch);
+    if (structBatch == nullptr) {
+      throw InvalidArgument("Failed to cast to StructVectorBatch");
+    }
+
+    ColumnWriter::add(rowBatch, offset, numValues, incomingMask);
+    const char* notNull = structBatch->hasNulls ?
+                          structBatch->notNull.data() + offset : nullptr;
+    workerPool.parallelFor(children.size(), [&](size_t i) {
+      children[i]->add(*structBatch->fields[i], offset, numValues, notNull);
+    });
+    updateStatistics(notNull, numValues);
+  }
+
+  void ParallelStructColumnWriter::writeChildStreams(
+            const std::vector<std::unique_ptr<ColumnStreamBuffer>>& buffers,
+            const std::vector<std::vector<proto::Stream>>& childStreams,
+            std::vector<proto::Stream>& streams) const {
+    for (size_t i = 0; i < children.size(); ++i) {
+      buffers[i]->writeTo(outStream);
+      streams.insert(streams.end(),
+                     childStreams[i].begin(),
+                     childStreams[i].end());
+    }
+  }
+
+  void ParallelStructColumnWriter::flush(std::vector<proto::Stream>& streams) {
+    ColumnWriter::flush(streams);
+    std::vector<std::vector<proto::Stream>> childStreams(children.size());
+    workerPool.parallelFor(children.size(), [&](size_t i) {
+      children[i]->flush(childStreams[i]);
+    });
+    writeChildStreams(dataBuffers, childStreams, streams);
+  }
+
+  void ParallelStructColumnWriter::writeIndex(
+                      std::vector<proto::Stream> &streams) const {
+    ColumnWriter::writeIndex(streams);
+    std::vector<std::vector<proto::Stream>> childStreams(children.size());
+    workerPool.parallelFor(children.size(), [&](size_t i) {
+      children[i]->writeIndex(childStreams[i]);
+    });
+    writeChildStreams(indexBuffers, childStreams, streams);
+  }
+
+  void ParallelStructColumnWriter::writeDictionary() {
+    workerPool.parallelFor(children.size(), [&](size_t i) {
+      children[i]->writeDictionary();
+    });
+  }
+
   class IntegerColumnWriter : public ColumnWriter {
   public:
     IntegerColumnWriter(
@@ -906,6 +1152,11 @@ namespace orc {
 
   /**
    * Implementation of increasing sorted string dictionary
+   *
+   * Distinct strings are copied into arena blocks and found again
+   * through an open-addressing hash table, so an insert costs a hash and
+   * usually a single memcmp. The entries are kept in insertion order and
+   * are only sorted once, when the dictionary is flushed or reordered.
    */
   class SortedStringDictionary {
   public:
@@ -915,7 +1166,7 @@ namespace orc {
       size_t length;
     };
 
-    SortedStringDictionary():totalLength(0) {}
+    SortedStringDictionary();
 
     // insert a new string into dictionary, return its insertion order
     size_t insert(const char * data, size_t len);
@@ -939,20 +1190,34 @@ namespace orc {
     void clear();
 
   private:
-    struct LessThan {
-      bool operator()(const DictEntry& left, const DictEntry& right) const {
-        int ret = memcmp(left.data, right.data, std::min(left.length, right.length));
-        if (ret != 0) {
-          return ret < 0;
-        }
-        return left.length < right.length;
-      }
-    };
-
-    std::map<DictEntry, size_t, LessThan> dict;
-    std::vector<std::vector<char>> data;
+    static const size_t INITIAL_BUCKETS = 1024;
+    // arena blocks start small and double up to the maximum size
+    static const size_t MIN_BLOCK_SIZE = 4 * 1024;
+    static const size_t MAX_BLOCK_SIZE = 256 * 1024;
+
+    static uint64_t hash(const char * data, size_t len);
+    static bool lessThan(const DictEntry& left, const DictEntry& right);
+
+    const char * copyToArena(const char * str, size_t len);
+    void grow();
+    void sortEntries() const;
+
+    // distinct strings in insertion order, pointing into blocks
+    std::vector<DictEntry> entries;
+    std::vector<uint64_t> hashes;
+    // 1 + the entry index of each occupied bucket, 0 for empty buckets
+    std::vector<uint32_t> buckets;
+    // blocks are kept across clear() and reused by the next stripe
+    std::vector<std::unique_ptr<char[]>> blocks;
+    std::vector<size_t> blockSizes;
+    size_t blocksInUse;
+    size_t blockUsed;
     uint64_t totalLength;
 
+    // insertion indexes in dictionary order, built on first use
+    mutable std::vector<uint32_t> sortedEntries;
+    mutable bool isSorted;
+
     // use friend class here to avoid being bothered by const function calls
     friend class StringColumnWriter;
     friend class CharColumnWriter;
@@ -961,27 +1226,142 @@ namespace orc {
     std::vector<int64_t> idxInDictBuffer;
   };
 
+  SortedStringDictionary::SortedStringDictionary(
+                                              ): buckets(INITIAL_BUCKETS, 0),
+                                                 blocksInUse(0),
+                                                 blockUsed(0),
+                                                 totalLength(0),
+                                                 isSorted(true) {
+    // PASS
+  }
+
+  uint64_t SortedStringDictionary::hash(const char * data, size_t len) {
+    const uint64_t multiplier = 0x9e3779b97f4a7c15ULL;
+    uint64_t result = len * multiplier;
+    size_t i = 0;
+    for (; i + sizeof(uint64_t) <= len; i += sizeof(uint64_t)) {
+      uint64_t word;
+      memcpy(&word, data + i, sizeof(uint64_t));
+      result = (result ^ word) * multiplier;
+      result ^= result >> 32;
+    }
+    if (i < len) {
+      uint64_t word = 0;
+      memcpy(&word, data + i, len - i);
+      result = (result ^ word) * multiplier;
+    }
+    result ^= result >> 29;
+    result *= 0xbf58476d1ce4e5b9ULL;
+    result ^= result >> 32;
+    return result;
+  }
+
+  bool SortedStringDictionary::lessThan(const DictEntry& left,
+                                        const DictEntry& right) {
+    size_t len = std::min(left.length, right.length);
+    if (len > 0) {
+      int ret = memcmp(left.data, right.data, len);
+      if (ret != 0) {
+        return ret < 0;
+      }
+    }
+    return left.length < right.length;
+  }
+
+  const char * SortedStringDictionary::copyToArena(const char * str,
+                                                   size_t len) {
+    if (len == 0) {
+      return "";
+    }
+    if (blocksInUse == 0 || blockSizes[blocksInUse - 1] - blockUsed < len) {
+      // move on to the next kept block that fits, or allocate a new one
+      while (blocksInUse < blocks.size() && blockSizes[blocksInUse] < len) {
+        ++blocksInUse;
+      }
+      if (blocksInUse == blocks.size()) {
+        size_t blockSize = blocks.empty() ? MIN_BLOCK_SIZE :
+          std::min(blockSizes.back() * 2, MAX_BLOCK_SIZE);
+        blockSize = std::max(blockSize, len);
+        blocks.push_back(std::unique_ptr<char[]>(new char[blockSize]));
+        blockSizes.push_back(blockSize);
+      }
+      ++blocksInUse;
+      blockUsed = 0;
+    }
+    char * result = blocks[blocksInUse - 1].get() + blockUsed;
+    memcpy(result, str, len);
+    blockUsed += len;
+    return result;
+  }
+
+  // double the bucket count and re-insert every entry
+  void SortedStringDictionary::grow() {
+    std::vector<uint32_t> newBuckets(buckets.size() * 2, 0);
+    size_t mask = newBuckets.size() - 1;
+    for (size_t i = 0; i != entries.size(); ++i) {
+      size_t bucket = static_cast<size_t>(hashes[i]) & mask;
+      while (newBuckets[bucket] != 0) {
+        bucket = (bucket + 1) & mask;
+      }
+      newBuckets[bucket] = static_cast<uint32_t>(i + 1);
+    }
+    buckets.swap(newBuckets);
+  }
+
   // insert a new string into dictionary, return its insertion order
   size_t SortedStringDictionary::insert(const char * str, size_t len) {
-    auto ret = dict.insert({DictEntry(str, len), dict.size()});
-    if (ret.second) {
-      // make a copy to internal storage
-      data.push_back(std::vector<char>(len));
-      memcpy(data.back().data(), str, len);
-      // update dictionary entry to link pointer to internal storage
-      DictEntry * entry = const_cast<DictEntry *>(&(ret.first->first));
-      entry->data = data.back().data();
-      totalLength += len;
+    uint64_t hashValue = hash(str, len);
+    size_t mask = buckets.size() - 1;
+    size_t bucket = static_cast<size_t>(hashValue) & mask;
+    while (buckets[bucket] != 0) {
+      size_t index = buckets[bucket] - 1;
+      const DictEntry& entry = entries[index];
+      if (hashes[index] == hashValue && entry.length == len &&
+          (len == 0 || memcmp(entry.data, str, len) == 0)) {
+        return index;
+      }
+      bucket = (bucket + 1) & mask;
+    }
+
+    size_t index = entries.size();
+    if (index >= std::numeric_limits<uint32_t>::max()) {
+      throw std::logic_error("Too many distinct values in string dictionary");
+    }
+    entries.push_back(DictEntry(copyToArena(str, len), len));
+    hashes.push_back(hashValue);
+    buckets[bucket] = static_cast<uint32_t>(index + 1);
+    totalLength += len;
+    isSorted = false;
+    // keep the load factor at or below one half
+    if (entries.size() * 2 > buckets.size()) {
+      grow();
+    }
+    return index;
+  }
+
+  void SortedStringDictionary::sortEntries() const {
+    if (isSorted) {
+      return;
+    }
+    sortedEntries.resize(entries.size());
+    for (size_t i = 0; i != entries.size(); ++i) {
+      sortedEntries[i] = static_cast<uint32_t>(i);
     }
-    return ret.first->second;
+    std::sort(sortedEntries.begin(), sortedEntries.end(),
+              [this](uint32_t left, uint32_t right) {
+                return lessThan(entries[left], entries[right]);
+              });
+    isSorted = true;
   }
 
   // write dictionary data & length to output buffer
   void SortedStringDictionary::flush(AppendOnlyBufferedStream * dataStream,
                                RleEncoder * lengthEncoder) const {
-    for (auto it = dict.cbegin(); it != dict.cend(); ++it) {
-      dataStream->write(it->first.data, it->first.length);
-      lengthEncoder->write(static_cast<int64_t>(it->first.length));
+    sortEntries();
+    for (size_t i = 0; i != sortedEntries.size(); ++i) {
+      const DictEntry& entry = entries[sortedEntries[i]];
+      dataStream->write(entry.data, entry.length);
+      lengthEncoder->write(static_cast<int64_t>(entry.length));
     }
   }
 
@@ -996,11 +1376,12 @@ namespace orc {
    * output.
    */
   void SortedStringDictionary::reorder(std::vector<int64_t>& idxBuffer) const {
-    // iterate the dictionary to get mapping from insertion order to value order
-    std::vector<size_t> mapping(dict.size());
-    size_t dictIdx = 0;
-    for (auto it = dict.cbegin(); it != dict.cend(); ++it) {
-      mapping[it->second] = dictIdx++;
+    // invert the sorted order to get mapping from insertion order to value
+    // order
+    sortEntries();
+    std::vector<size_t> mapping(sortedEntries.size());
+    for (size_t i = 0; i != sortedEntries.size(); ++i) {
+      mapping[sortedEntries[i]] = i;
     }
 
     // do the transformation
@@ -1012,16 +1393,16 @@ namespace orc {
 
   // get dict entries in insertion order
   void SortedStringDictionary::getEntriesInInsertionOrder(
-                    std::vector<const DictEntry *>& entries) const {
-    entries.resize(dict.size());
-    for (auto it = dict.cbegin(); it != dict.cend(); ++it) {
-      entries[it->second] = &(it->first);
+                    std::vector<const DictEntry *>& result) const {
+    result.resize(entries.size());
+    for (size_t i = 0; i != entries.size(); ++i) {
+      result[i] = &entries[i];
     }
   }
 
   // return count of entries
   size_t SortedStringDictionary::size() const {
-    return dict.size();
+    return entries.size();
   }
 
   // return total length of strings in the dictioanry
@@ -1031,8 +1412,13 @@ namespace orc {
 
   void SortedStringDictionary::clear()  {
     totalLength = 0;
-    data.clear();
-    dict.clear();
+    entries.clear();
+    hashes.clear();
+    buckets.assign(INITIAL_BUCKETS, 0);
+    blocksInUse = 0;
+    blockUsed = 0;
+    sortedEntries.clear();
+    isSorted = true;
   }
 
   class StringColumnWriter : public ColumnWriter {
@@ -2196,6 +2582,8 @@ namespace orc {
 
     virtual void mergeStripeStatsIntoFileStats() override;
 
+    virtual void mergeFileStatistics(const ColumnWriter& other) override;
+
     virtual void mergeRowGroupStatsIntoStripeStats() override;
 
     virtual void createRowIndexEntry() override;
@@ -2351,6 +2739,14 @@ namespace orc {
     }
   }
 
+  void ListColumnWriter::mergeFileStatistics(const ColumnWriter& other) {
+    ColumnWriter::mergeFileStatistics(other);
+    if (child.get()) {
+      child->mergeFileStatistics(
+        *dynamic_cast<const ListColumnWriter&>(other).child);
+    }
+  }
+
   void ListColumnWriter::getFileStatistics(
                     std::vector<proto::ColumnStatistics>& stats) const {
     ColumnWriter::getFileStatistics(stats);
@@ -2418,6 +2814,8 @@ namespace orc {
 
     virtual void mergeStripeStatsIntoFileStats() override;
 
+    virtual void mergeFileStatistics(const ColumnWriter& other) override;
+
     virtual void mergeRowGroupStatsIntoStripeStats() override;
 
     virtual void createRowIndexEntry() override;
@@ -2600,6 +2998,18 @@ namespace orc {
     }
   }
 
+  void MapColumnWriter::mergeFileStatistics(const ColumnWriter& other) {
+    ColumnWriter::mergeFileStatistics(other);
+    const MapColumnWriter& otherMap =
+      dynamic_cast<const MapColumnWriter&>(other);
+    if (keyWriter.get()) {
+      keyWriter->mergeFileStatistics(*otherMap.keyWriter);
+    }
+    if (elemWriter.get()) {
+      elemWriter->mergeFileStatistics(*otherMap.elemWriter);
+    }
+  }
+
   void MapColumnWriter::getFileStatistics(
                    std::vector<proto::ColumnStatistics>& stats) const {
     ColumnWriter::getFileStatistics(stats);
@@ -2681,6 +3091,8 @@ namespace orc {
 
     virtual void mergeStripeStatsIntoFileStats() override;
 
+    virtual void mergeFileStatistics(const ColumnWriter& other) override;
+
     virtual void mergeRowGroupStatsIntoStripeStats() override;
 
     virtual void createRowIndexEntry() override;
@@ -2836,6 +3248,15 @@ namespace orc {
     }
   }
 
+  void UnionColumnWriter::mergeFileStatistics(const ColumnWriter& other) {
+    ColumnWriter::mergeFileStatistics(other);
+    const UnionColumnWriter& otherUnion =
+      dynamic_cast<const UnionColumnWriter&>(other);
+    for (uint32_t i = 0; i < children.size(); ++i) {
+      children[i]->mergeFileStatistics(*otherUnion.children[i]);
+    }
+  }
+
   void UnionColumnWriter::getFileStatistics(
                      std::vector<proto::ColumnStatistics>& stats) const {
     ColumnWriter::getFileStatistics(stats);
@@ -2997,4 +3418,22 @@ namespace orc {
                                   "ColumnWriter.");
     }
   }
+
+  std::unique_ptr<ColumnWriter> buildParallelWriter(
+                                            const Type& type,
+                                            const StreamsFactory& factory,
+                                            OutputStream* outStream,
+                                            const WriterOptions& options,
+                                            WorkerPool& pool) {
+    if (type.getKind() != STRUCT) {
+      return buildWriter(type, factory, options);
+    }
+    return std::unique_ptr<ColumnWriter>(
+      new ParallelStructColumnWriter(
+                                     type,
+                                     factory,
+                                     outStream,
+                                     options,
+                                     pool));
+  }
 }
@@ -31,6 +31,8 @@
 
 namespace orc {
 
+  class WorkerPool;
+
   class StreamsFactory {
   public:
     virtual ~StreamsFactory();
@@ -150,6 +152,12 @@ namespace orc {
      */
     virtual void mergeStripeStatsIntoFileStats();
 
+    /**
+     * Merge the file stats of another writer for the same type into this
+     * writer's file stats.
+     */
+    virtual void mergeFileStatistics(const ColumnWriter& other);
+
     /**
      * Create a row index entry with the previous location and the current
      * index statistics. Also merges the index statistics into the stripe
@@ -216,6 +224,19 @@ namespace orc {
                                             const Type& type,
                                             const StreamsFactory& factory,
                                             const WriterOptions& options);
+
+  /**
+   * Create a writer for the given type that adds, encodes and compresses
+   * the columns of a top-level struct on a worker pool. Their streams are
+   * held in memory until the stripe is written to outStream, which must be
+   * the stream that the factory writes to.
+   */
+  std::unique_ptr<ColumnWriter> buildParallelWriter(
+                                            const Type& type,
+                                            const StreamsFactory& factory,
+                                            OutputStream* outStream,
+                                            const WriterOptions& options,
+                                            WorkerPool& pool);
 }
 
 #endif
@@ -82,6 +82,8 @@ namespace orc {
         return "index";
       case StreamKind_BLOOM_FILTER:
         return "bloom";
+      case StreamKind_BLOOM_FILTER_UTF8:
+        return "bloom utf8";
     }
     std::stringstream buffer;
     buffer << "unknown - " << kind;
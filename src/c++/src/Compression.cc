@@ -18,6 +18,7 @@
 
 #include "Adaptor.hh"
 #include "Compression.hh"
+#include "ReaderMetrics.hh"
 #include "orc/Exceptions.hh"
 #include "LzoDecompressor.hh"
 #include "lz4.h"
@@ -38,6 +39,164 @@
 
 namespace orc {
 
+  /**
+   * The codec contexts of the current thread. A chunk is always compressed
+   * or decompressed within a single call, so the streams on a thread can
+   * take turns with one context of each kind. Setting up a context costs
+   * about as much as decompressing a small chunk, and a reader creates
+   * new streams for every stripe.
+   */
+  class CodecContexts {
+  public:
+    static CodecContexts& get() {
+      static thread_local CodecContexts contexts;
+      return contexts;
+    }
+
+    ~CodecContexts();
+
+    /**
+     * Get the inflate state for raw deflate streams.
+     */
+    z_stream& getInflate();
+
+    /**
+     * Get the deflate state for raw deflate streams, reset and set to the
+     * given level.
+     */
+    z_stream& getDeflate(int level);
+
+    ZSTD_CCtx* getZstdCompression();
+
+    ZSTD_DCtx* getZstdDecompression();
+
+    /**
+     * Get the state for LZ4_compress_fast_extState.
+     */
+    void* getLz4Compression();
+
+  private:
+    CodecContexts();
+
+    bool hasInflate;
+    z_stream inflateStream;
+    bool hasDeflate;
+    int deflateLevel;
+    z_stream deflateStream;
+    ZSTD_CCtx* zstdCompression;
+    ZSTD_DCtx* zstdDecompression;
+    // 64-bit words, since the state must be 8 byte aligned
+    std::unique_ptr<uint64_t[]> lz4Compression;
+  };
+
+  CodecContexts::CodecContexts(): hasInflate(false),
+                                  hasDeflate(false),
+                                  deflateLevel(0),
+                                  zstdCompression(nullptr),
+                                  zstdDecompression(nullptr) {
+    // PASS
+  }
+
+  CodecContexts::~CodecContexts() {
+    if (hasInflate) {
+      (void)inflateEnd(&inflateStream);
+    }
+    if (hasDeflate) {
+      (void)deflateEnd(&deflateStream);
+    }
+    ZSTD_freeCCtx(zstdCompression);
+    ZSTD_freeDCtx(zstdDecompression);
+  }
+
+DIAGNOSTIC_PUSH
+
+#if defined(__GNUC__) || defined(__clang__)
+  DIAGNOSTIC_IGNORE("-Wold-style-cast")
+#endif
+
+  z_stream& CodecContexts::getInflate() {
+    if (!hasInflate) {
+      inflateStream.next_in = nullptr;
+      inflateStream.avail_in = 0;
+      inflateStream.zalloc = nullptr;
+      inflateStream.zfree = nullptr;
+      inflateStream.opaque = nullptr;
+      int64_t result = inflateInit2(&inflateStream, -15);
+      switch (result) {
+      case Z_OK:
+        break;
+      case Z_MEM_ERROR:
+        throw std::logic_error("Memory error from inflateInit2");
+      case Z_VERSION_ERROR:
+        throw std::logic_error("Version error from inflateInit2");
+      case Z_STREAM_ERROR:
+        throw std::logic_error("Stream error from inflateInit2");
+      default:
+        throw std::logic_error("Unknown error from inflateInit2");
+      }
+      hasInflate = true;
+    }
+    return inflateStream;
+  }
+
+  z_stream& CodecContexts::getDeflate(int level) {
+    if (!hasDeflate) {
+      deflateStream.zalloc = nullptr;
+      deflateStream.zfree = nullptr;
+      deflateStream.opaque = nullptr;
+      if (deflateInit2(&deflateStream, level, Z_DEFLATED, -15, 8,
+                       Z_DEFAULT_STRATEGY) != Z_OK) {
+        throw std::runtime_error(
+          "Error while calling deflateInit2() for zlib.");
+      }
+      hasDeflate = true;
+      deflateLevel = level;
+      return deflateStream;
+    }
+    if (deflateReset(&deflateStream) != Z_OK) {
+      throw std::runtime_error("Failed to reset deflate.");
+    }
+    // nothing was compressed since the reset, so this doesn't flush
+    if (level != deflateLevel) {
+      if (deflateParams(&deflateStream, level, Z_DEFAULT_STRATEGY) != Z_OK) {
+        throw std::runtime_error("Failed to set the deflate level.");
+      }
+      deflateLevel = level;
+    }
+    return deflateStream;
+  }
+
+DIAGNOSTIC_POP
+
+  ZSTD_CCtx* CodecContexts::getZstdCompression() {
+    if (zstdCompression == nullptr) {
+      zstdCompression = ZSTD_createCCtx();
+      if (zstdCompression == nullptr) {
+        throw std::runtime_error("Failed to create a zstd context.");
+      }
+    }
+    return zstdCompression;
+  }
+
+  ZSTD_DCtx* CodecContexts::getZstdDecompression() {
+    if (zstdDecompression == nullptr) {
+      zstdDecompression = ZSTD_createDCtx();
+      if (zstdDecompression == nullptr) {
+        throw std::runtime_error("Failed to create a zstd context.");
+      }
+    }
+    return zstdDecompression;
+  }
+
+  void* CodecContexts::getLz4Compression() {
+    if (!lz4Compression) {
+      size_t words = (static_cast<size_t>(LZ4_sizeofState()) +
+                      sizeof(uint64_t) - 1) / sizeof(uint64_t);
+      lz4Compression.reset(new uint64_t[words]);
+    }
+    return lz4Compression.get();
+  }
+
   class CompressionStreamBase: public BufferedOutputStream {
   public:
     CompressionStreamBase(OutputStream * outStream,
@@ -211,19 +370,10 @@ namespace orc {
                           uint64_t blockSize,
                           MemoryPool& pool);
 
-    virtual ~ZlibCompressionStream() override {
-      end();
-    }
-
     virtual std::string getName() const override;
 
   protected:
     virtual uint64_t doStreamingCompression() override;
-
-  private:
-    void init();
-    void end();
-    z_stream strm;
   };
 
   ZlibCompressionStream::ZlibCompressionStream(
@@ -237,13 +387,11 @@ namespace orc {
                                             capacity,
                                             blockSize,
                                             pool) {
-    init();
+    // PASS
   }
 
   uint64_t ZlibCompressionStream::doStreamingCompression() {
-    if (deflateReset(&strm) != Z_OK) {
-      throw std::runtime_error("Failed to reset inflate.");
-    }
+    z_stream& strm = CodecContexts::get().getDeflate(level);
 
     strm.avail_in = static_cast<unsigned int>(bufferSize);
     strm.next_in = rawInputBuffer.data();
@@ -282,27 +430,6 @@ namespace orc {
     return "ZlibCompressionStream";
   }
 
-DIAGNOSTIC_PUSH
-
-#if defined(__GNUC__) || defined(__clang__)
-  DIAGNOSTIC_IGNORE("-Wold-style-cast")
-#endif
-
-  void ZlibCompressionStream::init() {
-    strm.zalloc = nullptr;
-    strm.zfree = nullptr;
-    strm.opaque = nullptr;
-
-    if (deflateInit2(&strm, level, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY)
-        != Z_OK) {
-      throw std::runtime_error("Error while calling deflateInit2() for zlib.");
-    }
-  }
-
-  void ZlibCompressionStream::end() {
-    (void)deflateEnd(&strm);
-  }
-
 DIAGNOSTIC_PUSH
 
   enum DecompressState { DECOMPRESS_HEADER,
@@ -315,7 +442,8 @@ DIAGNOSTIC_PUSH
   public:
     ZlibDecompressionStream(std::unique_ptr<SeekableInputStream> inStream,
                             size_t blockSize,
-                            MemoryPool& pool);
+                            MemoryPool& pool,
+                            DecompressionMetrics* metrics);
     virtual ~ZlibDecompressionStream() override;
     virtual bool Next(const void** data, int*size) override;
     virtual void BackUp(int count) override;
@@ -370,7 +498,8 @@ DIAGNOSTIC_PUSH
     MemoryPool& pool;
     const size_t blockSize;
     std::unique_ptr<SeekableInputStream> input;
-    z_stream zstream;
+    // where the work is counted, if anywhere
+    DecompressionMetrics* const metrics;
     DataBuffer<char> buffer;
 
     // the current state
@@ -393,40 +522,16 @@ DIAGNOSTIC_PUSH
     off_t bytesReturned;
   };
 
-DIAGNOSTIC_PUSH
-
-#if defined(__GNUC__) || defined(__clang__)
-  DIAGNOSTIC_IGNORE("-Wold-style-cast")
-#endif
-
   ZlibDecompressionStream::ZlibDecompressionStream
                    (std::unique_ptr<SeekableInputStream> inStream,
                     size_t _blockSize,
-                    MemoryPool& _pool
+                    MemoryPool& _pool,
+                    DecompressionMetrics* _metrics
                     ): pool(_pool),
                        blockSize(_blockSize),
                        input(std::move(inStream)),
+                       metrics(_metrics),
                        buffer(pool, _blockSize) {
-    zstream.next_in = nullptr;
-    zstream.avail_in = 0;
-    zstream.zalloc = nullptr;
-    zstream.zfree = nullptr;
-    zstream.opaque = nullptr;
-    zstream.next_out = reinterpret_cast<Bytef*>(buffer.data());
-    zstream.avail_out = static_cast<uInt>(blockSize);
-    int64_t result = inflateInit2(&zstream, -15);
-    switch (result) {
-    case Z_OK:
-      break;
-    case Z_MEM_ERROR:
-      throw std::logic_error("Memory error from inflateInit2");
-    case Z_VERSION_ERROR:
-      throw std::logic_error("Version error from inflateInit2");
-    case Z_STREAM_ERROR:
-      throw std::logic_error("Stream error from inflateInit2");
-    default:
-      throw std::logic_error("Unknown error from inflateInit2");
-    }
     outputBuffer = nullptr;
     outputBufferLength = 0;
     remainingLength = 0;
@@ -436,14 +541,8 @@ DIAGNOSTIC_PUSH
     bytesReturned = 0;
   }
 
-DIAGNOSTIC_POP
-
   ZlibDecompressionStream::~ZlibDecompressionStream() {
-    int64_t result = inflateEnd(&zstream);
-    if (result != Z_OK) {
-      // really can't throw in destructors
-      std::cout << "Error in ~ZlibDecompressionStream() " << result << "\n";
-    }
+    // PASS
   }
 
   bool ZlibDecompressionStream::Next(const void** data, int*size) {
@@ -472,7 +571,14 @@ DIAGNOSTIC_POP
       *size = static_cast<int>(availSize);
       outputBuffer = inputBuffer + availSize;
       outputBufferLength = 0;
+      if (metrics) {
+        metrics->compressedBytes += availSize;
+        metrics->decompressedBytes += availSize;
+      }
     } else if (state == DECOMPRESS_START) {
+      uint64_t start = metrics ? getMetricsTime() : 0;
+      size_t compressedLength = remainingLength;
+      z_stream& zstream = CodecContexts::get().getInflate();
       zstream.next_in =
         reinterpret_cast<Bytef*>(const_cast<char*>(inputBuffer));
       zstream.avail_in = static_cast<uInt>(availSize);
@@ -520,6 +626,12 @@ DIAGNOSTIC_POP
       *data = outputBuffer;
       outputBufferLength = 0;
       outputBuffer += *size;
+      if (metrics) {
+        metrics->blocks += 1;
+        metrics->compressedBytes += compressedLength;
+        metrics->decompressedBytes += static_cast<uint64_t>(*size);
+        metrics->nanoseconds += getMetricsTime() - start;
+      }
     } else {
       throw std::logic_error("Unknown compression state in "
                              "ZlibDecompressionStream::Next");
@@ -590,7 +702,8 @@ DIAGNOSTIC_POP
   public:
     BlockDecompressionStream(std::unique_ptr<SeekableInputStream> inStream,
                              size_t blockSize,
-                             MemoryPool& pool);
+                             MemoryPool& pool,
+                             DecompressionMetrics* metrics);
 
     virtual ~BlockDecompressionStream() override {}
     virtual bool Next(const void** data, int*size) override;
@@ -653,6 +766,9 @@ DIAGNOSTIC_POP
     std::unique_ptr<SeekableInputStream> input;
     MemoryPool& pool;
 
+    // where the work is counted, if anywhere
+    DecompressionMetrics* const metrics;
+
     // may need to stitch together multiple input buffers;
     // to give snappy a contiguous block
     DataBuffer<char> inputBuffer;
@@ -682,9 +798,11 @@ DIAGNOSTIC_POP
   BlockDecompressionStream::BlockDecompressionStream
                    (std::unique_ptr<SeekableInputStream> inStream,
                     size_t bufferSize,
-                    MemoryPool& _pool
+                    MemoryPool& _pool,
+                    DecompressionMetrics* _metrics
                     ) : input(std::move(inStream)),
                         pool(_pool),
+                        metrics(_metrics),
                         inputBuffer(pool, bufferSize),
                         outputBuffer(pool, bufferSize),
                         state(DECOMPRESS_HEADER),
@@ -726,6 +844,10 @@ DIAGNOSTIC_POP
       outputBufferLength = 0;
       inputBufferPtr += availSize;
       remainingLength -= availSize;
+      if (metrics) {
+        metrics->compressedBytes += availSize;
+        metrics->decompressedBytes += availSize;
+      }
     } else if (state == DECOMPRESS_START) {
       // Get contiguous bytes of compressed block.
       const char *compressed = inputBufferPtr;
@@ -752,9 +874,16 @@ DIAGNOSTIC_POP
         }
       }
 
+      uint64_t start = metrics ? getMetricsTime() : 0;
       outputBufferLength = decompress(compressed, remainingLength,
                                       outputBuffer.data(),
                                       outputBuffer.capacity());
+      if (metrics) {
+        metrics->blocks += 1;
+        metrics->compressedBytes += remainingLength;
+        metrics->decompressedBytes += outputBufferLength;
+        metrics->nanoseconds += getMetricsTime() - start;
+      }
 
       remainingLength = 0;
       state = DECOMPRESS_HEADER;
@@ -820,11 +949,13 @@ DIAGNOSTIC_POP
   public:
     SnappyDecompressionStream(std::unique_ptr<SeekableInputStream> inStream,
                               size_t blockSize,
-                              MemoryPool& pool
+                              MemoryPool& pool,
+                              DecompressionMetrics* metrics
                               ): BlockDecompressionStream
                                  (std::move(inStream),
                                   blockSize,
-                                  pool) {
+                                  pool,
+                                  metrics) {
       // PASS
     }
 
@@ -863,11 +994,13 @@ DIAGNOSTIC_POP
   public:
     LzoDecompressionStream(std::unique_ptr<SeekableInputStream> inStream,
                            size_t blockSize,
-                           MemoryPool& pool
+                           MemoryPool& pool,
+                           DecompressionMetrics* metrics
                            ): BlockDecompressionStream
                               (std::move(inStream),
                                blockSize,
-                               pool) {
+                               pool,
+                               metrics) {
       // PASS
     }
 
@@ -895,11 +1028,13 @@ DIAGNOSTIC_POP
   public:
     Lz4DecompressionStream(std::unique_ptr<SeekableInputStream> inStream,
                            size_t blockSize,
-                           MemoryPool& pool
+                           MemoryPool& pool,
+                           DecompressionMetrics* metrics
                            ): BlockDecompressionStream
                               (std::move(inStream),
                                blockSize,
-                               pool) {
+                               pool,
+                               metrics) {
       // PASS
     }
 
@@ -1046,11 +1181,97 @@ DIAGNOSTIC_POP
   };
 
   uint64_t ZSTDCompressionStream::doBlockCompression() {
-    return ZSTD_compress(compressorBuffer.data(),
-                         compressorBuffer.size(),
-                         rawInputBuffer.data(),
-                         static_cast<size_t>(bufferSize),
-                         level);
+    return ZSTD_compressCCtx(CodecContexts::get().getZstdCompression(),
+                             compressorBuffer.data(),
+                             compressorBuffer.size(),
+                             rawInputBuffer.data(),
+                             static_cast<size_t>(bufferSize),
+                             level);
+  }
+
+  /**
+   * Snappy block compression
+   */
+  class SnappyCompressionStream: public BlockCompressionStream {
+  public:
+    SnappyCompressionStream(OutputStream * outStream,
+                            int compressionLevel,
+                            uint64_t capacity,
+                            uint64_t blockSize,
+                            MemoryPool& pool)
+                            : BlockCompressionStream(outStream,
+                                                     compressionLevel,
+                                                     capacity,
+                                                     blockSize,
+                                                     pool) {
+      // PASS
+    }
+
+    virtual std::string getName() const override {
+      return "SnappyCompressionStream";
+    }
+
+  protected:
+    virtual uint64_t doBlockCompression() override;
+
+    virtual uint64_t estimateMaxCompressionSize() override {
+      return static_cast<uint64_t>(
+        snappy::MaxCompressedLength(static_cast<size_t>(bufferSize)));
+    }
+  };
+
+  uint64_t SnappyCompressionStream::doBlockCompression() {
+    size_t compressedLength;
+    snappy::RawCompress(reinterpret_cast<const char *>(rawInputBuffer.data()),
+                        static_cast<size_t>(bufferSize),
+                        reinterpret_cast<char *>(compressorBuffer.data()),
+                        &compressedLength);
+    return static_cast<uint64_t>(compressedLength);
+  }
+
+  /**
+   * LZ4 block compression
+   */
+  class Lz4CompressionStream: public BlockCompressionStream {
+  public:
+    Lz4CompressionStream(OutputStream * outStream,
+                         int compressionLevel,
+                         uint64_t capacity,
+                         uint64_t blockSize,
+                         MemoryPool& pool)
+                         : BlockCompressionStream(outStream,
+                                                  compressionLevel,
+                                                  capacity,
+                                                  blockSize,
+                                                  pool) {
+      // PASS
+    }
+
+    virtual std::string getName() const override {
+      return "Lz4CompressionStream";
+    }
+
+  protected:
+    virtual uint64_t doBlockCompression() override;
+
+    virtual uint64_t estimateMaxCompressionSize() override {
+      return static_cast<uint64_t>(LZ4_compressBound(bufferSize));
+    }
+  };
+
+  uint64_t Lz4CompressionStream::doBlockCompression() {
+    // the level is LZ4's acceleration factor
+    int result = LZ4_compress_fast_extState(
+                     CodecContexts::get().getLz4Compression(),
+                     reinterpret_cast<const char *>(rawInputBuffer.data()),
+                     reinterpret_cast<char *>(compressorBuffer.data()),
+                     bufferSize,
+                     static_cast<int>(compressorBuffer.size()),
+                     level);
+    if (result == 0) {
+      throw std::runtime_error("Error while calling LZ4_compress_fast_extState().");
+    }
+    return static_cast<uint64_t>(result);
   }
 
   /**
@@ -1060,10 +1281,12 @@ DIAGNOSTIC_POP
   public:
     ZSTDDecompressionStream(std::unique_ptr<SeekableInputStream> inStream,
                             size_t blockSize,
-                            MemoryPool& pool)
+                            MemoryPool& pool,
+                            DecompressionMetrics* metrics)
                             : BlockDecompressionStream(std::move(inStream),
                                                        blockSize,
-                                                       pool) {
+                                                       pool,
+                                                       metrics) {
       // PASS
     }
 
@@ -1084,10 +1307,12 @@ DIAGNOSTIC_POP
                                                uint64_t length,
                                                char *output,
                                                size_t maxOutputLength) {
-    return static_cast<uint64_t>(ZSTD_decompress(output,
-                                                 maxOutputLength,
-                                                 input,
-                                                 length));
+    return static_cast<uint64_t>(
+      ZSTD_decompressDCtx(CodecContexts::get().getZstdDecompression(),
+                          output,
+                          maxOutputLength,
+                          input,
+                          length));
   }
 
   std::unique_ptr<BufferedOutputStream>
@@ -1118,9 +1343,17 @@ DIAGNOSTIC_POP
         (new ZSTDCompressionStream(
           outStream, level, bufferCapacity, compressionBlockSize, pool));
     }
-    case CompressionKind_SNAPPY:
+    case CompressionKind_SNAPPY: {
+      return std::unique_ptr<BufferedOutputStream>
+        (new SnappyCompressionStream(
+          outStream, 0, bufferCapacity, compressionBlockSize, pool));
+    }
+    case CompressionKind_LZ4: {
+      return std::unique_ptr<BufferedOutputStream>
+        (new Lz4CompressionStream(
+          outStream, 1, bufferCapacity, compressionBlockSize, pool));
+    }
     case CompressionKind_LZO:
-    case CompressionKind_LZ4:
     default:
       throw NotImplementedYet("compression codec");
     }
@@ -1130,25 +1363,31 @@ DIAGNOSTIC_POP
      createDecompressor(CompressionKind kind,
                         std::unique_ptr<SeekableInputStream> input,
                         uint64_t blockSize,
-                        MemoryPool& pool) {
+                        MemoryPool& pool,
+                        DecompressionMetrics* metrics) {
     switch (static_cast<int64_t>(kind)) {
     case CompressionKind_NONE:
       return REDUNDANT_MOVE(input);
     case CompressionKind_ZLIB:
       return std::unique_ptr<SeekableInputStream>
-        (new ZlibDecompressionStream(std::move(input), blockSize, pool));
+        (new ZlibDecompressionStream(std::move(input), blockSize, pool,
+                                     metrics));
     case CompressionKind_SNAPPY:
       return std::unique_ptr<SeekableInputStream>
-        (new SnappyDecompressionStream(std::move(input), blockSize, pool));
+        (new SnappyDecompressionStream(std::move(input), blockSize, pool,
+                                       metrics));
     case CompressionKind_LZO:
       return std::unique_ptr<SeekableInputStream>
-        (new LzoDecompressionStream(std::move(input), blockSize, pool));
+        (new LzoDecompressionStream(std::move(input), blockSize, pool,
+                                    metrics));
     case CompressionKind_LZ4:
       return std::unique_ptr<SeekableInputStream>
-        (new Lz4DecompressionStream(std::move(input), blockSize, pool));
+        (new Lz4DecompressionStream(std::move(input), blockSize, pool,
+                                    metrics));
     case CompressionKind_ZSTD:
       return std::unique_ptr<SeekableInputStream>
-        (new ZSTDDecompressionStream(std::move(input), blockSize, pool));
+        (new ZSTDDecompressionStream(std::move(input), blockSize, pool,
+                                     metrics));
     default: {
       std::ostringstream buffer;
       buffer << "Unknown compression codec " << kind;
@@ -0,0 +1,65 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ORC_CPU_INFO_HH
+#define ORC_CPU_INFO_HH
+
+#include "Adaptor.hh"
+
+#include <stdint.h>
+
+#ifdef _MSC_VER
+#include <bitset>
+#include <intrin.h>
+#endif
+
+namespace orc {
+
+  /**
+   * Whether the processor running the library supports AVX2. Code built
+   * for AVX2 (see HAS_AVX2) must only be called when this is true. It is
+   * always false when the compiler can't build such code.
+   */
+  bool cpuSupportsAvx2();
+
+  /**
+   * The index of the lowest set bit of a non-zero mask.
+   */
+  inline int countTrailingZeros(uint32_t mask) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return static_cast<int>(index);
+#else
+    return __builtin_ctz(mask);
+#endif
+  }
+
+  /**
+   * The number of bits that are set in a value.
+   */
+  inline int countSetBits(uint64_t value) {
+#ifdef _MSC_VER
+    return static_cast<int>(std::bitset<64>(value).count());
+#else
+    return __builtin_popcountll(value);
+#endif
+  }
+}
+
+#endif
@@ -0,0 +1,164 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "JsonEscape.hh"
+#include "CpuInfo.hh"
+
+#ifdef HAS_SSE2
+#include <emmintrin.h>
+#endif
+#ifdef HAS_AVX2
+#include <immintrin.h>
+#endif
+
+namespace orc {
+
+  // JSON requires escaping quotes, backslashes and 0x00 to 0x1f. DEL is
+  // escaped as well, as it always has been by the column printers.
+  inline bool needsEscape(unsigned char ch) {
+    return ch < 0x20 || ch == '"' || ch == '\\' || ch == 0x7f;
+  }
+
+  size_t findJsonEscapeScalar(const char* ptr, size_t length) {
+    for (size_t i = 0; i < length; ++i) {
+      if (needsEscape(static_cast<unsigned char>(ptr[i]))) {
+        return i;
+      }
+    }
+    return length;
+  }
+
+#ifdef HAS_SSE2
+  size_t findJsonEscapeSse2(const char* ptr, size_t length) {
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i del = _mm_set1_epi8(0x7f);
+    const __m128i maxControl = _mm_set1_epi8(0x1f);
+    size_t i = 0;
+    for (; i + 16 <= length; i += 16) {
+      __m128i chunk =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr + i));
+      // unsigned chunk <= 0x1f is the same as min(chunk, 0x1f) == chunk
+      __m128i special =
+        _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, quote),
+                                  _mm_cmpeq_epi8(chunk, backslash)),
+                     _mm_or_si128(_mm_cmpeq_epi8(chunk, del),
+                                  _mm_cmpeq_epi8(_mm_min_epu8(chunk,
+                                                              maxControl),
+                                                 chunk)));
+      int mask = _mm_movemask_epi8(special);
+      if (mask != 0) {
+        return i + static_cast<size_t>(
+          countTrailingZeros(static_cast<uint32_t>(mask)));
+      }
+    }
+    return i + findJsonEscapeScalar(ptr + i, length - i);
+  }
+#endif
+
+#ifdef HAS_AVX2
+  __attribute__((target("avx2")))
+  size_t findJsonEscapeAvx2(const char* ptr, size_t length) {
+    const __m256i quote = _mm256_set1_epi8('"');
+    const __m256i backslash = _mm256_set1_epi8('\\');
+    const __m256i del = _mm256_set1_epi8(0x7f);
+    const __m256i maxControl = _mm256_set1_epi8(0x1f);
+    size_t i = 0;
+    for (; i + 32 <= length; i += 32) {
+      __m256i chunk =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ptr + i));
+      __m256i special =
+        _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(chunk, quote),
+                                        _mm256_cmpeq_epi8(chunk, backslash)),
+                        _mm256_or_si256(_mm256_cmpeq_epi8(chunk, del),
+                                        _mm256_cmpeq_epi8(
+                                          _mm256_min_epu8(chunk, maxControl),
+                                          chunk)));
+      int mask = _mm256_movemask_epi8(special);
+      if (mask != 0) {
+        return i + static_cast<size_t>(
+          countTrailingZeros(static_cast<uint32_t>(mask)));
+      }
+    }
+    return i + findJsonEscapeScalar(ptr + i, length - i);
+  }
+#endif
+
+  typedef size_t (*EscapeFinder)(const char* ptr, size_t length);
+
+  static EscapeFinder chooseEscapeFinder() {
+#ifdef HAS_AVX2
+    if (cpuSupportsAvx2()) {
+      return findJsonEscapeAvx2;
+    }
+#endif
+#ifdef HAS_SSE2
+    return findJsonEscapeSse2;
+#else
+    return findJsonEscapeScalar;
+#endif
+  }
+
+  static const char JSON_HEX_CHARS[] = "0123456789abcdef";
+
+  static void writeEscape(std::string& buffer, unsigned char ch) {
+    switch (ch) {
+    case '\\':
+      buffer.append("\\\\", 2);
+      break;
+    case '\b':
+      buffer.append("\\b", 2);
+      break;
+    case '\f':
+      buffer.append("\\f", 2);
+      break;
+    case '\n':
+      buffer.append("\\n", 2);
+      break;
+    case '\r':
+      buffer.append("\\r", 2);
+      break;
+    case '\t':
+      buffer.append("\\t", 2);
+      break;
+    case '"':
+      buffer.append("\\\"", 2);
+      break;
+    default: {
+      char escape[] = {'\\', 'u', '0', '0',
+                       JSON_HEX_CHARS[ch >> 4], JSON_HEX_CHARS[ch & 0xf]};
+      buffer.append(escape, sizeof(escape));
+      break;
+    }
+    }
+  }
+
+  void writeJsonEscaped(std::string& buffer, const char* ptr, size_t length) {
+    static const EscapeFinder findEscape = chooseEscapeFinder();
+    size_t position = 0;
+    while (position < length) {
+      size_t clean = findEscape(ptr + position, length - position);
+      buffer.append(ptr + position, clean);
+      position += clean;
+      if (position < length) {
+        writeEscape(buffer, static_cast<unsigned char>(ptr[position]));
+        position += 1;
+      }
+    }
+  }
+}
@@ -0,0 +1,52 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ORC_JSON_ESCAPE_HH
+#define ORC_JSON_ESCAPE_HH
+
+#include "Adaptor.hh"
+
+#include <stddef.h>
+#include <string>
+
+namespace orc {
+
+  /**
+   * Append the bytes to the buffer as the contents of a JSON string,
+   * without the surrounding quotes. Quotes, backslashes and control
+   * characters are escaped and all other bytes, including any non-ASCII
+   * ones, are copied unchanged.
+   */
+  void writeJsonEscaped(std::string& buffer, const char* ptr, size_t length);
+
+  /**
+   * Find the first byte that writeJsonEscaped has to escape. Returns the
+   * length if there is none. writeJsonEscaped picks the fastest variant
+   * the processor supports; they are all declared here for testing.
+   */
+  size_t findJsonEscapeScalar(const char* ptr, size_t length);
+#ifdef HAS_SSE2
+  size_t findJsonEscapeSse2(const char* ptr, size_t length);
+#endif
+#ifdef HAS_AVX2
+  // requires cpuSupportsAvx2()
+  size_t findJsonEscapeAvx2(const char* ptr, size_t length);
+#endif
+}
+
+#endif
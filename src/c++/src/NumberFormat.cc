@@ -0,0 +1,497 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "NumberFormat.hh"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+namespace orc {
+
+  static const char DIGIT_PAIRS[] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+  static const uint64_t POWERS_OF_TEN[] = {
+    1ULL,
+    10ULL,
+    100ULL,
+    1000ULL,
+    10000ULL,
+    100000ULL,
+    1000000ULL,
+    10000000ULL,
+    100000000ULL,
+    1000000000ULL,
+    10000000000ULL,
+    100000000000ULL,
+    1000000000000ULL,
+    10000000000000ULL,
+    100000000000000ULL,
+    1000000000000000ULL,
+    10000000000000000ULL,
+    100000000000000000ULL,
+    1000000000000000000ULL,
+    10000000000000000000ULL
+  };
+
+  static int countDigits(uint64_t value) {
+    int digits = 1;
+    while (digits < 20 && value >= POWERS_OF_TEN[digits]) {
+      ++digits;
+    }
+    return digits;
+  }
+
+  // Write value, which must be below 100, as exactly two digits.
+  static inline void writeDigitPair(char* out, uint64_t value) {
+    memcpy(out, DIGIT_PAIRS + 2 * value, 2);
+  }
+
+  char* formatUInt64(uint64_t value, char* out) {
+    char* end = out + countDigits(value);
+    char* pos = end;
+    while (value >= 100) {
+      uint64_t quotient = value / 100;
+      pos -= 2;
+      writeDigitPair(pos, value - quotient * 100);
+      value = quotient;
+    }
+    if (value >= 10) {
+      writeDigitPair(pos - 2, value);
+    } else {
+      pos[-1] = static_cast<char>('0' + value);
+    }
+    return end;
+  }
+
+  char* formatInt64(int64_t value, char* out) {
+    if (value < 0) {
+      *out++ = '-';
+      // negate in unsigned arithmetic so that INT64_MIN works
+      return formatUInt64(0 - static_cast<uint64_t>(value), out);
+    }
+    return formatUInt64(static_cast<uint64_t>(value), out);
+  }
+
+  /**
+   * The shortest round-trip digits are found with Grisu3 (Loitsch,
+   * "Printing Floating-Point Numbers Quickly and Accurately with
+   * Integers", PLDI 2010). The value and the two boundaries halfway to
+   * its neighbours are scaled by a cached power of ten into a range where
+   * 64-bit arithmetic is enough, and digits are generated until the
+   * result is inside the boundaries. Grisu3 can tell when the imprecision
+   * of the scaling leaves it unsure whether the digits are the shortest
+   * ones; for those rare values the digits are searched with snprintf
+   * and strtod instead.
+   */
+  struct DiyFp {
+    uint64_t f;
+    int e;
+
+    DiyFp(uint64_t _f, int _e): f(_f), e(_e) {}
+
+    DiyFp operator-(const DiyFp& rhs) const {
+      return DiyFp(f - rhs.f, e);
+    }
+
+    // the upper 64 bits of the 128-bit product, rounded
+    DiyFp operator*(const DiyFp& rhs) const {
+      const uint64_t M32 = 0xFFFFFFFFULL;
+      uint64_t a = f >> 32;
+      uint64_t b = f & M32;
+      uint64_t c = rhs.f >> 32;
+      uint64_t d = rhs.f & M32;
+      uint64_t ac = a * c;
+      uint64_t bc = b * c;
+      uint64_t ad = a * d;
+      uint64_t bd = b * d;
+      uint64_t tmp = (bd >> 32) + (ad & M32) + (bc & M32);
+      tmp += 1ULL << 31;
+      return DiyFp(ac + (ad >> 32) + (bc >> 32) + (tmp >> 32), e + rhs.e + 64);
+    }
+
+    DiyFp normalize() const {
+      DiyFp result = *this;
+      while (!(result.f & (1ULL << 63))) {
+        result.f <<= 1;
+        result.e -= 1;
+      }
+      return result;
+    }
+  };
+
+  // 10^k for k = -348, -340, ..., 340 as normalized 64-bit significands
+  // with binary exponents.
+  static const struct {
+    uint64_t f;
+    int e;
+  } CACHED_POWERS[] = {
+    {0xfa8fd5a0081c0288ULL, -1220},
+    {0xbaaee17fa23ebf76ULL, -1193},
+    {0x8b16fb203055ac76ULL, -1166},
+    {0xcf42894a5dce35eaULL, -1140},
+    {0x9a6bb0aa55653b2dULL, -1113},
+    {0xe61acf033d1a45dfULL, -1087},
+    {0xab70fe17c79ac6caULL, -1060},
+    {0xff77b1fcbebcdc4fULL, -1034},
+    {0xbe5691ef416bd60cULL, -1007},
+    {0x8dd01fad907ffc3cULL, -980},
+    {0xd3515c2831559a83ULL, -954},
+    {0x9d71ac8fada6c9b5ULL, -927},
+    {0xea9c227723ee8bcbULL, -901},
+    {0xaecc49914078536dULL, -874},
+    {0x823c12795db6ce57ULL, -847},
+    {0xc21094364dfb5637ULL, -821},
+    {0x9096ea6f3848984fULL, -794},
+    {0xd77485cb25823ac7ULL, -768},
+    {0xa086cfcd97bf97f4ULL, -741},
+    {0xef340a98172aace5ULL, -715},
+    {0xb23867fb2a35b28eULL, -688},
+    {0x84c8d4dfd2c63f3bULL, -661},
+    {0xc5dd44271ad3cdbaULL, -635},
+    {0x936b9fcebb25c996ULL, -608},
+    {0xdbac6c247d62a584ULL, -582},
+    {0xa3ab66580d5fdaf6ULL, -555},
+    {0xf3e2f893dec3f126ULL, -529},
+    {0xb5b5ada8aaff80b8ULL, -502},
+    {0x87625f056c7c4a8bULL, -475},
+    {0xc9bcff6034c13053ULL, -449},
+    {0x964e858c91ba2655ULL, -422},
+    {0xdff9772470297ebdULL, -396},
+    {0xa6dfbd9fb8e5b88fULL, -369},
+    {0xf8a95fcf88747d94ULL, -343},
+    {0xb94470938fa89bcfULL, -316},
+    {0x8a08f0f8bf0f156bULL, -289},
+    {0xcdb02555653131b6ULL, -263},
+    {0x993fe2c6d07b7facULL, -236},
+    {0xe45c10c42a2b3b06ULL, -210},
+    {0xaa242499697392d3ULL, -183},
+    {0xfd87b5f28300ca0eULL, -157},
+    {0xbce5086492111aebULL, -130},
+    {0x8cbccc096f5088ccULL, -103},
+    {0xd1b71758e219652cULL, -77},
+    {0x9c40000000000000ULL, -50},
+    {0xe8d4a51000000000ULL, -24},
+    {0xad78ebc5ac620000ULL, 3},
+    {0x813f3978f8940984ULL, 30},
+    {0xc097ce7bc90715b3ULL, 56},
+    {0x8f7e32ce7bea5c70ULL, 83},
+    {0xd5d238a4abe98068ULL, 109},
+    {0x9f4f2726179a2245ULL, 136},
+    {0xed63a231d4c4fb27ULL, 162},
+    {0xb0de65388cc8ada8ULL, 189},
+    {0x83c7088e1aab65dbULL, 216},
+    {0xc45d1df942711d9aULL, 242},
+    {0x924d692ca61be758ULL, 269},
+    {0xda01ee641a708deaULL, 295},
+    {0xa26da3999aef774aULL, 322},
+    {0xf209787bb47d6b85ULL, 348},
+    {0xb454e4a179dd1877ULL, 375},
+    {0x865b86925b9bc5c2ULL, 402},
+    {0xc83553c5c8965d3dULL, 428},
+    {0x952ab45cfa97a0b3ULL, 455},
+    {0xde469fbd99a05fe3ULL, 481},
+    {0xa59bc234db398c25ULL, 508},
+    {0xf6c69a72a3989f5cULL, 534},
+    {0xb7dcbf5354e9beceULL, 561},
+    {0x88fcf317f22241e2ULL, 588},
+    {0xcc20ce9bd35c78a5ULL, 614},
+    {0x98165af37b2153dfULL, 641},
+    {0xe2a0b5dc971f303aULL, 667},
+    {0xa8d9d1535ce3b396ULL, 694},
+    {0xfb9b7cd9a4a7443cULL, 720},
+    {0xbb764c4ca7a44410ULL, 747},
+    {0x8bab8eefb6409c1aULL, 774},
+    {0xd01fef10a657842cULL, 800},
+    {0x9b10a4e5e9913129ULL, 827},
+    {0xe7109bfba19c0c9dULL, 853},
+    {0xac2820d9623bf429ULL, 880},
+    {0x80444b5e7aa7cf85ULL, 907},
+    {0xbf21e44003acdd2dULL, 933},
+    {0x8e679c2f5e44ff8fULL, 960},
+    {0xd433179d9c8cb841ULL, 986},
+    {0x9e19db92b4e31ba9ULL, 1013},
+    {0xeb96bf6ebadf77d9ULL, 1039},
+    {0xaf87023b9bf0ee6bULL, 1066}
+  };
+
+  static const int CACHED_POWERS_MIN_EXPONENT = -348;
+  static const int CACHED_POWERS_STEP = 8;
+
+  /**
+   * Find a cached power c = 10^-k such that the product of a normalized
+   * number with binary exponent e and c has a binary exponent in
+   * [-60, -32].
+   */
+  static DiyFp getCachedPower(int e, int& k) {
+    // 0.30102999566398114 = log10(2); the offset keeps dk positive so
+    // that the ceiling can be taken by truncation
+    double dk = (-61 - e) * 0.30102999566398114 -
+      CACHED_POWERS_MIN_EXPONENT - 1;
+    int ik = static_cast<int>(dk);
+    if (dk - ik > 0.0) {
+      ik += 1;
+    }
+    int index = (ik / CACHED_POWERS_STEP) + 1;
+    k = -(CACHED_POWERS_MIN_EXPONENT + index * CACHED_POWERS_STEP);
+    return DiyFp(CACHED_POWERS[index].f, CACHED_POWERS[index].e);
+  }
+
+  /**
+   * Move the last digit down while that brings the number closer to the
+   * scaled value and it stays within the boundaries. Returns false when
+   * the digits are not guaranteed to be the shortest correct ones.
+   */
+  static bool roundWeed(char* buffer, int length, uint64_t distanceToHigh,
+                        uint64_t unsafeInterval, uint64_t rest,
+                        uint64_t tenKappa, uint64_t unit) {
+    uint64_t smallDistance = distanceToHigh - unit;
+    uint64_t bigDistance = distanceToHigh + unit;
+    while (rest < smallDistance &&
+           unsafeInterval - rest >= tenKappa &&
+           (rest + tenKappa < smallDistance ||
+            smallDistance - rest >= rest + tenKappa - smallDistance)) {
+      buffer[length - 1]--;
+      rest += tenKappa;
+    }
+    if (rest < bigDistance &&
+        unsafeInterval - rest >= tenKappa &&
+        (rest + tenKappa < bigDistance ||
+         bigDistance - rest > rest + tenKappa - bigDistance)) {
+      return false;
+    }
+    return 2 * unit <= rest && rest <= unsafeInterval - 4 * unit;
+  }
+
+  static bool generateDigits(const DiyFp& low, const DiyFp& w,
+                             const DiyFp& high, char* buffer, int& length,
+                             int& kappa) {
+    // The scaled values may be off by one unit, so widen the interval
+    // by that much: any digits outside of it are certainly wrong.
+    uint64_t unit = 1;
+    const DiyFp tooLow(low.f - unit, low.e);
+    const DiyFp tooHigh(high.f + unit, high.e);
+    uint64_t unsafeInterval = (tooHigh - tooLow).f;
+    const DiyFp one(1ULL << -w.e, w.e);
+    uint32_t integral = static_cast<uint32_t>(tooHigh.f >> -one.e);
+    uint64_t fraction = tooHigh.f & (one.f - 1);
+    kappa = countDigits(integral);
+    length = 0;
+
+    while (kappa > 0) {
+      uint64_t divisor = POWERS_OF_TEN[kappa - 1];
+      buffer[length++] = static_cast<char>('0' + integral / divisor);
+      integral = static_cast<uint32_t>(integral % divisor);
+      kappa -= 1;
+      uint64_t rest = (static_cast<uint64_t>(integral) << -one.e) + fraction;
+      if (rest < unsafeInterval) {
+        return roundWeed(buffer, length, (tooHigh - w).f, unsafeInterval,
+                         rest, divisor << -one.e, unit);
+      }
+    }
+
+    while (true) {
+      fraction *= 10;
+      unit *= 10;
+      unsafeInterval *= 10;
+      buffer[length++] = static_cast<char>('0' + (fraction >> -one.e));
+      fraction &= one.f - 1;
+      kappa -= 1;
+      if (fraction < unsafeInterval) {
+        return roundWeed(buffer, length, (tooHigh - w).f * unit,
+                         unsafeInterval, fraction, one.f, unit);
+      }
+    }
+  }
+
+  /**
+   * Produce the shortest digits of significand * 2^exponent, where
+   * hiddenBit is the implicit leading bit of a normal number of that
+   * type. On success the value is buffer[0..length) * 10^k.
+   */
+  static bool grisu3(uint64_t significand, int exponent, uint64_t hiddenBit,
+                     char* buffer, int& length, int& k) {
+    DiyFp v(significand, exponent);
+    DiyFp upper = DiyFp((v.f << 1) + 1, v.e - 1).normalize();
+    // the lower neighbour is closer when the significand is a power of 2
+    DiyFp lower = v.f == hiddenBit ? DiyFp((v.f << 2) - 1, v.e - 2) :
+      DiyFp((v.f << 1) - 1, v.e - 1);
+    lower.f <<= lower.e - upper.e;
+    lower.e = upper.e;
+
+    int minusK;
+    DiyFp cached = getCachedPower(upper.e, minusK);
+    int kappa;
+    bool result = generateDigits(lower * cached, v.normalize() * cached,
+                                 upper * cached, buffer, length, kappa);
+    k = minusK + kappa;
+    return result;
+  }
+
+  /**
+   * The slow path for values Grisu3 gives up on: try increasing
+   * precisions until the value reads back unchanged.
+   */
+  static void searchDigits(double value, int maxDigits, bool isFloat,
+                           char* buffer, int& length, int& k) {
+    char text[32];
+    for (int precision = 1; precision <= maxDigits; ++precision) {
+      snprintf(text, sizeof(text), "%.*e", precision - 1, value);
+      bool same = isFloat ?
+        strtof(text, nullptr) == static_cast<float>(value) :
+        strtod(text, nullptr) == value;
+      if (same || precision == maxDigits) {
+        break;
+      }
+    }
+    // text is [-]d[.ddd]e[+-]xx
+    const char* pos = text[0] == '-' ? text + 1 : text;
+    length = 0;
+    for (; *pos != 'e'; ++pos) {
+      if (*pos != '.') {
+        buffer[length++] = *pos;
+      }
+    }
+    while (length > 1 && buffer[length - 1] == '0') {
+      length -= 1;
+    }
+    k = atoi(pos + 1) - length + 1;
+  }
+
+  /**
+   * Lay out digits * 10^k the way printf's %g does for the given
+   * precision, without trailing zeros.
+   */
+  static char* layoutDigits(const char* digits, int length, int k,
+                            int precision, char* out) {
+    // the decimal exponent of the first digit
+    int exponent = length + k - 1;
+    if (exponent < -4 || exponent >= precision) {
+      *out++ = digits[0];
+      if (length > 1) {
+        *out++ = '.';
+        memcpy(out, digits + 1, static_cast<size_t>(length - 1));
+        out += length - 1;
+      }
+      *out++ = 'e';
+      if (exponent < 0) {
+        *out++ = '-';
+        exponent = -exponent;
+      } else {
+        *out++ = '+';
+      }
+      if (exponent >= 100) {
+        *out++ = static_cast<char>('0' + exponent / 100);
+        exponent %= 100;
+      }
+      writeDigitPair(out, static_cast<uint64_t>(exponent));
+      return out + 2;
+    }
+    if (k >= 0) {
+      // an integer: the digits followed by k zeros
+      memcpy(out, digits, static_cast<size_t>(length));
+      out += length;
+      memset(out, '0', static_cast<size_t>(k));
+      return out + k;
+    }
+    if (exponent >= 0) {
+      // the decimal point falls within the digits
+      int integral = exponent + 1;
+      memcpy(out, digits, static_cast<size_t>(integral));
+      out += integral;
+      *out++ = '.';
+      memcpy(out, digits + integral, static_cast<size_t>(length - integral));
+      return out + length - integral;
+    }
+    // a fraction below 1: 0.000ddd
+    *out++ = '0';
+    *out++ = '.';
+    memset(out, '0', static_cast<size_t>(-exponent - 1));
+    out += -exponent - 1;
+    memcpy(out, digits, static_cast<size_t>(length));
+    return out + length;
+  }
+
+  char* formatDouble(double value, char* out) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    if (bits >> 63) {
+      *out++ = '-';
+    }
+    const uint64_t hiddenBit = 1ULL << 52;
+    uint64_t significand = bits & (hiddenBit - 1);
+    int biasedExponent = static_cast<int>((bits >> 52) & 0x7FF);
+    if (biasedExponent == 0 && significand == 0) {
+      *out++ = '0';
+      return out;
+    }
+    int exponent;
+    if (biasedExponent != 0) {
+      significand |= hiddenBit;
+      exponent = biasedExponent - 1075;
+    } else {
+      exponent = -1074;
+    }
+    char digits[20];
+    int length;
+    int k;
+    if (!grisu3(significand, exponent, hiddenBit, digits, length, k)) {
+      searchDigits(value, 17, false, digits, length, k);
+    }
+    return layoutDigits(digits, length, k, 17, out);
+  }
+
+  char* formatFloat(float value, char* out) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    if (bits >> 31) {
+      *out++ = '-';
+    }
+    const uint64_t hiddenBit = 1ULL << 23;
+    uint64_t significand = bits & (hiddenBit - 1);
+    int biasedExponent = static_cast<int>((bits >> 23) & 0xFF);
+    if (biasedExponent == 0 && significand == 0) {
+      *out++ = '0';
+      return out;
+    }
+    int exponent;
+    if (biasedExponent != 0) {
+      significand |= hiddenBit;
+      exponent = biasedExponent - 150;
+    } else {
+      exponent = -149;
+    }
+    char digits[20];
+    int length;
+    int k;
+    if (!grisu3(significand, exponent, hiddenBit, digits, length, k)) {
+      searchDigits(value, 9, true, digits, length, k);
+    }
+    return layoutDigits(digits, length, k, 9, out);
+  }
+}
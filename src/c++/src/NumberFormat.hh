@@ -0,0 +1,66 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ORC_NUMBER_FORMAT_HH
+#define ORC_NUMBER_FORMAT_HH
+
+#include "orc/orc-config.hh"
+
+#include <stdint.h>
+
+namespace orc {
+
+  /**
+   * Formatting of numbers into decimal text without going through
+   * snprintf. Each function writes into out, which must have room for
+   * the longest possible result, and returns the end of the written text.
+   * Nothing is NUL-terminated.
+   */
+
+  // "-9223372036854775808"
+  const int MAX_INT64_CHARS = 20;
+  // "-2.2250738585072014e-308"
+  const int MAX_DOUBLE_CHARS = 24;
+
+  /**
+   * Format an unsigned integer using a table of two-digit pairs.
+   */
+  char* formatUInt64(uint64_t value, char* out);
+
+  /**
+   * Format a signed integer using a table of two-digit pairs.
+   */
+  char* formatInt64(int64_t value, char* out);
+
+  /**
+   * Format a finite double as the shortest decimal string that reads back
+   * as exactly the same double. The layout follows printf's %g with 17
+   * significant digits: plain notation for decimal exponents in [-4, 17)
+   * and d.ddde+XX otherwise.
+   */
+  char* formatDouble(double value, char* out);
+
+  /**
+   * Format a finite float as the shortest decimal string that reads back
+   * as exactly the same float, laid out like printf's %g with 9
+   * significant digits.
+   */
+  char* formatFloat(float value, char* out);
+}
+
+#endif
@@ -22,6 +22,7 @@
 #include "orc/Int128.hh"
 #include "orc/OrcFile.hh"
 #include "orc/Reader.hh"
+#include "orc/sargs/SearchArgument.hh"
 
 #include <limits>
 
@@ -42,11 +43,14 @@ namespace orc {
     std::ostream* errorStream;
     MemoryPool* memoryPool;
     std::string serializedTail;
+    bool useMemoryMapping;
+    std::shared_ptr<ReaderMetrics> readerMetrics;
 
     ReaderOptionsPrivate() {
       tailLocation = std::numeric_limits<uint64_t>::max();
       errorStream = &std::cerr;
       memoryPool = getDefaultPool();
+      useMemoryMapping = false;
     }
   };
 
@@ -115,6 +119,25 @@ namespace orc {
     return privateBits->errorStream;
   }
 
+  ReaderOptions& ReaderOptions::setUseMemoryMapping(bool useMemoryMapping) {
+    privateBits->useMemoryMapping = useMemoryMapping;
+    return *this;
+  }
+
+  bool ReaderOptions::getUseMemoryMapping() const {
+    return privateBits->useMemoryMapping;
+  }
+
+  ReaderOptions& ReaderOptions::setReaderMetrics(
+                                     std::shared_ptr<ReaderMetrics> metrics) {
+    privateBits->readerMetrics = metrics;
+    return *this;
+  }
+
+  std::shared_ptr<ReaderMetrics> ReaderOptions::getReaderMetrics() const {
+    return privateBits->readerMetrics;
+  }
+
 /**
  * RowReaderOptions Implementation
  */
@@ -128,6 +151,13 @@ namespace orc {
     bool throwOnHive11DecimalOverflow;
     int32_t forcedScaleOnHive11Decimal;
     bool enableLazyDecoding;
+    std::shared_ptr<SearchArgument> sargs;
+    bool enableCoalescedReads;
+    uint64_t coalescedReadGap;
+    uint64_t prefetchDepth;
+    uint64_t batchMemoryBudget;
+    std::list<uint64_t> rowFilterFields;
+    std::shared_ptr<RowFilter> rowFilter;
 
     RowReaderOptionsPrivate() {
       selection = ColumnSelection_NONE;
@@ -136,6 +166,10 @@ namespace orc {
       throwOnHive11DecimalOverflow = true;
       forcedScaleOnHive11Decimal = 6;
       enableLazyDecoding = false;
+      enableCoalescedReads = false;
+      coalescedReadGap = 1024 * 1024;
+      prefetchDepth = 0;
+      batchMemoryBudget = 0;
     }
   };
 
@@ -249,6 +283,68 @@ namespace orc {
     privateBits->enableLazyDecoding = enable;
     return *this;
   }
+
+  RowReaderOptions& RowReaderOptions::searchArgument(
+                                    std::unique_ptr<SearchArgument> sargs) {
+    privateBits->sargs = std::move(sargs);
+    return *this;
+  }
+
+  std::shared_ptr<SearchArgument> RowReaderOptions::getSearchArgument() const {
+    return privateBits->sargs;
+  }
+
+  RowReaderOptions& RowReaderOptions::setEnableCoalescedReads(bool enable) {
+    privateBits->enableCoalescedReads = enable;
+    return *this;
+  }
+
+  bool RowReaderOptions::getEnableCoalescedReads() const {
+    return privateBits->enableCoalescedReads;
+  }
+
+  RowReaderOptions& RowReaderOptions::setCoalescedReadGap(uint64_t gap) {
+    privateBits->coalescedReadGap = gap;
+    return *this;
+  }
+
+  uint64_t RowReaderOptions::getCoalescedReadGap() const {
+    return privateBits->coalescedReadGap;
+  }
+
+  RowReaderOptions& RowReaderOptions::setPrefetchDepth(uint64_t depth) {
+    privateBits->prefetchDepth = depth;
+    return *this;
+  }
+
+  uint64_t RowReaderOptions::getPrefetchDepth() const {
+    return privateBits->prefetchDepth;
+  }
+
+  RowReaderOptions& RowReaderOptions::setBatchMemoryBudget(uint64_t bytes) {
+    privateBits->batchMemoryBudget = bytes;
+    return *this;
+  }
+
+  uint64_t RowReaderOptions::getBatchMemoryBudget() const {
+    return privateBits->batchMemoryBudget;
+  }
+
+  RowReaderOptions& RowReaderOptions::setRowFilter(
+                                       const std::list<uint64_t>& fields,
+                                       std::shared_ptr<RowFilter> filter) {
+    privateBits->rowFilterFields = fields;
+    privateBits->rowFilter = filter;
+    return *this;
+  }
+
+  std::shared_ptr<RowFilter> RowReaderOptions::getRowFilter() const {
+    return privateBits->rowFilter;
+  }
+
+  const std::list<uint64_t>& RowReaderOptions::getRowFilterFields() const {
+    return privateBits->rowFilterFields;
+  }
 }
 
 #endif
@@ -20,6 +20,7 @@
 #include "orc/OrcFile.hh"
 #include "orc/Exceptions.hh"
 
+#include <algorithm>
 #include <errno.h>
 #include <fcntl.h>
 #include <stdio.h>
@@ -33,12 +34,21 @@
 #define stat _stat64
 #define fstat _fstat64
 #else
+#include <sys/mman.h>
 #include <unistd.h>
 #define O_BINARY 0
 #endif
 
 namespace orc {
 
+  const char* InputStream::getData(uint64_t, uint64_t) {
+    return nullptr;
+  }
+
+  void InputStream::prefetch(uint64_t, uint64_t) {
+    // PASS
+  }
+
   class FileInputStream : public InputStream {
   private:
     std::string filename;
@@ -94,13 +104,107 @@ namespace orc {
     close(file);
   }
 
+#ifndef _MSC_VER
+  /**
+   * A local file mapped into memory. getData hands out pointers into the
+   * mapping, so the stripe data is never copied.
+   */
+  class MemoryMappedFileInputStream : public InputStream {
+  private:
+    std::string filename;
+    uint64_t totalLength;
+    char* data;
+
+  public:
+    MemoryMappedFileInputStream(std::string _filename) {
+      filename = _filename;
+      data = nullptr;
+      int file = open(filename.c_str(), O_BINARY | O_RDONLY);
+      if (file == -1) {
+        throw ParseError("Can't open " + filename);
+      }
+      struct stat fileStat;
+      if (fstat(file, &fileStat) == -1) {
+        close(file);
+        throw ParseError("Can't stat " + filename);
+      }
+      totalLength = static_cast<uint64_t>(fileStat.st_size);
+      if (totalLength > 0) {
+        void* mapping = mmap(nullptr, totalLength, PROT_READ, MAP_PRIVATE,
+                             file, 0);
+        if (mapping == MAP_FAILED) {
+          close(file);
+          throw ParseError("Can't map " + filename + ": " + strerror(errno));
+        }
+        data = static_cast<char*>(mapping);
+      }
+      // the mapping keeps the file open
+      close(file);
+    }
+
+    ~MemoryMappedFileInputStream() override;
+
+    uint64_t getLength() const override {
+      return totalLength;
+    }
+
+    uint64_t getNaturalReadSize() const override {
+      return 128 * 1024;
+    }
+
+    void read(void* buf,
+              uint64_t length,
+              uint64_t offset) override {
+      if (!buf) {
+        throw ParseError("Buffer is null");
+      }
+      memcpy(buf, getData(offset, length), length);
+    }
+
+    const std::string& getName() const override {
+      return filename;
+    }
+
+    const char* getData(uint64_t offset, uint64_t length) override {
+      if (offset > totalLength || length > totalLength - offset) {
+        throw ParseError("Short read of " + filename);
+      }
+      return data + offset;
+    }
+
+    void prefetch(uint64_t offset, uint64_t length) override {
+      if (data == nullptr || offset >= totalLength) {
+        return;
+      }
+      length = std::min(length, totalLength - offset);
+      // madvise wants a page aligned start
+      uint64_t pageSize = static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+      uint64_t start = offset - offset % pageSize;
+      madvise(data + start, length + (offset - start), MADV_SEQUENTIAL);
+      madvise(data + start, length + (offset - start), MADV_WILLNEED);
+    }
+  };
+
+  MemoryMappedFileInputStream::~MemoryMappedFileInputStream() {
+    if (data != nullptr) {
+      munmap(data, totalLength);
+    }
+  }
+#endif
+
   std::unique_ptr<InputStream> readFile(const std::string& path) {
+    return readFile(path, ReaderOptions());
+  }
+
+  std::unique_ptr<InputStream> readFile(const std::string& path,
+                                        const ReaderOptions& options) {
 #ifdef BUILD_LIBHDFSPP
     if(strncmp (path.c_str(), "hdfs://", 7) == 0){
       return orc::readHdfsFile(std::string(path));
     } else {
 #endif
-      return orc::readLocalFile(std::string(path));
+      return orc::readLocalFile(std::string(path),
+                                options.getUseMemoryMapping());
 #ifdef BUILD_LIBHDFSPP
       }
 #endif
@@ -110,6 +214,17 @@ namespace orc {
       return std::unique_ptr<InputStream>(new FileInputStream(path));
   }
 
+  std::unique_ptr<InputStream> readLocalFile(const std::string& path,
+                                             bool useMemoryMapping) {
+#ifndef _MSC_VER
+    if (useMemoryMapping) {
+      return std::unique_ptr<InputStream>(
+        new MemoryMappedFileInputStream(path));
+    }
+#endif
+    return readLocalFile(path);
+  }
+
   OutputStream::~OutputStream() {
       // PASS
   };
@@ -0,0 +1,171 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Adaptor.hh"
+#include "orc/ColumnPrinter.hh"
+
+#include <algorithm>
+#include <condition_variable>
+#include <errno.h>
+#include <mutex>
+#include <stdexcept>
+#include <string.h>
+#include <thread>
+
+#ifdef _MSC_VER
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace orc {
+
+  OutputSink::~OutputSink() {
+    // PASS
+  }
+
+  /**
+   * Double buffered sink. The caller renders into buffer while the writer
+   * thread writes pending. commit swaps the contents of the two strings,
+   * so both keep their capacity and the caller's buffer never moves.
+   */
+  class FileDescriptorSink: public OutputSink {
+  private:
+    const int fd;
+    const uint64_t bufferSize;
+    std::string buffer;
+    std::string pending;
+    bool hasPending;
+    bool closing;
+    std::string error;
+    std::mutex mutex;
+    std::condition_variable cond;
+    std::thread writer;
+
+    void writeLoop();
+    void writeFully(const char* data, size_t length);
+    void handOff();
+
+  public:
+    FileDescriptorSink(int fd, uint64_t bufferSize);
+    ~FileDescriptorSink() override;
+
+    std::string& getBuffer() override {
+      return buffer;
+    }
+
+    void commit() override {
+      if (buffer.size() >= bufferSize) {
+        handOff();
+      }
+    }
+
+    void flush() override;
+  };
+
+  FileDescriptorSink::FileDescriptorSink(int _fd, uint64_t _bufferSize
+                                         ): fd(_fd),
+                                            bufferSize(_bufferSize),
+                                            hasPending(false),
+                                            closing(false) {
+    buffer.reserve(bufferSize);
+    writer = std::thread(&FileDescriptorSink::writeLoop, this);
+  }
+
+  FileDescriptorSink::~FileDescriptorSink() {
+    try {
+      flush();
+    } catch (std::exception&) {
+      // the error was lost with the sink
+    }
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      closing = true;
+    }
+    cond.notify_all();
+    writer.join();
+  }
+
+  void FileDescriptorSink::writeFully(const char* data, size_t length) {
+    while (length > 0) {
+      auto written = ::write(fd, data, static_cast<unsigned int>(
+        std::min<size_t>(length, 1 << 30)));
+      if (written < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        throw std::runtime_error(std::string("Bad write to output: ") +
+                                 strerror(errno));
+      }
+      data += written;
+      length -= static_cast<size_t>(written);
+    }
+  }
+
+  void FileDescriptorSink::writeLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+      cond.wait(lock, [this]() { return hasPending || closing; });
+      if (!hasPending) {
+        return;
+      }
+      lock.unlock();
+      std::string message;
+      try {
+        writeFully(pending.data(), pending.size());
+      } catch (std::exception& ex) {
+        message = ex.what();
+      }
+      pending.clear();
+      lock.lock();
+      if (error.empty()) {
+        error = message;
+      }
+      hasPending = false;
+      cond.notify_all();
+    }
+  }
+
+  void FileDescriptorSink::handOff() {
+    std::unique_lock<std::mutex> lock(mutex);
+    cond.wait(lock, [this]() { return !hasPending; });
+    if (!error.empty()) {
+      throw std::runtime_error(error);
+    }
+    buffer.swap(pending);
+    hasPending = true;
+    cond.notify_all();
+  }
+
+  void FileDescriptorSink::flush() {
+    if (!buffer.empty()) {
+      handOff();
+    }
+    std::unique_lock<std::mutex> lock(mutex);
+    cond.wait(lock, [this]() { return !hasPending; });
+    if (!error.empty()) {
+      throw std::runtime_error(error);
+    }
+  }
+
+  std::unique_ptr<OutputSink> createFileDescriptorSink(int fd,
+                                                       uint64_t bufferSize) {
+    return std::unique_ptr<OutputSink>(new FileDescriptorSink(fd,
+                                                              bufferSize));
+  }
+}
@@ -20,6 +20,9 @@
 #include "RLEv2.hh"
 #include "orc/Exceptions.hh"
 
+#include <algorithm>
+#include <string.h>
+
 namespace orc {
 
   RleEncoder::~RleEncoder() {
@@ -105,6 +108,24 @@ namespace orc {
     buffer[bufferPosition++] = c;
   }
 
+  void RleEncoder::writeBytes(const char* data, size_t length) {
+    while (length > 0) {
+      if (bufferPosition == bufferLength) {
+        int addedSize = 0;
+        if (!outputStream->Next(reinterpret_cast<void **>(&buffer), &addedSize)) {
+          throw std::bad_alloc();
+        }
+        bufferPosition = 0;
+        bufferLength = static_cast<size_t>(addedSize);
+      }
+      size_t size = std::min(length, bufferLength - bufferPosition);
+      memcpy(buffer + bufferPosition, data, size);
+      bufferPosition += size;
+      data += size;
+      length -= size;
+    }
+  }
+
   void RleEncoder::recordPosition(PositionRecorder* recorder) const {
     uint64_t flushedSize = outputStream->getSize();
     uint64_t unflushedSize = static_cast<uint64_t>(bufferPosition);
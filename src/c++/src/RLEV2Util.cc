@@ -17,6 +17,15 @@
  */
 
 #include "RLEV2Util.hh"
+#include "CpuInfo.hh"
+
+#include <algorithm>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef HAS_AVX2
+#include <immintrin.h>
+#endif
 
 namespace orc {
 
@@ -67,4 +76,384 @@ namespace orc {
       FixedBitSizes::SIXTYFOUR, FixedBitSizes::SIXTYFOUR, FixedBitSizes::SIXTYFOUR, FixedBitSizes::SIXTYFOUR,
       FixedBitSizes::SIXTYFOUR, FixedBitSizes::SIXTYFOUR, FixedBitSizes::SIXTYFOUR, FixedBitSizes::SIXTYFOUR
   };
+
+  static inline uint64_t loadBigEndian64(const unsigned char* input) {
+    uint64_t result;
+    memcpy(&result, input, sizeof(result));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    return result;
+#elif defined(_MSC_VER)
+    return _byteswap_uint64(result);
+#else
+    return __builtin_bswap64(result);
+#endif
+  }
+
+  static inline void storeBigEndian64(unsigned char* output, uint64_t value) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    // already in order
+#elif defined(_MSC_VER)
+    value = _byteswap_uint64(value);
+#else
+    value = __builtin_bswap64(value);
+#endif
+    memcpy(output, &value, sizeof(value));
+  }
+
+  // read bitWidth bits starting at the given bit of input
+  static inline uint64_t readBitsAt(const unsigned char* input,
+                                    uint64_t bitPosition,
+                                    uint32_t bitWidth) {
+    uint64_t result = 0;
+    while (bitWidth > 0) {
+      uint32_t bitsInByte = 8 - static_cast<uint32_t>(bitPosition % 8);
+      uint32_t bits = std::min(bitsInByte, bitWidth);
+      uint32_t byte = input[bitPosition / 8];
+      result = (result << bits) |
+        ((byte >> (bitsInByte - bits)) & ((1u << bits) - 1));
+      bitWidth -= bits;
+      bitPosition += bits;
+    }
+    return result;
+  }
+
+  static void unpackBitsGeneric(const unsigned char* input, uint32_t bitWidth,
+                                int64_t* output, uint64_t count) {
+    for (uint64_t i = 0; i < count; ++i) {
+      output[i] = static_cast<int64_t>(readBitsAt(input, i * bitWidth,
+                                                  bitWidth));
+    }
+  }
+
+  /**
+   * Unpack values of a fixed width. Each value is taken from an 8 byte
+   * big endian window, which holds the whole value for widths up to 56.
+   * The values whose window would run past the input are read a byte at
+   * a time.
+   */
+  template <uint32_t BITS>
+  static void unpackBitsFixed(const unsigned char* input, int64_t* output,
+                              uint64_t count) {
+    static_assert(BITS >= 1 && BITS <= 64, "bad bit width");
+    const uint64_t totalBytes = (count * BITS + 7) / 8;
+    uint64_t i = 0;
+    if (BITS == 64) {
+      for (; i < count; ++i) {
+        output[i] = static_cast<int64_t>(loadBigEndian64(input + i * 8));
+      }
+      return;
+    }
+    const uint64_t mask = (static_cast<uint64_t>(1) << (BITS % 64)) - 1;
+    if (BITS <= 56) {
+      uint64_t bitPosition = 0;
+      for (; i < count && bitPosition / 8 + 8 <= totalBytes;
+           ++i, bitPosition += BITS) {
+        uint64_t window = loadBigEndian64(input + bitPosition / 8);
+        output[i] = static_cast<int64_t>(
+          (window >> (64 - BITS - bitPosition % 8)) & mask);
+      }
+    }
+    for (; i < count; ++i) {
+      output[i] = static_cast<int64_t>(readBitsAt(input, i * BITS, BITS));
+    }
+  }
+
+#ifdef HAS_AVX2
+  // Byte aligned widths widen four values at a time, swapping them from
+  // big endian on the way.
+
+  __attribute__((target("avx2")))
+  static void unpack8Avx2(const unsigned char* input, int64_t* output,
+                          uint64_t count) {
+    uint64_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+      int32_t word;
+      memcpy(&word, input + i, sizeof(word));
+      __m256i values = _mm256_cvtepu8_epi64(_mm_cvtsi32_si128(word));
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(output + i), values);
+    }
+    for (; i < count; ++i) {
+      output[i] = input[i];
+    }
+  }
+
+  __attribute__((target("avx2")))
+  static void unpack16Avx2(const unsigned char* input, int64_t* output,
+                           uint64_t count) {
+    const __m128i swap = _mm_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6,
+                                       9, 8, 11, 10, 13, 12, 15, 14);
+    uint64_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+      __m128i bytes = _mm_loadl_epi64(
+        reinterpret_cast<const __m128i*>(input + i * 2));
+      __m256i values = _mm256_cvtepu16_epi64(_mm_shuffle_epi8(bytes, swap));
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(output + i), values);
+    }
+    for (; i < count; ++i) {
+      output[i] = (input[i * 2] << 8) | input[i * 2 + 1];
+    }
+  }
+
+  __attribute__((target("avx2")))
+  static void unpack32Avx2(const unsigned char* input, int64_t* output,
+                           uint64_t count) {
+    const __m128i swap = _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4,
+                                       11, 10, 9, 8, 15, 14, 13, 12);
+    uint64_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+      __m128i bytes = _mm_loadu_si128(
+        reinterpret_cast<const __m128i*>(input + i * 4));
+      __m256i values = _mm256_cvtepu32_epi64(_mm_shuffle_epi8(bytes, swap));
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(output + i), values);
+    }
+    unpackBitsFixed<32>(input + i * 4, output + i, count - i);
+  }
+
+  __attribute__((target("avx2")))
+  static void unpack64Avx2(const unsigned char* input, int64_t* output,
+                           uint64_t count) {
+    const __m256i swap = _mm256_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0,
+                                          15, 14, 13, 12, 11, 10, 9, 8,
+                                          7, 6, 5, 4, 3, 2, 1, 0,
+                                          15, 14, 13, 12, 11, 10, 9, 8);
+    uint64_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+      __m256i bytes = _mm256_loadu_si256(
+        reinterpret_cast<const __m256i*>(input + i * 8));
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(output + i),
+                          _mm256_shuffle_epi8(bytes, swap));
+    }
+    unpackBitsFixed<64>(input + i * 8, output + i, count - i);
+  }
+#endif
+
+  void unpackBits(const unsigned char* input, uint32_t bitWidth,
+                  int64_t* output, uint64_t count) {
+#ifdef HAS_AVX2
+    if (cpuSupportsAvx2()) {
+      switch (bitWidth) {
+      case 8: unpack8Avx2(input, output, count); return;
+      case 16: unpack16Avx2(input, output, count); return;
+      case 32: unpack32Avx2(input, output, count); return;
+      case 64: unpack64Avx2(input, output, count); return;
+      default: break;
+      }
+    }
+#endif
+    // the widths that RLEv2 writes, see FBSToBitWidthMap
+    switch (bitWidth) {
+    case 1: unpackBitsFixed<1>(input, output, count); break;
+    case 2: unpackBitsFixed<2>(input, output, count); break;
+    case 3: unpackBitsFixed<3>(input, output, count); break;
+    case 4: unpackBitsFixed<4>(input, output, count); break;
+    case 5: unpackBitsFixed<5>(input, output, count); break;
+    case 6: unpackBitsFixed<6>(input, output, count); break;
+    case 7: unpackBitsFixed<7>(input, output, count); break;
+    case 8: unpackBitsFixed<8>(input, output, count); break;
+    case 9: unpackBitsFixed<9>(input, output, count); break;
+    case 10: unpackBitsFixed<10>(input, output, count); break;
+    case 11: unpackBitsFixed<11>(input, output, count); break;
+    case 12: unpackBitsFixed<12>(input, output, count); break;
+    case 13: unpackBitsFixed<13>(input, output, count); break;
+    case 14: unpackBitsFixed<14>(input, output, count); break;
+    case 15: unpackBitsFixed<15>(input, output, count); break;
+    case 16: unpackBitsFixed<16>(input, output, count); break;
+    case 17: unpackBitsFixed<17>(input, output, count); break;
+    case 18: unpackBitsFixed<18>(input, output, count); break;
+    case 19: unpackBitsFixed<19>(input, output, count); break;
+    case 20: unpackBitsFixed<20>(input, output, count); break;
+    case 21: unpackBitsFixed<21>(input, output, count); break;
+    case 22: unpackBitsFixed<22>(input, output, count); break;
+    case 23: unpackBitsFixed<23>(input, output, count); break;
+    case 24: unpackBitsFixed<24>(input, output, count); break;
+    case 26: unpackBitsFixed<26>(input, output, count); break;
+    case 28: unpackBitsFixed<28>(input, output, count); break;
+    case 30: unpackBitsFixed<30>(input, output, count); break;
+    case 32: unpackBitsFixed<32>(input, output, count); break;
+    case 40: unpackBitsFixed<40>(input, output, count); break;
+    case 48: unpackBitsFixed<48>(input, output, count); break;
+    case 56: unpackBitsFixed<56>(input, output, count); break;
+    case 64: unpackBitsFixed<64>(input, output, count); break;
+    default: unpackBitsGeneric(input, bitWidth, output, count); break;
+    }
+  }
+
+  /**
+   * Pack values of a width from 1 to 64 bits. The values fill a 64 bit
+   * word from the top, which is stored big endian once it is full, so
+   * only the last partial word is written a byte at a time.
+   */
+  static inline uint64_t packBitsWidth(const int64_t* input, uint32_t bitWidth,
+                                       uint64_t count, unsigned char* output) {
+    const uint64_t mask = ~static_cast<uint64_t>(0) >> (64 - bitWidth);
+    unsigned char* position = output;
+    uint64_t word = 0;
+    uint32_t freeBits = 64;
+    for (uint64_t i = 0; i < count; ++i) {
+      uint64_t value = static_cast<uint64_t>(input[i]) & mask;
+      if (bitWidth <= freeBits) {
+        freeBits -= bitWidth;
+        word |= value << freeBits;
+        if (freeBits == 0) {
+          storeBigEndian64(position, word);
+          position += 8;
+          word = 0;
+          freeBits = 64;
+        }
+      } else {
+        // the value straddles two words
+        uint32_t spill = bitWidth - freeBits;
+        storeBigEndian64(position, word | (value >> spill));
+        position += 8;
+        freeBits = 64 - spill;
+        word = value << freeBits;
+      }
+    }
+    for (uint32_t bits = 64 - freeBits; bits > 0; bits -= std::min(bits, 8u)) {
+      *position++ = static_cast<unsigned char>(word >> 56);
+      word <<= 8;
+    }
+    return static_cast<uint64_t>(position - output);
+  }
+
+  template <uint32_t BITS>
+  static uint64_t packBitsFixed(const int64_t* input, uint64_t count,
+                                unsigned char* output) {
+    static_assert(BITS >= 1 && BITS <= 64, "bad bit width");
+    return packBitsWidth(input, BITS, count, output);
+  }
+
+#ifdef HAS_AVX2
+  // Byte aligned widths narrow four values at a time, swapping them to
+  // big endian on the way. Bytes with a shuffle index of -1 are zeroed.
+
+  __attribute__((target("avx2")))
+  static uint64_t pack8Avx2(const int64_t* input, uint64_t count,
+                            unsigned char* output) {
+    // the low byte of values 0 and 1 go to bytes 0 and 1 of the low lane,
+    // those of values 2 and 3 to bytes 2 and 3 of the high lane
+    const __m256i narrow = _mm256_setr_epi8(0, 8, -1, -1, -1, -1, -1, -1,
+                                            -1, -1, -1, -1, -1, -1, -1, -1,
+                                            -1, -1, 0, 8, -1, -1, -1, -1,
+                                            -1, -1, -1, -1, -1, -1, -1, -1);
+    uint64_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+      __m256i values = _mm256_shuffle_epi8(
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(input + i)),
+        narrow);
+      int32_t word = _mm_cvtsi128_si32(
+        _mm_or_si128(_mm256_castsi256_si128(values),
+                     _mm256_extracti128_si256(values, 1)));
+      memcpy(output + i, &word, sizeof(word));
+    }
+    return i + packBitsFixed<8>(input + i, count - i, output + i);
+  }
+
+  __attribute__((target("avx2")))
+  static uint64_t pack16Avx2(const int64_t* input, uint64_t count,
+                             unsigned char* output) {
+    const __m256i narrow = _mm256_setr_epi8(1, 0, 9, 8, -1, -1, -1, -1,
+                                            -1, -1, -1, -1, -1, -1, -1, -1,
+                                            1, 0, 9, 8, -1, -1, -1, -1,
+                                            -1, -1, -1, -1, -1, -1, -1, -1);
+    const __m256i gather = _mm256_setr_epi32(0, 4, 0, 0, 0, 0, 0, 0);
+    uint64_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+      __m256i values = _mm256_shuffle_epi8(
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(input + i)),
+        narrow);
+      values = _mm256_permutevar8x32_epi32(values, gather);
+      _mm_storel_epi64(reinterpret_cast<__m128i*>(output + i * 2),
+                       _mm256_castsi256_si128(values));
+    }
+    return i * 2 + packBitsFixed<16>(input + i, count - i, output + i * 2);
+  }
+
+  __attribute__((target("avx2")))
+  static uint64_t pack32Avx2(const int64_t* input, uint64_t count,
+                             unsigned char* output) {
+    const __m256i narrow = _mm256_setr_epi8(3, 2, 1, 0, 11, 10, 9, 8,
+                                            -1, -1, -1, -1, -1, -1, -1, -1,
+                                            3, 2, 1, 0, 11, 10, 9, 8,
+                                            -1, -1, -1, -1, -1, -1, -1, -1);
+    uint64_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+      __m256i values = _mm256_shuffle_epi8(
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(input + i)),
+        narrow);
+      values = _mm256_permute4x64_epi64(values, 0x08);
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(output + i * 4),
+                       _mm256_castsi256_si128(values));
+    }
+    return i * 4 + packBitsFixed<32>(input + i, count - i, output + i * 4);
+  }
+
+  __attribute__((target("avx2")))
+  static uint64_t pack64Avx2(const int64_t* input, uint64_t count,
+                             unsigned char* output) {
+    const __m256i swap = _mm256_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0,
+                                          15, 14, 13, 12, 11, 10, 9, 8,
+                                          7, 6, 5, 4, 3, 2, 1, 0,
+                                          15, 14, 13, 12, 11, 10, 9, 8);
+    uint64_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+      __m256i values =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(input + i));
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(output + i * 8),
+                          _mm256_shuffle_epi8(values, swap));
+    }
+    return i * 8 + packBitsFixed<64>(input + i, count - i, output + i * 8);
+  }
+#endif
+
+  uint64_t packBits(const int64_t* input, uint32_t bitWidth, uint64_t count,
+                    unsigned char* output) {
+#ifdef HAS_AVX2
+    if (cpuSupportsAvx2()) {
+      switch (bitWidth) {
+      case 8: return pack8Avx2(input, count, output);
+      case 16: return pack16Avx2(input, count, output);
+      case 32: return pack32Avx2(input, count, output);
+      case 64: return pack64Avx2(input, count, output);
+      default: break;
+      }
+    }
+#endif
+    // the widths that RLEv2 writes, see FBSToBitWidthMap
+    switch (bitWidth) {
+    case 1: return packBitsFixed<1>(input, count, output);
+    case 2: return packBitsFixed<2>(input, count, output);
+    case 3: return packBitsFixed<3>(input, count, output);
+    case 4: return packBitsFixed<4>(input, count, output);
+    case 5: return packBitsFixed<5>(input, count, output);
+    case 6: return packBitsFixed<6>(input, count, output);
+    case 7: return packBitsFixed<7>(input, count, output);
+    case 8: return packBitsFixed<8>(input, count, output);
+    case 9: return packBitsFixed<9>(input, count, output);
+    case 10: return packBitsFixed<10>(input, count, output);
+    case 11: return packBitsFixed<11>(input, count, output);
+    case 12: return packBitsFixed<12>(input, count, output);
+    case 13: return packBitsFixed<13>(input, count, output);
+    case 14: return packBitsFixed<14>(input, count, output);
+    case 15: return packBitsFixed<15>(input, count, output);
+    case 16: return packBitsFixed<16>(input, count, output);
+    case 17: return packBitsFixed<17>(input, count, output);
+    case 18: return packBitsFixed<18>(input, count, output);
+    case 19: return packBitsFixed<19>(input, count, output);
+    case 20: return packBitsFixed<20>(input, count, output);
+    case 21: return packBitsFixed<21>(input, count, output);
+    case 22: return packBitsFixed<22>(input, count, output);
+    case 23: return packBitsFixed<23>(input, count, output);
+    case 24: return packBitsFixed<24>(input, count, output);
+    case 26: return packBitsFixed<26>(input, count, output);
+    case 28: return packBitsFixed<28>(input, count, output);
+    case 30: return packBitsFixed<30>(input, count, output);
+    case 32: return packBitsFixed<32>(input, count, output);
+    case 40: return packBitsFixed<40>(input, count, output);
+    case 48: return packBitsFixed<48>(input, count, output);
+    case 56: return packBitsFixed<56>(input, count, output);
+    case 64: return packBitsFixed<64>(input, count, output);
+    default: return packBitsWidth(input, bitWidth, count, output);
+    }
+  }
 }
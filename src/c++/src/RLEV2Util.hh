@@ -21,6 +21,10 @@
 
 #include "RLEv2.hh"
 
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
 namespace orc {
   extern const uint8_t FBSToBitWidthMap[FixedBitSizes::SIZE];
   extern const uint8_t ClosestFixedBitsMap[65];
@@ -56,19 +60,46 @@ namespace orc {
     }
   }
 
-  inline uint32_t findClosestNumBits(int64_t value) {
-    if (value < 0) {
-      return getClosestFixedBits(64);
-    }
+  // The number of bits up to and including the highest set bit, 0 for 0.
+  inline uint32_t getBitLength(uint64_t value) {
+#ifdef _MSC_VER
+    unsigned long index;
+    return _BitScanReverse64(&index, value) ? index + 1 : 0;
+#else
+    return value == 0 ? 0 : 64 - static_cast<uint32_t>(__builtin_clzll(value));
+#endif
+  }
 
-    uint32_t count = 0;
-    while (value != 0) {
-      count++;
-      value = value >> 1;
-    }
-    return getClosestFixedBits(count);
+  inline uint32_t findClosestNumBits(int64_t value) {
+    // negative values need all 64 bits
+    return getClosestFixedBits(getBitLength(static_cast<uint64_t>(value)));
   }
 
+  /**
+   * Unpack values stored big endian with the given number of bits each,
+   * as DIRECT, PATCHED_BASE and DELTA runs store them.
+   * @param input the packed values, which must hold at least
+   *   (count * bitWidth + 7) / 8 bytes
+   * @param bitWidth the number of bits per value, from 1 to 64
+   * @param output where to write the values
+   * @param count the number of values
+   */
+  void unpackBits(const unsigned char* input, uint32_t bitWidth,
+                  int64_t* output, uint64_t count);
+
+  /**
+   * Pack the low bitWidth bits of each value big endian, the inverse of
+   * unpackBits.
+   * @param input the values to pack
+   * @param bitWidth the number of bits per value, from 1 to 64
+   * @param count the number of values
+   * @param output where to write the packed values, which must have room
+   *   for (count * bitWidth + 7) / 8 bytes
+   * @return the number of bytes written
+   */
+  uint64_t packBits(const int64_t* input, uint32_t bitWidth, uint64_t count,
+                    unsigned char* output);
+
   inline bool isSafeSubtract(int64_t left, int64_t right) {
     return ((left ^ right) >= 0) || ((left ^ (left - right)) >= 0);
   }
@@ -26,7 +26,6 @@
 #include <vector>
 
 #define MIN_REPEAT 3
-#define HIST_LEN 32
 namespace orc {
 
 struct FixedBitSizes {
@@ -44,9 +43,6 @@ struct EncodingOption {
   EncodingType encoding;
   int64_t fixedDelta;
   int64_t gapVsPatchListCount;
-  int64_t zigzagLiteralsCount;
-  int64_t baseRedLiteralsCount;
-  int64_t adjDeltasCount;
   uint32_t zzBits90p;
   uint32_t zzBits100p;
   uint32_t brBits95p;
@@ -69,6 +65,7 @@ public:
       delete [] zigzagLiterals;
       delete [] baseRedLiterals;
       delete [] adjDeltas;
+      delete [] packed;
     }
     /**
      * Flushing underlying BufferedOutputStream
@@ -83,7 +80,6 @@ private:
     uint32_t fixedRunLength;
     uint32_t variableRunLength;
     int64_t prevDelta;
-    int32_t histgram[HIST_LEN];
 
     // The four list below should actually belong to EncodingOption since it only holds temporal values in write(int64_t val),
     // it is move here for performance consideration.
@@ -91,10 +87,11 @@ private:
     int64_t*  zigzagLiterals;
     int64_t*  baseRedLiterals;
     int64_t*  adjDeltas;
+    // bit packed values on their way to the output stream
+    unsigned char* packed;
 
     uint32_t getOpCode(EncodingType encoding);
     void determineEncoding(EncodingOption& option);
-    void computeZigZagLiterals(EncodingOption& option);
     void preparePatchedBlob(EncodingOption& option);
 
     void writeInts(int64_t* input, uint32_t offset, size_t len, uint32_t bitSize);
@@ -104,7 +101,6 @@ private:
     void writeDirectValues(EncodingOption& option);
     void writePatchedBasedValues(EncodingOption& option);
     void writeDeltaValues(EncodingOption& option);
-    uint32_t percentileBits(int64_t* data, size_t offset, size_t length, double p, bool reuseHist = false);
 };
 
 class RleDecoderV2 : public RleDecoder {
@@ -179,37 +175,9 @@ private:
   int64_t readVslong();
   uint64_t readVulong();
   uint64_t readLongs(int64_t *data, uint64_t offset, uint64_t len,
-                     uint64_t fb, const char* notNull = nullptr) {
-  uint64_t ret = 0;
-
-  // TODO: unroll to improve performance
-  for(uint64_t i = offset; i < (offset + len); i++) {
-    // skip null positions
-    if (notNull && !notNull[i]) {
-      continue;
-    }
-    uint64_t result = 0;
-    uint64_t bitsLeftToRead = fb;
-    while (bitsLeftToRead > bitsLeft) {
-      result <<= bitsLeft;
-      result |= curByte & ((1 << bitsLeft) - 1);
-      bitsLeftToRead -= bitsLeft;
-      curByte = readByte();
-      bitsLeft = 8;
-    }
-
-    // handle the left over bits
-    if (bitsLeftToRead > 0) {
-      result <<= bitsLeftToRead;
-      bitsLeft -= static_cast<uint32_t>(bitsLeftToRead);
-      result |= (curByte >> bitsLeft) & ((1 << bitsLeftToRead) - 1);
-    }
-    data[i] = static_cast<int64_t>(result);
-    ++ret;
-  }
-
-  return ret;
-}
+                     uint64_t fb, const char* notNull = nullptr);
+  void unpackLongs(int64_t *data, uint64_t count, uint64_t fb);
+  uint64_t readLong(uint64_t fb);
 
   uint64_t nextShortRepeats(int64_t* data, uint64_t offset, uint64_t numValues,
                             const char* notNull);
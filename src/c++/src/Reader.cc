@@ -181,6 +181,16 @@ namespace orc {
     buildTypeNameIdMap(contents->schema.get());
   }
 
+  /**
+   * The number of row groups in a stripe.
+   */
+  static uint64_t getRowGroupCount(uint64_t rows, uint64_t rowIndexStride) {
+    if (rowIndexStride == 0) {
+      return 0;
+    }
+    return (rows + rowIndexStride - 1) / rowIndexStride;
+  }
+
   RowReaderImpl::RowReaderImpl(std::shared_ptr<FileContents> _contents,
                                const RowReaderOptions& opts
                          ): localTimezone(getLocalTimezone()),
@@ -189,7 +199,13 @@ namespace orc {
                             forcedScaleOnHive11Decimal(opts.getForcedScaleOnHive11Decimal()),
                             footer(contents->footer.get()),
                             firstRowOfStripe(*contents->pool, 0),
-                            enableEncodedBlock(opts.getEnableLazyDecoding()) {
+                            enableEncodedBlock(opts.getEnableLazyDecoding()),
+                            batchMemoryBudget(opts.getBatchMemoryBudget()),
+                            statisticsBytesPerRow(1),
+                            observedBytesPerRow(0),
+                            enableCoalescedReads(opts.getEnableCoalescedReads()),
+                            coalescedReadGap(opts.getCoalescedReadGap()),
+                            prefetchDepth(opts.getPrefetchDepth()) {
     uint64_t numberOfStripes;
     numberOfStripes = static_cast<uint64_t>(footer->stripes_size());
     currentStripe = numberOfStripes;
@@ -217,6 +233,12 @@ namespace orc {
     }
     firstStripe = currentStripe;
 
+    if (contents->readerMetrics) {
+      metrics.reset(new ReaderMetricsCounters());
+      metrics->columns.resize(contents->schema->getMaximumColumnId() + 1,
+                              DecodeMetrics());
+    }
+
     if (currentStripe == 0) {
       previousRow = (std::numeric_limits<uint64_t>::max)();
     } else if (currentStripe == numberOfStripes) {
@@ -227,6 +249,79 @@ namespace orc {
 
     ColumnSelector column_selector(contents.get());
     column_selector.updateSelected(selectedColumns, opts);
+
+    // The string statistics of files older than HIVE-8732 can't be trusted,
+    // so those files are always read in full.
+    sargs = opts.getSearchArgument();
+    WriterVersion writerVersion = contents->postscript->has_writerversion() ?
+      static_cast<WriterVersion>(contents->postscript->writerversion()) :
+      WriterVersion_ORIGINAL;
+    if (sargs && writerVersion >= WriterVersion_HIVE_8732) {
+      sargsApplier.reset(new SargsApplier(*contents->schema, sargs.get(),
+                                          footer->rowindexstride(),
+                                          writerVersion));
+      if (!sargsApplier->evaluateFileStatistics(*footer)) {
+        if (metrics) {
+          for (uint64_t i = currentStripe; i < lastStripe; ++i) {
+            metrics->stripesSkipped += 1;
+            metrics->rowGroupsSkipped += getRowGroupCount(
+              footer->stripes(static_cast<int>(i)).numberofrows(),
+              footer->rowindexstride());
+          }
+        }
+        currentStripe = lastStripe;
+      }
+    }
+
+    // find the filter fields among the fields of the selected type
+    rowFilter = opts.getRowFilter();
+    if (rowFilter) {
+      const Type& schema = *contents->schema;
+      if (schema.getKind() != STRUCT) {
+        throw std::logic_error("A row filter needs a struct at the root");
+      }
+      for (uint64_t field : opts.getRowFilterFields()) {
+        if (field >= schema.getSubtypeCount() ||
+            !selectedColumns[schema.getSubtype(field)->getColumnId()]) {
+          throw std::logic_error("Row filter field " + std::to_string(field) +
+                                 " is not selected");
+        }
+        uint64_t index = 0;
+        for (uint64_t i = 0; i < field; ++i) {
+          if (selectedColumns[schema.getSubtype(i)->getColumnId()]) {
+            index += 1;
+          }
+        }
+        if (std::find(rowFilterFields.begin(), rowFilterFields.end(),
+                      index) != rowFilterFields.end()) {
+          throw std::logic_error("Row filter field " + std::to_string(field) +
+                                 " is given more than once");
+        }
+        rowFilterFields.push_back(index);
+      }
+    }
+
+    if (batchMemoryBudget != 0) {
+      estimateRowSize();
+    }
+  }
+
+  RowReaderImpl::~RowReaderImpl() {
+    if (metrics) {
+      flushMetrics();
+    }
+  }
+
+  void RowReaderImpl::flushMetrics() {
+    addReaderMetrics(*contents->readerMetrics, *metrics);
+  }
+
+  const ReaderMetrics* RowReaderImpl::getReaderMetrics() {
+    if (!metrics) {
+      return nullptr;
+    }
+    flushMetrics();
+    return contents->readerMetrics.get();
   }
 
   CompressionKind RowReaderImpl::getCompression() const {
@@ -291,8 +386,17 @@ namespace orc {
     currentStripe = seekToStripe;
     currentRowInStripe = rowNumber - firstRowOfStripe[currentStripe];
     previousRow = rowNumber;
+    prefetchedStripes.clear();
     startNextStripe();
 
+    // predicate push down may have moved on to a later row
+    if (currentStripe >= lastStripe) {
+      currentStripe = num_stripes;
+      previousRow = footer->numberofrows();
+      return;
+    }
+    previousRow = firstRowOfStripe[currentStripe] + currentRowInStripe;
+
     uint64_t rowsToSkip = currentRowInStripe;
 
     if (footer->rowindexstride() > 0 &&
@@ -309,17 +413,31 @@ namespace orc {
     reader->skip(rowsToSkip);
   }
 
-  void RowReaderImpl::seekToRowGroup(uint32_t rowGroupEntryId) {
-    // reset all previous row indexes
+  void RowReaderImpl::loadStripeIndex() {
     rowIndexes.clear();
+    bloomFilterIndex.clear();
+
+    std::vector<bool> filterColumns(selectedColumns.size(), false);
+    if (sargsApplier) {
+      for (uint64_t colId : sargsApplier->getFilterColumns()) {
+        if (colId < filterColumns.size()) {
+          filterColumns[colId] = true;
+        }
+      }
+    }
 
-    // obtain row indexes for selected columns
     uint64_t offset = currentStripeInfo.offset();
     for (int i = 0; i < currentStripeFooter.streams_size(); ++i) {
       const proto::Stream& pbStream = currentStripeFooter.streams(i);
       uint64_t colId = pbStream.column();
-      if (selectedColumns[colId] && pbStream.has_kind()
-          && pbStream.kind() == proto::Stream_Kind_ROW_INDEX) {
+      bool isWanted = colId < selectedColumns.size() &&
+        (selectedColumns[colId] || filterColumns[colId]);
+      bool isRowIndex = isWanted && pbStream.has_kind() &&
+        pbStream.kind() == proto::Stream_Kind_ROW_INDEX;
+      bool isBloomFilter = isWanted && filterColumns[colId] &&
+        pbStream.has_kind() &&
+        pbStream.kind() == proto::Stream_Kind_BLOOM_FILTER_UTF8;
+      if (isRowIndex || isBloomFilter) {
         std::unique_ptr<SeekableInputStream> inStream =
           createDecompressor(getCompression(),
                              std::unique_ptr<SeekableInputStream>
@@ -327,19 +445,46 @@ namespace orc {
                                   (contents->stream.get(),
                                    offset,
                                    pbStream.length(),
-                                   *contents->pool)),
+                                   *contents->pool,
+                                   0,
+                                   metrics ? metrics->getStreamReads(
+                                     pbStream.kind()) : nullptr)),
                              getCompressionSize(),
-                             *contents->pool);
-
-        proto::RowIndex rowIndex;
-        if (!rowIndex.ParseFromZeroCopyStream(inStream.get())) {
-          throw ParseError("Failed to parse the row index");
+                             *contents->pool,
+                             metrics ? metrics->getDecompression(
+                               getCompression()) : nullptr);
+
+        if (isRowIndex) {
+          proto::RowIndex& rowIndex = rowIndexes[colId];
+          if (!rowIndex.ParseFromZeroCopyStream(inStream.get())) {
+            throw ParseError("Failed to parse the row index");
+          }
+        } else {
+          proto::BloomFilterIndex pbBFIndex;
+          if (!pbBFIndex.ParseFromZeroCopyStream(inStream.get())) {
+            throw ParseError("Failed to parse BloomFilterIndex");
+          }
+          BloomFilterIndex& bfIndex =
+            bloomFilterIndex[static_cast<uint32_t>(colId)];
+          for (int j = 0; j < pbBFIndex.bloomfilter_size(); j++) {
+            std::unique_ptr<BloomFilter> entry =
+              BloomFilterUTF8Utils::deserialize(
+                pbStream.kind(),
+                currentStripeFooter.columns(static_cast<int>(colId)),
+                pbBFIndex.bloomfilter(j));
+            bfIndex.entries.push_back(
+              std::shared_ptr<BloomFilter>(std::move(entry)));
+          }
         }
-
-        rowIndexes[colId] = rowIndex;
       }
       offset += pbStream.length();
     }
+  }
+
+  void RowReaderImpl::seekToRowGroup(uint32_t rowGroupEntryId) {
+    if (rowIndexes.empty()) {
+      loadStripeIndex();
+    }
 
     // store positions for selected columns
     std::vector<std::list<uint64_t>> positions;
@@ -349,6 +494,10 @@ namespace orc {
     for (auto rowIndex = rowIndexes.cbegin();
          rowIndex != rowIndexes.cend(); ++rowIndex) {
       uint64_t colId = rowIndex->first;
+      // the index of a column that is only used by the search argument
+      if (!selectedColumns[colId]) {
+        continue;
+      }
       const proto::RowIndexEntry& entry =
         rowIndex->second.entry(static_cast<int32_t>(rowGroupEntryId));
 
@@ -454,11 +603,9 @@ namespace orc {
   }
 
   uint64_t ReaderImpl::getNumberOfStripeStatistics() const {
-    if (!isMetadataLoaded) {
-      readMetadata();
-    }
-    return metadata.get() == nullptr ? 0 :
-      static_cast<uint64_t>(metadata->stripestats_size());
+    readMetadata();
+    return contents->metadata.get() == nullptr ? 0 :
+      static_cast<uint64_t>(contents->metadata->stripestats_size());
   }
 
   std::unique_ptr<StripeInformation>
@@ -626,14 +773,12 @@ namespace orc {
 
   std::unique_ptr<StripeStatistics>
   ReaderImpl::getStripeStatistics(uint64_t stripeIndex) const {
-    if (!isMetadataLoaded) {
-      readMetadata();
-    }
-    if (metadata.get() == nullptr) {
+    readMetadata();
+    if (contents->metadata.get() == nullptr) {
       throw std::logic_error("No stripe statistics in file");
     }
     size_t num_cols = static_cast<size_t>(
-                          metadata->stripestats(
+                          contents->metadata->stripestats(
                               static_cast<int>(stripeIndex)).colstats_size());
     std::vector<std::vector<proto::ColumnStatistics> > indexStats(num_cols);
 
@@ -650,7 +795,7 @@ namespace orc {
         getLocalTimezone();
     StatContext statContext(hasCorrectStatistics(), &writerTZ);
     return std::unique_ptr<StripeStatistics>
-           (new StripeStatisticsImpl(metadata->stripestats(static_cast<int>(stripeIndex)),
+           (new StripeStatisticsImpl(contents->metadata->stripestats(static_cast<int>(stripeIndex)),
                                                    indexStats, statContext));
   }
 
@@ -673,6 +818,10 @@ namespace orc {
   }
 
   void ReaderImpl::readMetadata() const {
+    std::lock_guard<std::mutex> lock(metadataMutex);
+    if (isMetadataLoaded) {
+      return;
+    }
     uint64_t metadataSize = contents->postscript->metadatalength();
     uint64_t footerLength = contents->postscript->footerlength();
     if (fileLength < metadataSize + footerLength + postscriptLength + 1) {
@@ -693,8 +842,8 @@ namespace orc {
                                                           *contents->pool)),
                            contents->blockSize,
                            *contents->pool);
-      metadata.reset(new proto::Metadata());
-      if (!metadata->ParseFromZeroCopyStream(pbStream.get())) {
+      contents->metadata.reset(new proto::Metadata());
+      if (!contents->metadata->ParseFromZeroCopyStream(pbStream.get())) {
         throw ParseError("Failed to parse the metadata");
       }
     }
@@ -722,6 +871,11 @@ namespace orc {
 
   std::unique_ptr<RowReader> ReaderImpl::createRowReader(
            const RowReaderOptions& opts) const {
+    if (opts.getSearchArgument() || opts.getBatchMemoryBudget() != 0) {
+      // the stripe statistics are needed to skip whole stripes and to
+      // estimate the size of the rows
+      readMetadata();
+    }
     return std::unique_ptr<RowReader>(new RowReaderImpl(contents, opts));
   }
 
@@ -890,65 +1044,513 @@ namespace orc {
     return memory + decompressorMemory ;
   }
 
+  bool RowReaderImpl::pickRowGroups() {
+    if (footer->rowindexstride() == 0) {
+      return true;
+    }
+    loadStripeIndex();
+    sargsApplier->pickRowGroups(rowsInCurrentStripe, rowIndexes,
+                                bloomFilterIndex);
+    if (metrics) {
+      const std::vector<bool>& rowGroups = sargsApplier->getRowGroups();
+      uint64_t picked = static_cast<uint64_t>(
+        std::count(rowGroups.begin(), rowGroups.end(), true));
+      metrics->rowGroupsRead += picked;
+      metrics->rowGroupsSkipped += rowGroups.size() - picked;
+    }
+    return sargsApplier->hasSelectedFrom(currentRowInStripe);
+  }
+
+  uint64_t RowReaderImpl::nextSelectedRow(uint64_t row) const {
+    uint64_t stride = footer->rowindexstride();
+    if (!sargsApplier || stride == 0) {
+      return row;
+    }
+    const std::vector<bool>& rowGroups = sargsApplier->getRowGroups();
+    uint64_t rowGroup = row / stride;
+    if (rowGroup >= rowGroups.size() || rowGroups[rowGroup]) {
+      return row;
+    }
+    while (rowGroup < rowGroups.size() && !rowGroups[rowGroup]) {
+      ++rowGroup;
+    }
+    return std::min(rowGroup * stride, rowsInCurrentStripe);
+  }
+
+  uint64_t RowReaderImpl::endOfSelectedRows(uint64_t row) const {
+    uint64_t stride = footer->rowindexstride();
+    if (!sargsApplier || stride == 0) {
+      return rowsInCurrentStripe;
+    }
+    const std::vector<bool>& rowGroups = sargsApplier->getRowGroups();
+    uint64_t rowGroup = row / stride;
+    while (rowGroup < rowGroups.size() && rowGroups[rowGroup]) {
+      ++rowGroup;
+    }
+    return std::min(rowGroup * stride, rowsInCurrentStripe);
+  }
+
+  /**
+   * Count the reads of the given ranges by the kinds of the streams in
+   * them.
+   */
+  static void countRangeReads(const std::vector<ReadRange>& ranges,
+                              const std::vector<ReadRange>& streamRanges,
+                              const std::vector<uint64_t>& streamKinds,
+                              ReaderMetricsCounters& counters) {
+    for (const ReadRange& range : ranges) {
+      bool isCounted[METRICS_STREAM_KINDS] = {};
+      for (size_t i = 0; i < streamRanges.size(); ++i) {
+        StreamReadMetrics* stream = counters.getStreamReads(streamKinds[i]);
+        if (stream == nullptr || streamRanges[i].offset < range.offset ||
+            streamRanges[i].offset >= range.offset + range.length) {
+          continue;
+        }
+        stream->bytesRead += streamRanges[i].length;
+        if (!isCounted[streamKinds[i]]) {
+          isCounted[streamKinds[i]] = true;
+          stream->readCalls += 1;
+        }
+      }
+    }
+  }
+
+  void RowReaderImpl::readStripeData(const proto::StripeInformation& info,
+                                     const proto::StripeFooter& stripeFooter,
+                                     std::unique_ptr<DataBuffer<char> >& data,
+                                     std::vector<ReadRange>& ranges,
+                                     ReaderMetricsCounters* counters,
+                                     bool isPrefetch) const {
+    data.reset();
+    ranges.clear();
+    if (!enableCoalescedReads && !isPrefetch) {
+      return;
+    }
+
+    uint64_t dataStart = info.offset() + info.indexlength();
+    uint64_t dataEnd = dataStart + info.datalength();
+    std::vector<ReadRange> streamRanges;
+    std::vector<uint64_t> streamKinds;
+    uint64_t offset = info.offset();
+    for (int i = 0; i < stripeFooter.streams_size(); ++i) {
+      const proto::Stream& pbStream = stripeFooter.streams(i);
+      uint64_t colId = pbStream.column();
+      // StripeStreamsImpl::getStream reports malformed streams
+      if (offset >= dataStart && offset + pbStream.length() <= dataEnd &&
+          colId < selectedColumns.size() && selectedColumns[colId]) {
+        streamRanges.push_back({offset, pbStream.length()});
+        streamKinds.push_back(pbStream.kind());
+      }
+      offset += pbStream.length();
+    }
+    ranges = coalesceReadRanges(streamRanges,
+                                enableCoalescedReads ? coalescedReadGap : 0);
+    if (counters != nullptr) {
+      countRangeReads(ranges, streamRanges, streamKinds, *counters);
+    }
+
+    // a memory mapped file hands out its streams directly
+    if (contents->stream->getData(dataStart, dataEnd - dataStart) != nullptr) {
+      for (const ReadRange& range : ranges) {
+        contents->stream->prefetch(range.offset, range.length);
+      }
+      ranges.clear();
+      return;
+    }
+
+    uint64_t totalLength = 0;
+    for (const ReadRange& range : ranges) {
+      totalLength += range.length;
+    }
+    data.reset(new DataBuffer<char>(*contents->pool, totalLength));
+    char* buffer = data->data();
+    for (const ReadRange& range : ranges) {
+      contents->stream->read(buffer, range.length, range.offset);
+      buffer += range.length;
+    }
+  }
+
+  void RowReaderImpl::prefetchStripes() {
+    if (prefetchDepth == 0) {
+      return;
+    }
+    uint64_t stripe = prefetchedStripes.empty() ? currentStripe + 1 :
+      prefetchedStripes.back().first + 1;
+    const proto::Metadata* metadata = contents->metadata.get();
+    bool isCounted = metrics != nullptr;
+    while (prefetchedStripes.size() < prefetchDepth && stripe < lastStripe) {
+      // don't read the stripes that predicate push down skips
+      if (sargsApplier && metadata != nullptr &&
+          stripe < static_cast<uint64_t>(metadata->stripestats_size()) &&
+          !sargsApplier->evaluateStripeStatistics(
+            metadata->stripestats(static_cast<int>(stripe)))) {
+        ++stripe;
+        continue;
+      }
+      proto::StripeInformation info =
+        footer->stripes(static_cast<int>(stripe));
+      prefetchedStripes.emplace_back(stripe, std::async(std::launch::async,
+        [this, info, isCounted]() {
+          std::unique_ptr<PrefetchedStripe> result(new PrefetchedStripe());
+          result->footer = getStripeFooter(info, *contents.get());
+          readStripeData(info, result->footer, result->data, result->ranges,
+                         isCounted ? &result->metrics : nullptr, true);
+          return result;
+        }));
+      ++stripe;
+    }
+  }
+
+  std::unique_ptr<PrefetchedStripe>
+  RowReaderImpl::takePrefetchedStripe(uint64_t stripe) {
+    while (!prefetchedStripes.empty() &&
+           prefetchedStripes.front().first < stripe) {
+      prefetchedStripes.pop_front();
+    }
+    if (prefetchedStripes.empty() ||
+        prefetchedStripes.front().first != stripe) {
+      return std::unique_ptr<PrefetchedStripe>();
+    }
+    std::unique_ptr<PrefetchedStripe> result =
+      prefetchedStripes.front().second.get();
+    prefetchedStripes.pop_front();
+    return result;
+  }
+
+  const char* RowReaderImpl::getStripeData(uint64_t offset,
+                                           uint64_t length) const {
+    const char* buffer = stripeData ? stripeData->data() : nullptr;
+    for (const ReadRange& range : stripeRanges) {
+      if (offset >= range.offset &&
+          offset + length <= range.offset + range.length) {
+        return buffer + (offset - range.offset);
+      }
+      buffer += range.length;
+    }
+    return nullptr;
+  }
+
   void RowReaderImpl::startNextStripe() {
     reader.reset(); // ColumnReaders use lots of memory; free old memory first
-    currentStripeInfo = footer->stripes(static_cast<int>(currentStripe));
-    uint64_t fileLength = contents->stream->getLength();
-    if (currentStripeInfo.offset() + currentStripeInfo.indexlength() +
-        currentStripeInfo.datalength() + currentStripeInfo.footerlength() >= fileLength) {
-      std::stringstream msg;
-      msg << "Malformed StripeInformation at stripe index " << currentStripe << ": fileLength="
-          << fileLength << ", StripeInfo=(offset=" << currentStripeInfo.offset() << ", indexLength="
-          << currentStripeInfo.indexlength() << ", dataLength=" << currentStripeInfo.datalength()
-          << ", footerLength=" << currentStripeInfo.footerlength() << ")";
-      throw ParseError(msg.str());
+    if (metrics) {
+      flushMetrics();
+    }
+    stripeData.reset();
+    stripeRanges.clear();
+    rowIndexes.clear();
+    bloomFilterIndex.clear();
+    std::unique_ptr<PrefetchedStripe> prefetched;
+    while (true) {
+      currentStripeInfo = footer->stripes(static_cast<int>(currentStripe));
+      uint64_t fileLength = contents->stream->getLength();
+      if (currentStripeInfo.offset() + currentStripeInfo.indexlength() +
+          currentStripeInfo.datalength() + currentStripeInfo.footerlength() >= fileLength) {
+        std::stringstream msg;
+        msg << "Malformed StripeInformation at stripe index " << currentStripe << ": fileLength="
+            << fileLength << ", StripeInfo=(offset=" << currentStripeInfo.offset() << ", indexLength="
+            << currentStripeInfo.indexlength() << ", dataLength=" << currentStripeInfo.datalength()
+            << ", footerLength=" << currentStripeInfo.footerlength() << ")";
+        throw ParseError(msg.str());
+      }
+      rowsInCurrentStripe = currentStripeInfo.numberofrows();
+      prefetched = takePrefetchedStripe(currentStripe);
+      if (prefetched && metrics) {
+        metrics->add(prefetched->metrics);
+      }
+      // skip the stripe if its statistics rule out every row
+      const proto::Metadata* metadata = contents->metadata.get();
+      bool isNeeded = !sargsApplier || metadata == nullptr ||
+        currentStripe >= static_cast<uint64_t>(metadata->stripestats_size()) ||
+        sargsApplier->evaluateStripeStatistics(
+          metadata->stripestats(static_cast<int>(currentStripe)));
+      if (isNeeded) {
+        if (prefetched) {
+          currentStripeFooter.Swap(&prefetched->footer);
+        } else {
+          currentStripeFooter = getStripeFooter(currentStripeInfo, *contents.get());
+        }
+        if (!sargsApplier || pickRowGroups()) {
+          break;
+        }
+      } else if (metrics) {
+        metrics->rowGroupsSkipped += getRowGroupCount(
+          rowsInCurrentStripe, footer->rowindexstride());
+      }
+      if (metrics) {
+        metrics->stripesSkipped += 1;
+      }
+      currentStripe += 1;
+      currentRowInStripe = 0;
+      if (currentStripe >= lastStripe) {
+        return;
+      }
     }
-    currentStripeFooter = getStripeFooter(currentStripeInfo, *contents.get());
-    rowsInCurrentStripe = currentStripeInfo.numberofrows();
     const Timezone& writerTimezone =
       currentStripeFooter.has_writertimezone() ?
         getTimezoneByName(currentStripeFooter.writertimezone()) :
         localTimezone;
+    if (prefetched) {
+      stripeData = std::move(prefetched->data);
+      stripeRanges = std::move(prefetched->ranges);
+    } else {
+      readStripeData(currentStripeInfo, currentStripeFooter, stripeData,
+                     stripeRanges, metrics.get(), false);
+    }
+    if (metrics) {
+      metrics->stripesRead += 1;
+      if (!sargsApplier) {
+        metrics->rowGroupsRead += getRowGroupCount(
+          rowsInCurrentStripe, footer->rowindexstride());
+      }
+    }
+    prefetchStripes();
     StripeStreamsImpl stripeStreams(*this, currentStripe, currentStripeInfo,
                                     currentStripeFooter,
                                     currentStripeInfo.offset(),
                                     *(contents->stream.get()),
                                     writerTimezone);
     reader = buildReader(*contents->schema.get(), stripeStreams);
+    if (batchMemoryBudget != 0) {
+      estimateRowSize();
+    }
+
+    // move on to the first selected row group
+    uint64_t nextRow = nextSelectedRow(currentRowInStripe);
+    if (nextRow != currentRowInStripe) {
+      currentRowInStripe = nextRow;
+      seekToRowGroup(static_cast<uint32_t>(nextRow / footer->rowindexstride()));
+    }
   }
 
-  bool RowReaderImpl::next(ColumnVectorBatch& data) {
-    if (currentStripe >= lastStripe) {
-      data.numElements = 0;
-      if (lastStripe > 0) {
-        previousRow = firstRowOfStripe[lastStripe - 1] +
-          footer->stripes(static_cast<int>(lastStripe - 1)).numberofrows();
-      } else {
-        previousRow = 0;
+  /**
+   * The bytes that a value of the given type takes up in a batch, not
+   * counting its string bytes or its children.
+   */
+  static uint64_t getValueBytes(const Type& type) {
+    switch (static_cast<int64_t>(type.getKind())) {
+    case STRUCT:
+      return 1;
+    case LIST:
+    case MAP:
+      return 1 + sizeof(int64_t);
+    case UNION:
+      return 1 + sizeof(unsigned char) + sizeof(uint64_t);
+    case STRING:
+    case BINARY:
+    case VARCHAR:
+    case CHAR:
+      return 1 + sizeof(char*) + sizeof(int64_t);
+    case TIMESTAMP:
+      return 1 + 2 * sizeof(int64_t);
+    case DECIMAL:
+      if (type.getPrecision() == 0 || type.getPrecision() > 18) {
+        return 1 + sizeof(Int128);
       }
-      return false;
+      return 1 + sizeof(int64_t);
+    default:
+      return 1 + sizeof(int64_t);
     }
-    if (currentRowInStripe == 0) {
-      startNextStripe();
+  }
+
+  /**
+   * Add up the bytes that the selected columns under a type would take up
+   * in batches holding all of the values counted by the statistics.
+   */
+  static uint64_t getStatisticsBytes(
+                    const Type& type,
+                    const std::vector<bool>& selectedColumns,
+                    const google::protobuf::RepeatedPtrField<
+                      proto::ColumnStatistics>& statistics) {
+    uint64_t column = type.getColumnId();
+    if (!selectedColumns[column]) {
+      return 0;
     }
-    uint64_t rowsToRead =
-      std::min(static_cast<uint64_t>(data.capacity),
-               rowsInCurrentStripe - currentRowInStripe);
-    data.numElements = rowsToRead;
-    if (enableEncodedBlock) {
-      reader->nextEncoded(data, rowsToRead, nullptr);
+    uint64_t bytes = 0;
+    if (column < static_cast<uint64_t>(statistics.size())) {
+      const proto::ColumnStatistics& stats =
+        statistics.Get(static_cast<int>(column));
+      bytes += stats.numberofvalues() * getValueBytes(type);
+      if (stats.has_stringstatistics()) {
+        bytes += static_cast<uint64_t>(stats.stringstatistics().sum());
+      } else if (stats.has_binarystatistics()) {
+        bytes += static_cast<uint64_t>(stats.binarystatistics().sum());
+      }
     }
-    else {
-      reader->next(data, rowsToRead, nullptr);
+    for (uint64_t i = 0; i < type.getSubtypeCount(); ++i) {
+      bytes += getStatisticsBytes(*type.getSubtype(i), selectedColumns,
+                                  statistics);
     }
-    // update row number
-    previousRow = firstRowOfStripe[currentStripe] + currentRowInStripe;
-    currentRowInStripe += rowsToRead;
-    if (currentRowInStripe >= rowsInCurrentStripe) {
-      currentStripe += 1;
-      currentRowInStripe = 0;
+    return bytes;
+  }
+
+  /**
+   * The bytes that the first rows of a batch take up.
+   */
+  static uint64_t getBatchBytes(const Type& type, ColumnVectorBatch& batch,
+                                uint64_t rows) {
+    uint64_t bytes = rows * getValueBytes(type);
+    switch (static_cast<int64_t>(type.getKind())) {
+    case STRUCT: {
+      StructVectorBatch& structs = dynamic_cast<StructVectorBatch&>(batch);
+      for (uint64_t i = 0; i < type.getSubtypeCount(); ++i) {
+        bytes += getBatchBytes(*type.getSubtype(i), *structs.fields[i], rows);
+      }
+      break;
+    }
+    case LIST: {
+      ListVectorBatch& lists = dynamic_cast<ListVectorBatch&>(batch);
+      if (lists.elements) {
+        bytes += getBatchBytes(*type.getSubtype(0), *lists.elements,
+                               static_cast<uint64_t>(lists.offsets[rows]));
+      }
+      break;
+    }
+    case MAP: {
+      MapVectorBatch& maps = dynamic_cast<MapVectorBatch&>(batch);
+      uint64_t entries = static_cast<uint64_t>(maps.offsets[rows]);
+      if (maps.keys) {
+        bytes += getBatchBytes(*type.getSubtype(0), *maps.keys, entries);
+      }
+      if (maps.elements) {
+        bytes += getBatchBytes(*type.getSubtype(1), *maps.elements, entries);
+      }
+      break;
+    }
+    case UNION: {
+      UnionVectorBatch& unions = dynamic_cast<UnionVectorBatch&>(batch);
+      for (uint64_t i = 0; i < type.getSubtypeCount(); ++i) {
+        bytes += getBatchBytes(*type.getSubtype(i), *unions.children[i],
+                               unions.children[i]->numElements);
+      }
+      break;
+    }
+    case STRING:
+    case BINARY:
+    case VARCHAR:
+    case CHAR: {
+      // the values of dictionary columns point into the dictionary
+      StringVectorBatch& strings = dynamic_cast<StringVectorBatch&>(batch);
+      if (!strings.isEncoded) {
+        bytes += strings.blob.size();
+      }
+      break;
+    }
+    default:
+      break;
+    }
+    return bytes;
+  }
+
+  void RowReaderImpl::estimateRowSize() {
+    const proto::Metadata* metadata = contents->metadata.get();
+    uint64_t bytes;
+    uint64_t rows;
+    if (currentStripe < lastStripe && metadata != nullptr &&
+        currentStripe < static_cast<uint64_t>(metadata->stripestats_size())) {
+      bytes = getStatisticsBytes(*contents->schema, selectedColumns,
+                                 metadata->stripestats(
+                                   static_cast<int>(currentStripe)).colstats());
+      rows = footer->stripes(static_cast<int>(currentStripe)).numberofrows();
+    } else {
+      bytes = getStatisticsBytes(*contents->schema, selectedColumns,
+                                 footer->statistics());
+      rows = footer->numberofrows();
+    }
+    statisticsBytesPerRow =
+      static_cast<double>(std::max<uint64_t>(bytes, 1)) /
+      static_cast<double>(std::max<uint64_t>(rows, 1));
+  }
+
+  void RowReaderImpl::observeBatch(ColumnVectorBatch& data,
+                                   uint64_t rowsRead) {
+    if (data.numElements == 0) {
+      return;
+    }
+    double observed = static_cast<double>(
+      getBatchBytes(getSelectedType(), data, data.numElements)) /
+      static_cast<double>(rowsRead);
+    // older batches count for less and less
+    observedBytesPerRow = (observedBytesPerRow + observed) / 2;
+  }
+
+  void RowReaderImpl::markEndOfFile() {
+    if (lastStripe > 0) {
+      previousRow = firstRowOfStripe[lastStripe - 1] +
+        footer->stripes(static_cast<int>(lastStripe - 1)).numberofrows();
+    } else {
+      previousRow = 0;
+    }
+  }
+
+  bool RowReaderImpl::next(ColumnVectorBatch& data) {
+    // with a row filter, keep reading until some rows pass it
+    while (true) {
+      if (currentStripe < lastStripe && currentRowInStripe == 0) {
+        startNextStripe();
+      }
+      if (currentStripe >= lastStripe) {
+        data.numElements = 0;
+        markEndOfFile();
+        if (metrics) {
+          flushMetrics();
+        }
+        return false;
+      }
+      uint64_t rowsToRead =
+        std::min(static_cast<uint64_t>(data.capacity),
+                 rowsInCurrentStripe - currentRowInStripe);
+      if (sargsApplier) {
+        // stop at the next row group that is skipped
+        rowsToRead = std::min(rowsToRead,
+                              endOfSelectedRows(currentRowInStripe) -
+                                currentRowInStripe);
+      }
+      if (batchMemoryBudget != 0) {
+        double rowsInBudget = static_cast<double>(batchMemoryBudget) /
+          std::max(statisticsBytesPerRow, observedBytesPerRow);
+        if (rowsInBudget < static_cast<double>(rowsToRead)) {
+          rowsToRead = std::max<uint64_t>(
+            static_cast<uint64_t>(rowsInBudget), 1);
+        }
+      }
+      data.numElements = rowsToRead;
+      uint64_t start = metrics ? getMetricsTime() : 0;
+      if (rowFilter) {
+        reader->nextFiltered(data, rowsToRead, *rowFilter, rowFilterFields,
+                             enableEncodedBlock);
+      } else if (enableEncodedBlock) {
+        reader->nextEncoded(data, rowsToRead, nullptr);
+      }
+      else {
+        reader->next(data, rowsToRead, nullptr);
+      }
+      if (metrics) {
+        metrics->addDecode(0, rowsToRead, getMetricsTime() - start);
+      }
+      if (batchMemoryBudget != 0) {
+        observeBatch(data, rowsToRead);
+      }
+      // update row number
+      previousRow = firstRowOfStripe[currentStripe] + currentRowInStripe;
+      currentRowInStripe += rowsToRead;
+      if (sargsApplier && currentRowInStripe < rowsInCurrentStripe) {
+        uint64_t nextRow = nextSelectedRow(currentRowInStripe);
+        if (nextRow != currentRowInStripe) {
+          currentRowInStripe = nextRow;
+          if (nextRow < rowsInCurrentStripe) {
+            seekToRowGroup(
+              static_cast<uint32_t>(nextRow / footer->rowindexstride()));
+          }
+        }
+      }
+      if (currentRowInStripe >= rowsInCurrentStripe) {
+        currentStripe += 1;
+        currentRowInStripe = 0;
+      }
+      if (rowsToRead == 0 || data.numElements != 0) {
+        return rowsToRead != 0;
+      }
     }
-    return rowsToRead != 0;
   }
 
   std::unique_ptr<ColumnVectorBatch> RowReaderImpl::createRowBatch
@@ -1093,6 +1695,7 @@ namespace orc {
     std::shared_ptr<FileContents> contents = std::shared_ptr<FileContents>(new FileContents());
     contents->pool = options.getMemoryPool();
     contents->errorStream = options.getErrorStream();
+    contents->readerMetrics = options.getReaderMetrics();
     std::string serializedFooter = options.getSerializedFileTail();
     uint64_t fileLength;
     uint64_t postscriptLength;
@@ -1149,6 +1752,10 @@ namespace orc {
                                                   postscriptLength));
   }
 
+  const ReaderMetrics* ReaderImpl::getReaderMetrics() const {
+    return contents->readerMetrics.get();
+  }
+
   std::map<uint32_t, BloomFilterIndex>
   ReaderImpl::getBloomFilters(uint32_t stripeIndex,
                               const std::set<uint32_t>& included) const {
@@ -1212,14 +1819,26 @@ namespace orc {
     // PASS
   }
 
+  const ReaderMetrics* RowReader::getReaderMetrics() {
+    return nullptr;
+  }
+
   Reader::~Reader() {
     // PASS
   }
 
+  const ReaderMetrics* Reader::getReaderMetrics() const {
+    return nullptr;
+  }
+
   InputStream::~InputStream() {
     // PASS
   };
 
+  RowFilter::~RowFilter() {
+    // PASS
+  }
+
 
 
 }// namespace
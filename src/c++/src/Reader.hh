@@ -24,9 +24,16 @@
 #include "orc/Reader.hh"
 
 #include "ColumnReader.hh"
+#include "io/InputStream.hh"
 #include "orc/Exceptions.hh"
+#include "ReaderMetrics.hh"
 #include "RLE.hh"
 #include "TypeImpl.hh"
+#include "sargs/SargsApplier.hh"
+
+#include <deque>
+#include <future>
+#include <mutex>
 
 namespace orc {
 
@@ -57,11 +64,15 @@ namespace orc {
     std::unique_ptr<InputStream> stream;
     std::unique_ptr<proto::PostScript> postscript;
     std::unique_ptr<proto::Footer> footer;
+    // the stripe statistics, loaded on demand by ReaderImpl
+    std::unique_ptr<proto::Metadata> metadata;
     std::unique_ptr<Type> schema;
     uint64_t blockSize;
     CompressionKind compression;
     MemoryPool *pool;
     std::ostream *errorStream;
+    // where the row readers add their counters, if anywhere
+    std::shared_ptr<ReaderMetrics> readerMetrics;
   };
 
   proto::StripeFooter getStripeFooter(const proto::StripeInformation& info,
@@ -108,6 +119,17 @@ namespace orc {
   };
 
 
+  /**
+   * A stripe whose footer and selected data streams were read ahead.
+   */
+  struct PrefetchedStripe {
+    proto::StripeFooter footer;
+    std::unique_ptr<DataBuffer<char> > data;
+    std::vector<ReadRange> ranges;
+    // the reads of the prefetch thread
+    ReaderMetricsCounters metrics;
+  };
+
   class RowReaderImpl : public RowReader {
   private:
     const Timezone& localTimezone;
@@ -142,6 +164,43 @@ namespace orc {
 
     // row index of current stripe with column id as the key
     std::unordered_map<uint64_t, proto::RowIndex> rowIndexes;
+    // bloom filters of the filter columns in the current stripe
+    std::map<uint32_t, BloomFilterIndex> bloomFilterIndex;
+
+    // predicate push down
+    std::shared_ptr<SearchArgument> sargs;
+    std::unique_ptr<SargsApplier> sargsApplier;
+
+    // the row filter and the indexes of its columns among the selected
+    // fields
+    std::shared_ptr<RowFilter> rowFilter;
+    std::vector<uint64_t> rowFilterFields;
+
+    // the memory budget of a batch and the bytes of a row as estimated
+    // from the statistics and from the recent batches; the larger one is
+    // used
+    const uint64_t batchMemoryBudget;
+    double statisticsBytesPerRow;
+    double observedBytesPerRow;
+
+    /**
+     * Estimate the bytes of a row from the statistics of the current
+     * stripe, or of the file if the stripe has none.
+     */
+    void estimateRowSize();
+
+    /**
+     * Correct the estimated bytes of a row with a batch that was read.
+     * @param data the batch
+     * @param rowsRead the number of rows read into it
+     */
+    void observeBatch(ColumnVectorBatch& data, uint64_t rowsRead);
+
+    /**
+     * Read the row indexes of the selected and filter columns and the
+     * bloom filters of the filter columns for the current stripe.
+     */
+    void loadStripeIndex();
 
     /**
      * Seek to the start of a row group in the current stripe
@@ -149,6 +208,82 @@ namespace orc {
      */
     void seekToRowGroup(uint32_t rowGroupEntryId);
 
+    /**
+     * Pick the row groups of the current stripe that the search argument
+     * may match.
+     * @return true if any of them is at or after the current row
+     */
+    bool pickRowGroups();
+
+    /**
+     * The first row at or after the given row of the current stripe that
+     * is in a selected row group, or the number of rows in the stripe.
+     */
+    uint64_t nextSelectedRow(uint64_t row) const;
+
+    /**
+     * The end of the run of selected row groups holding the given row.
+     */
+    uint64_t endOfSelectedRows(uint64_t row) const;
+
+    void markEndOfFile();
+
+    // the selected data streams of the current stripe, read with a few
+    // large reads; stripeRanges are the ranges of the file it holds
+    const bool enableCoalescedReads;
+    const uint64_t coalescedReadGap;
+    std::unique_ptr<DataBuffer<char> > stripeData;
+    std::vector<ReadRange> stripeRanges;
+
+    /**
+     * Read the data streams of the selected columns in a stripe into one
+     * buffer. Streams of a memory mapped file are only prefetched. Without
+     * coalesced reads nothing is read unless the stripe is read ahead, in
+     * which case only adjacent streams are read together. May be called
+     * from a prefetch thread.
+     * @param info the stripe
+     * @param stripeFooter the footer of the stripe
+     * @param data set to the buffer holding the streams
+     * @param ranges set to the ranges of the file the buffer holds
+     * @param counters where to count the reads, if anywhere
+     * @param isPrefetch whether the stripe is being read ahead
+     */
+    void readStripeData(const proto::StripeInformation& info,
+                        const proto::StripeFooter& stripeFooter,
+                        std::unique_ptr<DataBuffer<char> >& data,
+                        std::vector<ReadRange>& ranges,
+                        ReaderMetricsCounters* counters,
+                        bool isPrefetch) const;
+
+    // the counters of this reader, if the file has ReaderMetrics
+    std::unique_ptr<ReaderMetricsCounters> metrics;
+
+    /**
+     * Add the counters of this reader to the ReaderMetrics of the file.
+     */
+    void flushMetrics();
+
+    // the stripes after the current one that are read in the background,
+    // in stripe order. They are declared last, so the reads are finished
+    // before the rest of the reader is destroyed.
+    const uint64_t prefetchDepth;
+    std::deque<std::pair<uint64_t,
+                         std::future<std::unique_ptr<PrefetchedStripe> > > >
+      prefetchedStripes;
+
+    /**
+     * Start reading the next stripes in the background, up to the
+     * prefetch depth.
+     */
+    void prefetchStripes();
+
+    /**
+     * Take the given stripe from the prefetched stripes, waiting for it to
+     * be read, and drop the prefetched stripes before it.
+     * @return the stripe or nullptr if it wasn't prefetched
+     */
+    std::unique_ptr<PrefetchedStripe> takePrefetchedStripe(uint64_t stripe);
+
   public:
    /**
     * Constructor that lets the user specify additional options.
@@ -158,6 +293,8 @@ namespace orc {
     RowReaderImpl(std::shared_ptr<FileContents> contents,
                   const RowReaderOptions& options);
 
+    ~RowReaderImpl() override;
+
     // Select the columns from the options object
     void updateSelected();
     const std::vector<bool> getSelectedColumns() const override;
@@ -177,7 +314,21 @@ namespace orc {
 
     void seekToRow(uint64_t rowNumber) override;
 
+    const ReaderMetrics* getReaderMetrics() override;
+
     const FileContents& getFileContents() const;
+
+    ReaderMetricsCounters* getMetricsCounters() const {
+      return metrics.get();
+    }
+
+    /**
+     * Get the given bytes of the file if they were read with the current
+     * stripe.
+     * @return the bytes or nullptr if they weren't read
+     */
+    const char* getStripeData(uint64_t offset, uint64_t length) const;
+
     bool getThrowOnHive11DecimalOverflow() const;
     int32_t getForcedScaleOnHive11Decimal() const;
   };
@@ -198,6 +349,8 @@ namespace orc {
     uint64_t getMemoryUse(int stripeIx, std::vector<bool>& selectedColumns);
 
     // internal methods
+    // load the metadata on the first call, it is safe to call from
+    // several threads
     void readMetadata() const;
     void checkOrcVersion();
     void getRowIndexStatistics(const proto::StripeInformation& stripeInfo, uint64_t stripeIndex,
@@ -205,8 +358,9 @@ namespace orc {
                                std::vector<std::vector<proto::ColumnStatistics> >* indexStats) const;
 
     // metadata
-    mutable std::unique_ptr<proto::Metadata> metadata;
     mutable bool isMetadataLoaded;
+    // guards loading the metadata, see readMetadata
+    mutable std::mutex metadataMutex;
    public:
     /**
      * Constructor that lets the user specify additional options.
@@ -298,6 +452,8 @@ namespace orc {
 
     std::map<uint32_t, BloomFilterIndex>
     getBloomFilters(uint32_t stripeIndex, const std::set<uint32_t>& included) const override;
+
+    const ReaderMetrics* getReaderMetrics() const override;
   };
 
 }// namespace
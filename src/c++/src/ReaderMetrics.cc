@@ -0,0 +1,148 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ReaderMetrics.hh"
+
+#include <algorithm>
+#include <string.h>
+
+namespace orc {
+
+  ReaderMetricsCounters::ReaderMetricsCounters() {
+    clear();
+  }
+
+  void ReaderMetricsCounters::add(const ReaderMetricsCounters& other) {
+    for (size_t i = 0; i < METRICS_STREAM_KINDS; ++i) {
+      streams[i].readCalls += other.streams[i].readCalls;
+      streams[i].bytesRead += other.streams[i].bytesRead;
+    }
+    for (size_t i = 0; i < METRICS_COMPRESSION_KINDS; ++i) {
+      DecompressionMetrics& codec = decompression[i];
+      const DecompressionMetrics& otherCodec = other.decompression[i];
+      codec.blocks += otherCodec.blocks;
+      codec.compressedBytes += otherCodec.compressedBytes;
+      codec.decompressedBytes += otherCodec.decompressedBytes;
+      codec.nanoseconds += otherCodec.nanoseconds;
+    }
+    if (columns.size() < other.columns.size()) {
+      columns.resize(other.columns.size(), DecodeMetrics());
+    }
+    for (size_t i = 0; i < other.columns.size(); ++i) {
+      columns[i].calls += other.columns[i].calls;
+      columns[i].values += other.columns[i].values;
+      columns[i].nanoseconds += other.columns[i].nanoseconds;
+    }
+    stripesRead += other.stripesRead;
+    stripesSkipped += other.stripesSkipped;
+    rowGroupsRead += other.rowGroupsRead;
+    rowGroupsSkipped += other.rowGroupsSkipped;
+  }
+
+  void ReaderMetricsCounters::clear() {
+    memset(streams, 0, sizeof(streams));
+    memset(decompression, 0, sizeof(decompression));
+    // keep the size, so the next stripe doesn't grow it again
+    std::fill(columns.begin(), columns.end(), DecodeMetrics());
+    stripesRead = 0;
+    stripesSkipped = 0;
+    rowGroupsRead = 0;
+    rowGroupsSkipped = 0;
+  }
+
+  void addReaderMetrics(ReaderMetrics& metrics,
+                        ReaderMetricsCounters& counters) {
+    {
+      std::lock_guard<std::mutex> lock(metrics.privateBits->mutex);
+      metrics.privateBits->counters.add(counters);
+    }
+    counters.clear();
+  }
+
+  ReaderMetrics::ReaderMetrics(): privateBits(new ReaderMetricsPrivate()) {
+    // PASS
+  }
+
+  ReaderMetrics::~ReaderMetrics() {
+    // PASS
+  }
+
+  std::map<StreamKind, StreamReadMetrics>
+      ReaderMetrics::getStreamReads() const {
+    std::lock_guard<std::mutex> lock(privateBits->mutex);
+    std::map<StreamKind, StreamReadMetrics> result;
+    for (size_t i = 0; i < METRICS_STREAM_KINDS; ++i) {
+      const StreamReadMetrics& stream = privateBits->counters.streams[i];
+      if (stream.readCalls != 0 || stream.bytesRead != 0) {
+        result[static_cast<StreamKind>(i)] = stream;
+      }
+    }
+    return result;
+  }
+
+  std::map<CompressionKind, DecompressionMetrics>
+      ReaderMetrics::getDecompression() const {
+    std::lock_guard<std::mutex> lock(privateBits->mutex);
+    std::map<CompressionKind, DecompressionMetrics> result;
+    for (size_t i = 0; i < METRICS_COMPRESSION_KINDS; ++i) {
+      const DecompressionMetrics& codec =
+        privateBits->counters.decompression[i];
+      if (codec.compressedBytes != 0 || codec.decompressedBytes != 0) {
+        result[static_cast<CompressionKind>(i)] = codec;
+      }
+    }
+    return result;
+  }
+
+  std::map<uint64_t, DecodeMetrics> ReaderMetrics::getColumnDecoding() const {
+    std::lock_guard<std::mutex> lock(privateBits->mutex);
+    std::map<uint64_t, DecodeMetrics> result;
+    const std::vector<DecodeMetrics>& columns = privateBits->counters.columns;
+    for (size_t i = 0; i < columns.size(); ++i) {
+      if (columns[i].calls != 0) {
+        result[i] = columns[i];
+      }
+    }
+    return result;
+  }
+
+  uint64_t ReaderMetrics::getStripesRead() const {
+    std::lock_guard<std::mutex> lock(privateBits->mutex);
+    return privateBits->counters.stripesRead;
+  }
+
+  uint64_t ReaderMetrics::getStripesSkipped() const {
+    std::lock_guard<std::mutex> lock(privateBits->mutex);
+    return privateBits->counters.stripesSkipped;
+  }
+
+  uint64_t ReaderMetrics::getRowGroupsRead() const {
+    std::lock_guard<std::mutex> lock(privateBits->mutex);
+    return privateBits->counters.rowGroupsRead;
+  }
+
+  uint64_t ReaderMetrics::getRowGroupsSkipped() const {
+    std::lock_guard<std::mutex> lock(privateBits->mutex);
+    return privateBits->counters.rowGroupsSkipped;
+  }
+
+  void ReaderMetrics::reset() {
+    std::lock_guard<std::mutex> lock(privateBits->mutex);
+    privateBits->counters.clear();
+  }
+}
@@ -0,0 +1,114 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ORC_READER_METRICS_HH
+#define ORC_READER_METRICS_HH
+
+#include "orc/Reader.hh"
+
+#include <chrono>
+#include <mutex>
+#include <vector>
+
+namespace orc {
+
+  // the number of stream kinds and codecs that are counted
+  static const size_t METRICS_STREAM_KINDS = StreamKind_BLOOM_FILTER_UTF8 + 1;
+  static const size_t METRICS_COMPRESSION_KINDS = CompressionKind_ZSTD + 1;
+
+  /**
+   * The counters of one row reader. Only the thread that runs the reader
+   * touches them, so counting doesn't take a lock; they are added to the
+   * shared ReaderMetrics now and then.
+   */
+  struct ReaderMetricsCounters {
+    StreamReadMetrics streams[METRICS_STREAM_KINDS];
+    DecompressionMetrics decompression[METRICS_COMPRESSION_KINDS];
+    // by column id
+    std::vector<DecodeMetrics> columns;
+    uint64_t stripesRead;
+    uint64_t stripesSkipped;
+    uint64_t rowGroupsRead;
+    uint64_t rowGroupsSkipped;
+
+    ReaderMetricsCounters();
+
+    /**
+     * Get the counters of the reads of a stream kind.
+     * @return the counters or nullptr if the kind isn't counted
+     */
+    StreamReadMetrics* getStreamReads(uint64_t kind) {
+      return kind < METRICS_STREAM_KINDS ? &streams[kind] : nullptr;
+    }
+
+    /**
+     * Get the counters of a codec.
+     * @return the counters or nullptr if the codec isn't counted
+     */
+    DecompressionMetrics* getDecompression(CompressionKind kind) {
+      size_t index = static_cast<size_t>(kind);
+      return index < METRICS_COMPRESSION_KINDS ?
+        &decompression[index] : nullptr;
+    }
+
+    /**
+     * Count a call to the reader of a column.
+     */
+    void addDecode(uint64_t columnId, uint64_t values, uint64_t nanoseconds) {
+      if (columnId >= columns.size()) {
+        columns.resize(columnId + 1, DecodeMetrics());
+      }
+      DecodeMetrics& column = columns[columnId];
+      column.calls += 1;
+      column.values += values;
+      column.nanoseconds += nanoseconds;
+    }
+
+    /**
+     * Add the given counters to these ones.
+     */
+    void add(const ReaderMetricsCounters& other);
+
+    /**
+     * Set all of the counters back to zero.
+     */
+    void clear();
+  };
+
+  struct ReaderMetricsPrivate {
+    std::mutex mutex;
+    ReaderMetricsCounters counters;
+  };
+
+  /**
+   * Add the counters of a row reader to the shared metrics and clear them.
+   */
+  void addReaderMetrics(ReaderMetrics& metrics,
+                        ReaderMetricsCounters& counters);
+
+  /**
+   * The time for the metrics from a steady clock in nanoseconds.
+   */
+  inline uint64_t getMetricsTime() {
+    return static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+  }
+}
+
+#endif
@@ -34,6 +34,78 @@ int64_t RleDecoderV2::readLongBE(uint64_t bsz) {
   return ret;
 }
 
+uint64_t RleDecoderV2::readLong(uint64_t fb) {
+  uint64_t result = 0;
+  uint64_t bitsLeftToRead = fb;
+  while (bitsLeftToRead > bitsLeft) {
+    result <<= bitsLeft;
+    result |= curByte & ((1 << bitsLeft) - 1);
+    bitsLeftToRead -= bitsLeft;
+    curByte = readByte();
+    bitsLeft = 8;
+  }
+
+  // handle the left over bits
+  if (bitsLeftToRead > 0) {
+    result <<= bitsLeftToRead;
+    bitsLeft -= static_cast<uint32_t>(bitsLeftToRead);
+    result |= (curByte >> bitsLeft) & ((1 << bitsLeftToRead) - 1);
+  }
+  return result;
+}
+
+void RleDecoderV2::unpackLongs(int64_t* data, uint64_t count, uint64_t fb) {
+  uint64_t i = 0;
+  while (i < count) {
+    // unpack the values that start on a byte boundary and end in the
+    // current buffer in one go
+    if (bitsLeft == 0 && fb > 0 && bufferStart != bufferEnd) {
+      uint64_t bufferBits =
+        static_cast<uint64_t>(bufferEnd - bufferStart) * 8;
+      uint64_t bulk = std::min(count - i, bufferBits / fb);
+      if (bulk > 0) {
+        unpackBits(reinterpret_cast<const unsigned char*>(bufferStart),
+                   static_cast<uint32_t>(fb), data + i, bulk);
+        i += bulk;
+        uint64_t bits = bulk * fb;
+        bufferStart += bits / 8;
+        if (bits % 8 != 0) {
+          // the last value ends part way through a byte
+          curByte = static_cast<unsigned char>(*bufferStart++);
+          bitsLeft = static_cast<uint32_t>(8 - bits % 8);
+        }
+        continue;
+      }
+    }
+    // values that cross into the next buffer or start mid byte
+    data[i++] = static_cast<int64_t>(readLong(fb));
+  }
+}
+
+uint64_t RleDecoderV2::readLongs(int64_t *data, uint64_t offset, uint64_t len,
+                                 uint64_t fb, const char* notNull) {
+  uint64_t count = len;
+  if (notNull) {
+    count = 0;
+    for (uint64_t i = offset; i < offset + len; ++i) {
+      count += notNull[i] ? 1 : 0;
+    }
+  }
+  unpackLongs(data + offset, count, fb);
+
+  if (count != len) {
+    // spread the values over the non-null positions, starting at the back
+    // so no value is overwritten before it is moved
+    uint64_t from = offset + count;
+    for (uint64_t i = offset + len; i > from; --i) {
+      if (notNull[i - 1]) {
+        data[i - 1] = data[--from];
+      }
+    }
+  }
+  return count;
+}
+
 inline int64_t RleDecoderV2::readVslong() {
   return unZigZag(readVulong());
 }
@@ -28,38 +28,104 @@ namespace orc {
 
 /**
  * Compute the bits required to represent pth percentile value
- * @param data - array
+ * @param histogram - the number of values of each bit length, see
+ *   getBitLength
+ * @param length - the number of values
  * @param p - percentile value (>=0.0 to <=1.0)
  * @return pth percentile bits
  */
-uint32_t RleEncoderV2::percentileBits(int64_t* data, size_t offset, size_t length, double p, bool reuseHist) {
+static uint32_t percentileBits(const uint32_t* histogram, size_t length, double p) {
     if ((p > 1.0) || (p <= 0.0)) {
         throw InvalidArgument("Invalid p value: " + to_string(p));
     }
 
-    if (!reuseHist) {
-        // histogram that store the encoded bit requirement for each values.
-        // maximum number of bits that can encoded is 32 (refer FixedBitSizes)
-        memset(histgram, 0, FixedBitSizes::SIZE * sizeof(int32_t));
-        // compute the histogram
-        for(size_t i = offset; i < (offset + length); i++) {
-            uint32_t idx = encodeBitWidth(findClosestNumBits(data[i]));
-            histgram[idx] += 1;
-        }
-    }
-
-    int32_t perLen = static_cast<int32_t>(static_cast<double>(length) * (1.0 - p));
+    int64_t perLen = static_cast<int64_t>(static_cast<double>(length) * (1.0 - p));
 
     // return the bits required by pth percentile length
-    for(int32_t i = HIST_LEN - 1; i >= 0; i--) {
-        perLen -= histgram[i];
+    for(int32_t i = 64; i >= 0; i--) {
+        perLen -= histogram[i];
         if (perLen < 0) {
-            return decodeBitWidth(static_cast<uint32_t>(i));
+            return getClosestFixedBits(static_cast<uint32_t>(i));
         }
     }
     return 0;
 }
 
+/**
+ * What determineEncoding needs to know about the literals, gathered in a
+ * single pass.
+ */
+struct LiteralStatistics {
+    int64_t min;
+    int64_t max;
+    int64_t initialDelta;
+    int64_t lastDelta;
+    int64_t deltaMax;
+    // the bitwise or of the zigzag literals, which has the bit length of
+    // the largest
+    uint64_t zigzagBits;
+    bool isIncreasing;
+    bool isDecreasing;
+    bool isFixedDelta;
+};
+
+/**
+ * Compute the zigzag literals, the adjacent deltas and the statistics of
+ * both in one pass. The loop has no branches, so the compiler can
+ * vectorize it. SIGNED picks whether the literals are zigzag encoded.
+ */
+template <bool SIGNED>
+static void scanLiterals(const int64_t* literals, size_t numLiterals,
+                         int64_t* zigzagLiterals, int64_t* adjDeltas,
+                         LiteralStatistics& stats) {
+    const int64_t first = literals[0];
+    const int64_t second = numLiterals > 1 ? literals[1] : first;
+    const int64_t initialDelta = second - first;
+    int64_t min = std::min(first, second);
+    int64_t max = std::max(first, second);
+    int64_t lastDelta = initialDelta;
+    int64_t deltaMax = 0;
+    bool isIncreasing = first <= second;
+    bool isDecreasing = first >= second;
+    bool isFixedDelta = true;
+
+    uint64_t zigzagBits = 0;
+    for (size_t i = 0; i < std::min<size_t>(numLiterals, 2); i++) {
+        zigzagLiterals[i] = SIGNED ? zigZag(literals[i]) : literals[i];
+        zigzagBits |= static_cast<uint64_t>(zigzagLiterals[i]);
+    }
+
+    // the first delta is the only one stored with its sign
+    adjDeltas[0] = initialDelta;
+
+    for (size_t i = 2; i < numLiterals; i++) {
+        const int64_t l1 = literals[i];
+        const int64_t l0 = literals[i - 1];
+        const int64_t zigzag = SIGNED ? zigZag(l1) : l1;
+        zigzagLiterals[i] = zigzag;
+        zigzagBits |= static_cast<uint64_t>(zigzag);
+        min = std::min(min, l1);
+        max = std::max(max, l1);
+
+        lastDelta = l1 - l0;
+        isIncreasing &= (l0 <= l1);
+        isDecreasing &= (l0 >= l1);
+        isFixedDelta &= (lastDelta == initialDelta);
+        adjDeltas[i - 1] = std::abs(lastDelta);
+        deltaMax = std::max(deltaMax, adjDeltas[i - 1]);
+    }
+
+    stats.min = min;
+    stats.max = max;
+    stats.initialDelta = initialDelta;
+    stats.lastDelta = lastDelta;
+    stats.deltaMax = deltaMax;
+    stats.zigzagBits = zigzagBits;
+    stats.isIncreasing = isIncreasing;
+    stats.isDecreasing = isDecreasing;
+    stats.isFixedDelta = isFixedDelta;
+}
+
 RleEncoderV2::RleEncoderV2(std::unique_ptr<BufferedOutputStream> outStream,
                            bool hasSigned, bool alignBitPacking) :
         RleEncoder(std::move(outStream), hasSigned),
@@ -70,6 +136,7 @@ RleEncoderV2::RleEncoderV2(std::unique_ptr<BufferedOutputStream> outStream,
     zigzagLiterals = new int64_t[MAX_LITERAL_SIZE];
     baseRedLiterals = new int64_t[MAX_LITERAL_SIZE];
     adjDeltas = new int64_t[MAX_LITERAL_SIZE];
+    packed = new unsigned char[MAX_LITERAL_SIZE * sizeof(int64_t)];
 }
 
 void RleEncoderV2::write(int64_t val) {
@@ -167,18 +234,6 @@ void RleEncoderV2::write(int64_t val) {
     }
 }
 
-void RleEncoderV2::computeZigZagLiterals(EncodingOption &option) {
-    int64_t zzEncVal = 0;
-    for (size_t i = 0; i < numLiterals; i++) {
-        if (isSigned) {
-            zzEncVal = zigZag(literals[i]);
-        } else {
-            zzEncVal = literals[i];
-        }
-        zigzagLiterals[option.zigzagLiteralsCount++] = zzEncVal;
-    }
-}
-
 void RleEncoderV2::preparePatchedBlob(EncodingOption& option) {
     // mask will be max value beyond which patch will be generated
     int64_t mask = static_cast<int64_t>(static_cast<uint64_t>(1) << option.brBits95p) - 1;
@@ -282,57 +337,34 @@ void RleEncoderV2::preparePatchedBlob(EncodingOption& option) {
 }
 
 void RleEncoderV2::determineEncoding(EncodingOption& option) {
-    // We need to compute zigzag values for DIRECT and PATCHED_BASE encodings,
-    // but not for SHORT_REPEAT or DELTA. So we only perform the zigzag
-    // computation when it's determined to be necessary.
+    // The zigzag literals, the deltas and their statistics come from a
+    // single pass. Only PATCHED_BASE needs a histogram of the bit lengths.
+    LiteralStatistics stats;
+    if (isSigned) {
+        scanLiterals<true>(literals, numLiterals, zigzagLiterals, adjDeltas, stats);
+    } else {
+        scanLiterals<false>(literals, numLiterals, zigzagLiterals, adjDeltas, stats);
+    }
+    option.zzBits100p = getClosestFixedBits(getBitLength(stats.zigzagBits));
 
     // not a big win for shorter runs to determine encoding
     if (numLiterals <= MIN_REPEAT) {
-        // we need to compute zigzag values for DIRECT encoding if we decide to
-        // break early for delta overflows or for shorter runs
-        computeZigZagLiterals(option);
-        option.zzBits100p = percentileBits(zigzagLiterals, 0, numLiterals, 1.0);
         option.encoding = DIRECT;
         return;
     }
 
     // DELTA encoding check
 
-    // for identifying monotonic sequences
-    bool isIncreasing = true;
-    bool isDecreasing = true;
-    option.isFixedDelta = true;
-
-    option.min = literals[0];
-    int64_t max = literals[0];
-    int64_t initialDelta = literals[1] - literals[0];
-    int64_t currDelta = 0;
-    int64_t deltaMax = 0;
-    adjDeltas[option.adjDeltasCount++] = initialDelta;
-
-    for (size_t i = 1; i < numLiterals; i++) {
-        const int64_t l1 = literals[i];
-        const int64_t l0 = literals[i - 1];
-        currDelta = l1 - l0;
-        option.min = std::min(option.min, l1);
-        max = std::max(max, l1);
-
-        isIncreasing &= (l0 <= l1);
-        isDecreasing &= (l0 >= l1);
-
-        option.isFixedDelta &= (currDelta == initialDelta);
-        if (i > 1) {
-            adjDeltas[option.adjDeltasCount++] = std::abs(currDelta);
-            deltaMax = std::max(deltaMax, adjDeltas[i - 1]);
-        }
-    }
+    option.min = stats.min;
+    option.isFixedDelta = stats.isFixedDelta;
+    const int64_t max = stats.max;
+    const int64_t initialDelta = stats.initialDelta;
+    const int64_t currDelta = stats.lastDelta;
 
     // it's faster to exit under delta overflow condition without checking for
     // PATCHED_BASE condition as encoding using DIRECT is faster and has less
     // overhead than PATCHED_BASE
     if (!isSafeSubtract(max, option.min)) {
-        computeZigZagLiterals(option);
-        option.zzBits100p = percentileBits(zigzagLiterals, 0, numLiterals, 1.0);
         option.encoding = DIRECT;
         return;
     }
@@ -372,10 +404,10 @@ void RleEncoderV2::determineEncoding(EncodingOption& option) {
     if (initialDelta != 0) {
         // stores the number of bits required for packing delta blob in
         // delta encoding
-        option.bitsDeltaMax = findClosestNumBits(deltaMax);
+        option.bitsDeltaMax = findClosestNumBits(stats.deltaMax);
 
         // monotonic condition
-        if (isIncreasing || isDecreasing) {
+        if (stats.isIncreasing || stats.isDecreasing) {
             option.encoding = DELTA;
             return;
         }
@@ -388,9 +420,11 @@ void RleEncoderV2::determineEncoding(EncodingOption& option) {
     // beyond a threshold then we need to patch the values. if the variation
     // is not significant then we can use direct encoding
 
-    computeZigZagLiterals(option);
-    option.zzBits100p = percentileBits(zigzagLiterals, 0, numLiterals, 1.0);
-    option.zzBits90p = percentileBits(zigzagLiterals, 0, numLiterals, 0.9, true);
+    uint32_t histogram[65] = {};
+    for (size_t i = 0; i < numLiterals; i++) {
+        histogram[getBitLength(static_cast<uint64_t>(zigzagLiterals[i]))] += 1;
+    }
+    option.zzBits90p = percentileBits(histogram, numLiterals, 0.9);
     uint32_t diffBitsLH = option.zzBits100p - option.zzBits90p;
 
     // if the difference between 90th percentile and 100th percentile fixed
@@ -399,16 +433,18 @@ void RleEncoderV2::determineEncoding(EncodingOption& option) {
 
         // patching is done only on base reduced values.
         // remove base from literals
+        memset(histogram, 0, sizeof(histogram));
         for (size_t i = 0; i < numLiterals; i++) {
-            baseRedLiterals[option.baseRedLiteralsCount++] = (literals[i] - option.min);
+            baseRedLiterals[i] = (literals[i] - option.min);
+            histogram[getBitLength(static_cast<uint64_t>(baseRedLiterals[i]))] += 1;
         }
 
         // 95th percentile width is used to determine max allowed value
         // after which patching will be done
-        option.brBits95p = percentileBits(baseRedLiterals, 0, numLiterals, 0.95);
+        option.brBits95p = percentileBits(histogram, numLiterals, 0.95);
 
         // 100th percentile is used to compute the max patch width
-        option.brBits100p = percentileBits(baseRedLiterals, 0, numLiterals, 1.0, true);
+        option.brBits100p = percentileBits(histogram, numLiterals, 1.0);
 
         // after base reducing the values, if the difference in bits between
         // 95th percentile and 100th percentile value is zero then there
@@ -693,76 +729,9 @@ void RleEncoderV2::writeInts(int64_t* input, uint32_t offset, size_t len, uint32
       return;
   }
 
-  if (getClosestAlignedFixedBits(bitSize) == bitSize) {
-    uint32_t numBytes;
-    uint32_t endOffSet = static_cast<uint32_t>(offset + len);
-    if (bitSize < 8 ) {;
-      char bitMask = static_cast<char>((1 << bitSize) - 1);
-      uint32_t numHops = 8 / bitSize;
-      uint32_t remainder = static_cast<uint32_t>(len % numHops);
-      uint32_t endUnroll = endOffSet - remainder;
-      for (uint32_t i = offset; i < endUnroll; i+=numHops) {
-        char toWrite = 0;
-        for (uint32_t j = 0; j < numHops; ++j) {
-          toWrite |= static_cast<char>((input[i+j] & bitMask) << (8 - (j + 1) * bitSize));
-        }
-        writeByte(toWrite);
-      }
-
-      if (remainder > 0) {
-        uint32_t startShift = 8 - bitSize;
-        char toWrite = 0;
-        for (uint32_t i = endUnroll; i < endOffSet; ++i) {
-          toWrite |= static_cast<char>((input[i] & bitMask) << startShift);
-          startShift -= bitSize;
-        }
-        writeByte(toWrite);
-      }
-
-    } else {
-      numBytes = bitSize / 8;
-
-      for (uint32_t i = offset; i < endOffSet; ++i) {
-        for (uint32_t j = 0; j < numBytes; ++j) {
-          char toWrite = static_cast<char>((input[i] >> (8 * (numBytes - j - 1))) & 255);
-          writeByte(toWrite);
-        }
-      }
-    }
-
-    return;
-  }
-
-  // write for unaligned bit size
-  uint32_t bitsLeft = 8;
-  char current = 0;
-  for(uint32_t i = offset; i < (offset + len); i++) {
-    int64_t value = input[i];
-    uint32_t bitsToWrite = bitSize;
-    while (bitsToWrite > bitsLeft) {
-      // add the bits to the bottom of the current word
-      current |= static_cast<char>(value >> (bitsToWrite - bitsLeft));
-      // subtract out the bits we just added
-      bitsToWrite -= bitsLeft;
-      // zero out the bits above bitsToWrite
-      value &= (static_cast<uint64_t>(1) << bitsToWrite) - 1;
-      writeByte(current);
-      current = 0;
-      bitsLeft = 8;
-    }
-    bitsLeft -= bitsToWrite;
-    current |= static_cast<char>(value << bitsLeft);
-    if (bitsLeft == 0) {
-      writeByte(current);
-      current = 0;
-      bitsLeft = 8;
-    }
-  }
-
-  // flush
-  if (bitsLeft != 8) {
-    writeByte(current);
-  }
+  // len is at most MAX_LITERAL_SIZE, so the packed values fit in packed
+  uint64_t bytes = packBits(input + offset, bitSize, len, packed);
+  writeBytes(reinterpret_cast<const char*>(packed), bytes);
 }
 
 void RleEncoderV2::initializeLiterals(int64_t val) {
@@ -82,6 +82,7 @@ namespace orc {
     uint64_t offset = stripeStart;
     uint64_t dataEnd = stripeInfo.offset() + stripeInfo.indexlength() + stripeInfo.datalength();
     MemoryPool *pool = reader.getFileContents().pool;
+    ReaderMetricsCounters* metrics = reader.getMetricsCounters();
     for(int i = 0; i < footer.streams_size(); ++i) {
       const proto::Stream& stream = footer.streams(i);
       if (stream.has_kind() &&
@@ -97,16 +98,30 @@ namespace orc {
               << stripeInfo.indexlength() << ", stripeDataLength=" << stripeInfo.datalength();
           throw ParseError(msg.str());
         }
+        std::unique_ptr<SeekableInputStream> rawStream;
+        const char* data = input.getData(offset, streamLength);
+        if (data == nullptr) {
+          data = reader.getStripeData(offset, streamLength);
+        }
+        if (data != nullptr) {
+          rawStream.reset(new SeekableArrayInputStream(data, streamLength));
+        } else {
+          rawStream.reset(new SeekableFileInputStream(&input,
+                                                      offset,
+                                                      streamLength,
+                                                      *pool,
+                                                      myBlock,
+                                                      metrics ?
+                                                        metrics->
+                                                        getStreamReads(kind) :
+                                                        nullptr));
+        }
         return createDecompressor(reader.getCompression(),
-                                  std::unique_ptr<SeekableInputStream>
-                                  (new SeekableFileInputStream
-                                   (&input,
-                                    offset,
-                                    stream.length(),
-                                    *pool,
-                                    myBlock)),
+                                  std::move(rawStream),
                                   reader.getCompressionSize(),
-                                  *pool);
+                                  *pool,
+                                  metrics ? metrics->getDecompression(
+                                    reader.getCompression()) : nullptr);
       }
       offset += stream.length();
     }
@@ -125,6 +140,10 @@ namespace orc {
     return reader.getForcedScaleOnHive11Decimal();
   }
 
+  ReaderMetricsCounters* StripeStreamsImpl::getMetricsCounters() const {
+    return reader.getMetricsCounters();
+  }
+
   void StripeInformationImpl::ensureStripeFooterLoaded() const {
     if (stripeFooter.get() == nullptr) {
       std::unique_ptr<SeekableInputStream> pbStream =
@@ -73,6 +73,8 @@ namespace orc {
     bool getThrowOnHive11DecimalOverflow() const override;
 
     int32_t getForcedScaleOnHive11Decimal() const override;
+
+    ReaderMetricsCounters* getMetricsCounters() const override;
   };
 
  /**
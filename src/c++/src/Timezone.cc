@@ -19,6 +19,7 @@
 #include "orc/OrcFile.hh"
 #include "Timezone.hh"
 
+#include <algorithm>
 #include <errno.h>
 #include <map>
 #include <sstream>
@@ -55,6 +56,17 @@ namespace orc {
   static const int64_t SECONDS_PER_400_YEARS =
     SECONDS_PER_DAY * (365 * (300 + 3) + 366 * (100 - 3));
 
+  /**
+   * Add two numbers, saturating at INT64_MIN and INT64_MAX.
+   */
+  static int64_t addSaturated(int64_t left, int64_t right) {
+    int64_t result;
+    if (__builtin_add_overflow(left, right, &result)) {
+      return right < 0 ? INT64_MIN : INT64_MAX;
+    }
+    return result;
+  }
+
   /**
    * Is the given year a leap year?
    */
@@ -237,6 +249,9 @@ namespace orc {
     virtual ~FutureRuleImpl() override;
     bool isDefined() const override;
     const TimezoneVariant& getVariant(int64_t clk) const override;
+    const TimezoneVariant& getVariant(int64_t clk,
+                                      int64_t& rangeStart,
+                                      int64_t& rangeEnd) const override;
     void print(std::ostream& out) const override;
 
     friend class FutureRuleParser;
@@ -255,7 +270,18 @@ namespace orc {
   }
 
   const TimezoneVariant& FutureRuleImpl::getVariant(int64_t clk) const {
+    int64_t rangeStart;
+    int64_t rangeEnd;
+    return getVariant(clk, rangeStart, rangeEnd);
+  }
+
+  const TimezoneVariant& FutureRuleImpl::getVariant(int64_t clk,
+                                                    int64_t& rangeStart,
+                                                    int64_t& rangeEnd
+                                                    ) const {
     if (!hasDst) {
+      rangeStart = INT64_MIN;
+      rangeEnd = INT64_MAX;
       return standard;
     } else {
       int64_t adjusted = clk % SECONDS_PER_400_YEARS;
@@ -263,6 +289,13 @@ namespace orc {
         adjusted += SECONDS_PER_400_YEARS;
       }
       int64_t idx = binarySearch(offsets, adjusted);
+      // the offsets repeat every 400 years; the range is clamped to the
+      // int64_t range for clocks in the first or last cycle
+      size_t next = static_cast<size_t>(idx) + 1;
+      rangeStart = addSaturated(clk,
+                                offsets[static_cast<size_t>(idx)] - adjusted);
+      rangeEnd = addSaturated(clk, (next < offsets.size() ? offsets[next]
+                                    : SECONDS_PER_400_YEARS) - adjusted);
       if (startInStd == (idx % 2 == 0)) {
         return standard;
       } else {
@@ -605,7 +638,14 @@ namespace orc {
       return clk + getVariant(clk).gmtOffset;
     }
 
+    void convertToUTC(int64_t* clks, uint64_t numValues,
+                      const char* notNull) const override;
+
   private:
+    const TimezoneVariant& getVariant(int64_t clk,
+                                      int64_t& rangeStart,
+                                      int64_t& rangeEnd) const;
+
     void parseTimeVariants(const unsigned char* ptr,
                            uint64_t variantOffset,
                            uint64_t variantCount,
@@ -893,6 +933,49 @@ namespace orc {
     }
   }
 
+  const TimezoneVariant& TimezoneImpl::getVariant(int64_t clk,
+                                                  int64_t& rangeStart,
+                                                  int64_t& rangeEnd) const {
+    if (clk > lastTransition) {
+      const TimezoneVariant& result =
+        futureRule->getVariant(clk, rangeStart, rangeEnd);
+      rangeStart = std::max(rangeStart, lastTransition + 1);
+      return result;
+    } else {
+      int64_t transition = binarySearch(transitions, clk);
+      size_t next = static_cast<size_t>(transition + 1);
+      uint64_t idx;
+      if (transition < 0) {
+        idx = ancientVariant;
+        rangeStart = INT64_MIN;
+      } else {
+        idx = currentVariant[static_cast<size_t>(transition)];
+        rangeStart = transitions[static_cast<size_t>(transition)];
+      }
+      rangeEnd = next < transitions.size() ? transitions[next] : INT64_MAX;
+      if (lastTransition != INT64_MAX) {
+        rangeEnd = std::min(rangeEnd, lastTransition + 1);
+      }
+      return variants[idx];
+    }
+  }
+
+  void TimezoneImpl::convertToUTC(int64_t* clks, uint64_t numValues,
+                                  const char* notNull) const {
+    // an empty range, so the first time does a search
+    int64_t rangeStart = 0;
+    int64_t rangeEnd = 0;
+    int64_t gmtOffset = 0;
+    for (uint64_t i = 0; i < numValues; ++i) {
+      if (notNull == nullptr || notNull[i]) {
+        if (clks[i] < rangeStart || clks[i] >= rangeEnd) {
+          gmtOffset = getVariant(clks[i], rangeStart, rangeEnd).gmtOffset;
+        }
+        clks[i] += gmtOffset;
+      }
+    }
+  }
+
   void TimezoneImpl::print(std::ostream& out) const {
     out << "Timezone file: " << filename << "\n";
     out << "  Version: " << version << "\n";
@@ -81,6 +81,19 @@ namespace orc {
      * Convert wall clock time of current timezone to UTC timezone
      */
     virtual int64_t convertToUTC(int64_t clk) const = 0;
+
+    /**
+     * Convert an array of wall clock times to UTC in place, as convertToUTC
+     * does one at a time. Consecutive times almost always share a variant,
+     * so the transitions are only searched again when a time falls outside
+     * the range the previous variant applies to.
+     * @param clks the times to convert
+     * @param numValues the number of times
+     * @param notNull if not null, the times at positions that are false
+     *    are left unchanged
+     */
+    virtual void convertToUTC(int64_t* clks, uint64_t numValues,
+                              const char* notNull) const = 0;
   };
 
   /**
@@ -118,6 +131,14 @@ namespace orc {
     virtual ~FutureRule();
     virtual bool isDefined() const = 0;
     virtual const TimezoneVariant& getVariant(int64_t clk) const = 0;
+
+    /**
+     * Get the variant for the given time along with the range of times
+     * [rangeStart, rangeEnd) around it that have the same variant.
+     */
+    virtual const TimezoneVariant& getVariant(int64_t clk,
+                                              int64_t& rangeStart,
+                                              int64_t& rangeEnd) const = 0;
     virtual void print(std::ostream& out) const = 0;
   };
 
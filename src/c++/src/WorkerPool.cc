@@ -0,0 +1,148 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "WorkerPool.hh"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <memory>
+
+namespace orc {
+
+  /**
+   * The shared state of one parallelFor call. Helpers that are dequeued
+   * after the loop has finished find no iterations left and return, so
+   * the state is reference counted rather than kept on the caller's stack.
+   */
+  struct ParallelLoop {
+    std::function<void(size_t)> task;
+    size_t count;
+    std::atomic<size_t> next;
+    size_t finished;
+    std::exception_ptr error;
+    std::mutex mutex;
+    std::condition_variable cond;
+
+    ParallelLoop(const std::function<void(size_t)>& _task,
+                 size_t _count): task(_task),
+                                 count(_count),
+                                 next(0),
+                                 finished(0) {
+      // PASS
+    }
+
+    // run iterations until there are none left to claim
+    void runIterations() {
+      while (true) {
+        size_t index = next.fetch_add(1);
+        if (index >= count) {
+          return;
+        }
+        std::exception_ptr thrown;
+        try {
+          task(index);
+        } catch (...) {
+          thrown = std::current_exception();
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        if (thrown && !error) {
+          error = thrown;
+        }
+        if (++finished == count) {
+          cond.notify_all();
+        }
+      }
+    }
+  };
+
+  WorkerPool::WorkerPool(uint64_t threadCount): stopping(false) {
+    // reserve first so that a new thread is never left outside the vector
+    threads.reserve(threadCount);
+    try {
+      for (uint64_t i = 0; i < threadCount; ++i) {
+        threads.emplace_back(&WorkerPool::workLoop, this);
+      }
+    } catch (...) {
+      // the threads that did start must be joined before they are destroyed
+      stop();
+      throw;
+    }
+  }
+
+  WorkerPool::~WorkerPool() {
+    stop();
+  }
+
+  void WorkerPool::stop() {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      stopping = true;
+    }
+    cond.notify_all();
+    for (size_t i = 0; i < threads.size(); ++i) {
+      threads[i].join();
+    }
+  }
+
+  void WorkerPool::workLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+      cond.wait(lock, [this]() { return stopping || !queue.empty(); });
+      if (queue.empty()) {
+        return;
+      }
+      std::function<void()> work = std::move(queue.front());
+      queue.pop_front();
+      lock.unlock();
+      work();
+      lock.lock();
+    }
+  }
+
+  void WorkerPool::parallelFor(size_t count,
+                               const std::function<void(size_t)>& task) {
+    if (count == 0) {
+      return;
+    }
+    if (count == 1 || threads.empty()) {
+      for (size_t i = 0; i < count; ++i) {
+        task(i);
+      }
+      return;
+    }
+
+    std::shared_ptr<ParallelLoop> loop =
+      std::make_shared<ParallelLoop>(task, count);
+    size_t helpers = std::min(count - 1, threads.size());
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      for (size_t i = 0; i < helpers; ++i) {
+        queue.push_back([loop]() { loop->runIterations(); });
+      }
+    }
+    cond.notify_all();
+
+    loop->runIterations();
+    std::unique_lock<std::mutex> lock(loop->mutex);
+    loop->cond.wait(lock, [&loop]() { return loop->finished == loop->count; });
+    if (loop->error) {
+      std::rethrow_exception(loop->error);
+    }
+  }
+}
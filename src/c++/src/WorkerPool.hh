@@ -0,0 +1,64 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ORC_WORKER_POOL_HH
+#define ORC_WORKER_POOL_HH
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace orc {
+
+  /**
+   * A fixed set of threads that run the iterations of parallel loops.
+   * Several threads may run loops on the same pool at once.
+   */
+  class WorkerPool {
+  public:
+    explicit WorkerPool(uint64_t threads);
+    ~WorkerPool();
+
+    /**
+     * Call task(0) to task(count - 1) on the pool's threads and on the
+     * calling thread, and return when they have all finished. If any of
+     * them throws, the first exception is rethrown once all are done.
+     */
+    void parallelFor(size_t count, const std::function<void(size_t)>& task);
+
+    uint64_t getThreadCount() const {
+      return threads.size();
+    }
+
+  private:
+    std::vector<std::thread> threads;
+    std::deque<std::function<void()>> queue;
+    bool stopping;
+    std::mutex mutex;
+    std::condition_variable cond;
+
+    void workLoop();
+    // tell the threads to exit once the queue is empty and join them
+    void stop();
+  };
+}
+
+#endif
@@ -21,8 +21,14 @@
 
 #include "ColumnWriter.hh"
 #include "Timezone.hh"
+#include "WorkerPool.hh"
 
+#include <condition_variable>
+#include <deque>
+#include <exception>
 #include <memory>
+#include <mutex>
+#include <thread>
 
 namespace orc {
 
@@ -41,6 +47,8 @@ namespace orc {
     std::set<uint64_t> columnsUseBloomFilter;
     double bloomFilterFalsePositiveProb;
     BloomFilterVersion bloomFilterVersion;
+    uint64_t workerThreads;
+    uint64_t maxStripesInFlight;
 
     WriterOptionsPrivate() :
                             fileVersion(FileVersion::v_0_12()) { // default to Hive_0_12
@@ -56,6 +64,8 @@ namespace orc {
       enableIndex = true;
       bloomFilterFalsePositiveProb = 0.05;
       bloomFilterVersion = UTF8;
+      workerThreads = 0;
+      maxStripesInFlight = 0;
     }
   };
 
@@ -229,12 +239,41 @@ namespace orc {
     return privateBits->bloomFilterVersion;
   }
 
+  WriterOptions& WriterOptions::setWorkerThreads(uint64_t threads) {
+    privateBits->workerThreads = threads;
+    return *this;
+  }
+
+  uint64_t WriterOptions::getWorkerThreads() const {
+    return privateBits->workerThreads;
+  }
+
+  WriterOptions& WriterOptions::setMaxStripesInFlight(uint64_t stripes) {
+    privateBits->maxStripesInFlight = stripes;
+    return *this;
+  }
+
+  uint64_t WriterOptions::getMaxStripesInFlight() const {
+    return privateBits->maxStripesInFlight;
+  }
+
   Writer::~Writer() {
     // PASS
   }
 
   class WriterImpl : public Writer {
   private:
+    /**
+     * A finished stripe waiting for the flush thread.
+     */
+    struct PendingStripe {
+      std::unique_ptr<ColumnWriter> writer;
+      uint64_t rows;
+      uint64_t indexRows;
+    };
+
+    // outlives the column writers that run on it
+    std::unique_ptr<WorkerPool> workerPool;
     std::unique_ptr<ColumnWriter> columnWriter;
     std::unique_ptr<BufferedOutputStream> compressionStream;
     std::unique_ptr<BufferedOutputStream> bufferedStream;
@@ -246,9 +285,18 @@ namespace orc {
     uint64_t currentOffset;
     proto::Footer fileFooter;
     proto::PostScript postScript;
-    proto::StripeInformation stripeInfo;
     proto::Metadata metadata;
 
+    // the state shared with the flush thread, guarded by the mutex
+    std::deque<PendingStripe> pendingStripes;
+    uint64_t stripesInFlight;
+    std::vector<std::unique_ptr<ColumnWriter>> idleWriters;
+    bool stopping;
+    std::exception_ptr flushError;
+    std::mutex mutex;
+    std::condition_variable cond;
+    std::thread flushThread;
+
     static const char* magicId;
     static const WriterId writerId;
 
@@ -258,6 +306,8 @@ namespace orc {
                OutputStream* stream,
                const WriterOptions& options);
 
+    ~WriterImpl() override;
+
     std::unique_ptr<ColumnVectorBatch> createRowBatch(uint64_t size)
                                                             const override;
 
@@ -270,7 +320,14 @@ namespace orc {
   private:
     void init();
     void initStripe();
-    void writeStripe();
+    void finishStripe();
+    void writeStripe(ColumnWriter& writer,
+                     uint64_t rows,
+                     uint64_t pendingIndexRows);
+    void flushLoop();
+    void waitForFlushes();
+    void stopFlushThread();
+    std::unique_ptr<ColumnWriter> buildColumnWriter();
     void writeMetadata();
     void writeFileFooter();
     void writePostscript();
@@ -289,9 +346,14 @@ namespace orc {
                          const WriterOptions& opts) :
                          outStream(stream),
                          options(opts),
-                         type(t) {
+                         type(t),
+                         stripesInFlight(0),
+                         stopping(false) {
     streamsFactory = createStreamsFactory(options, outStream);
-    columnWriter = buildWriter(type, *streamsFactory, options);
+    if (options.getWorkerThreads() > 0) {
+      workerPool.reset(new WorkerPool(options.getWorkerThreads()));
+    }
+    columnWriter = buildColumnWriter();
     stripeRows = totalRows = indexRows = 0;
     currentOffset = 0;
 
@@ -312,6 +374,23 @@ namespace orc {
                                             options.getCompressionBlockSize()));
 
     init();
+
+    if (options.getMaxStripesInFlight() > 0) {
+      flushThread = std::thread(&WriterImpl::flushLoop, this);
+    }
+  }
+
+  WriterImpl::~WriterImpl() {
+    // stripes that are still waiting are dropped since close wasn't called
+    stopFlushThread();
+  }
+
+  std::unique_ptr<ColumnWriter> WriterImpl::buildColumnWriter() {
+    if (workerPool) {
+      return buildParallelWriter(type, *streamsFactory, outStream,
+                                 options, *workerPool);
+    }
+    return buildWriter(type, *streamsFactory, options);
   }
 
   std::unique_ptr<ColumnVectorBatch> WriterImpl::createRowBatch(uint64_t size)
@@ -344,13 +423,22 @@ namespace orc {
     }
 
     if (columnWriter->getEstimatedSize() >= options.getStripeSize()) {
-      writeStripe();
+      finishStripe();
     }
   }
 
   void WriterImpl::close() {
     if (stripeRows > 0) {
-      writeStripe();
+      finishStripe();
+    }
+    if (flushThread.joinable()) {
+      waitForFlushes();
+      stopFlushThread();
+      // each set of column writers has the file stats of its own stripes
+      for (size_t i = 0; i < idleWriters.size(); ++i) {
+        columnWriter->mergeFileStatistics(*idleWriters[i]);
+      }
+      idleWriters.clear();
     }
     writeMetadata();
     writeFileFooter();
@@ -359,6 +447,7 @@ namespace orc {
   }
 
   void WriterImpl::addUserMetadata(const std::string name, const std::string value){
+    std::lock_guard<std::mutex> lock(mutex);
     proto::UserMetadataItem* userMetadataItem = fileFooter.add_metadata();
     userMetadataItem->set_name(name);
     userMetadataItem->set_value(value);
@@ -398,33 +487,112 @@ namespace orc {
   }
 
   void WriterImpl::initStripe() {
-    stripeInfo.set_offset(currentOffset);
-    stripeInfo.set_indexlength(0);
-    stripeInfo.set_datalength(0);
-    stripeInfo.set_footerlength(0);
-    stripeInfo.set_numberofrows(0);
-
     stripeRows = indexRows = 0;
   }
 
-  void WriterImpl::writeStripe() {
-    if (options.getEnableIndex() && indexRows != 0) {
-      columnWriter->createRowIndexEntry();
-      indexRows = 0;
+  void WriterImpl::finishStripe() {
+    if (!flushThread.joinable()) {
+      writeStripe(*columnWriter, stripeRows, indexRows);
+      initStripe();
+      return;
+    }
+
+    std::unique_ptr<ColumnWriter> nextWriter;
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      cond.wait(lock, [this]() {
+        return flushError ||
+          stripesInFlight < options.getMaxStripesInFlight();
+      });
+      if (flushError) {
+        std::rethrow_exception(flushError);
+      }
+      PendingStripe stripe;
+      stripe.writer = std::move(columnWriter);
+      stripe.rows = stripeRows;
+      stripe.indexRows = indexRows;
+      pendingStripes.push_back(std::move(stripe));
+      stripesInFlight += 1;
+      if (!idleWriters.empty()) {
+        nextWriter = std::move(idleWriters.back());
+        idleWriters.pop_back();
+      }
+    }
+    cond.notify_all();
+
+    columnWriter = nextWriter ? std::move(nextWriter) : buildColumnWriter();
+    initStripe();
+  }
+
+  void WriterImpl::flushLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+      cond.wait(lock, [this]() {
+        return stopping || !pendingStripes.empty();
+      });
+      if (stopping) {
+        return;
+      }
+      PendingStripe stripe = std::move(pendingStripes.front());
+      pendingStripes.pop_front();
+      lock.unlock();
+      std::exception_ptr error;
+      try {
+        // after an error the file is unusable, so only recycle the writer
+        if (!flushError) {
+          writeStripe(*stripe.writer, stripe.rows, stripe.indexRows);
+        }
+      } catch (...) {
+        error = std::current_exception();
+      }
+      lock.lock();
+      if (error && !flushError) {
+        flushError = error;
+      }
+      idleWriters.push_back(std::move(stripe.writer));
+      stripesInFlight -= 1;
+      cond.notify_all();
+    }
+  }
+
+  void WriterImpl::waitForFlushes() {
+    std::unique_lock<std::mutex> lock(mutex);
+    cond.wait(lock, [this]() { return stripesInFlight == 0; });
+    if (flushError) {
+      std::rethrow_exception(flushError);
+    }
+  }
+
+  void WriterImpl::stopFlushThread() {
+    if (flushThread.joinable()) {
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+      }
+      cond.notify_all();
+      flushThread.join();
+    }
+  }
+
+  void WriterImpl::writeStripe(ColumnWriter& writer,
+                               uint64_t rows,
+                               uint64_t pendingIndexRows) {
+    if (options.getEnableIndex() && pendingIndexRows != 0) {
+      writer.createRowIndexEntry();
     } else {
-      columnWriter->mergeRowGroupStatsIntoStripeStats();
+      writer.mergeRowGroupStatsIntoStripeStats();
     }
 
     // dictionary should be written before any stream is flushed
-    columnWriter->writeDictionary();
+    writer.writeDictionary();
 
     std::vector<proto::Stream> streams;
     // write ROW_INDEX streams
     if (options.getEnableIndex()) {
-      columnWriter->writeIndex(streams);
+      writer.writeIndex(streams);
     }
     // write streams like PRESENT, DATA, etc.
-    columnWriter->flush(streams);
+    writer.flush(streams);
 
     // generate and write stripe footer
     proto::StripeFooter stripeFooter;
@@ -433,7 +601,7 @@ namespace orc {
     }
 
     std::vector<proto::ColumnEncoding> encodings;
-    columnWriter->getColumnEncoding(encodings);
+    writer.getColumnEncoding(encodings);
 
     for (uint32_t i = 0; i < encodings.size(); ++i) {
       *stripeFooter.add_columns() = encodings[i];
@@ -446,12 +614,12 @@ namespace orc {
     // add stripe statistics to metadata
     proto::StripeStatistics* stripeStats = metadata.add_stripestats();
     std::vector<proto::ColumnStatistics> colStats;
-    columnWriter->getStripeStatistics(colStats);
+    writer.getStripeStatistics(colStats);
     for (uint32_t i = 0; i != colStats.size(); ++i) {
       *stripeStats->add_colstats() = colStats[i];
     }
     // merge stripe stats into file stats and clear stripe stats
-    columnWriter->mergeStripeStatsIntoFileStats();
+    writer.mergeStripeStatsIntoFileStats();
 
     if (!stripeFooter.SerializeToZeroCopyStream(compressionStream.get())) {
       throw std::logic_error("Failed to write stripe footer.");
@@ -471,19 +639,22 @@ namespace orc {
     }
 
     // update stripe info
+    proto::StripeInformation stripeInfo;
+    stripeInfo.set_offset(currentOffset);
     stripeInfo.set_indexlength(indexLength);
     stripeInfo.set_datalength(dataLength);
     stripeInfo.set_footerlength(footerLength);
-    stripeInfo.set_numberofrows(stripeRows);
+    stripeInfo.set_numberofrows(rows);
 
-    *fileFooter.add_stripes() = stripeInfo;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      *fileFooter.add_stripes() = stripeInfo;
+    }
 
     currentOffset = currentOffset + indexLength + dataLength + footerLength;
-    totalRows += stripeRows;
-
-    columnWriter->reset();
+    totalRows += rows;
 
-    initStripe();
+    writer.reset();
   }
 
   void WriterImpl::writeMetadata() {
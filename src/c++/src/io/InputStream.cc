@@ -137,14 +137,16 @@ namespace orc {
                                                    uint64_t offset,
                                                    uint64_t byteCount,
                                                    MemoryPool& _pool,
-                                                   uint64_t _blockSize
+                                                   uint64_t _blockSize,
+                                                   StreamReadMetrics* _metrics
                                                    ):pool(_pool),
                                                      input(stream),
                                                      start(offset),
                                                      length(byteCount),
                                                      blockSize(computeBlock
                                                                (_blockSize,
-                                                                length)) {
+                                                                length)),
+                                                     metrics(_metrics) {
 
     position = 0;
     buffer.reset(new DataBuffer<char>(pool));
@@ -166,6 +168,10 @@ namespace orc {
       if (bytesRead > 0) {
         input->read(buffer->data(), bytesRead, start+position);
         *data = static_cast<void*>(buffer->data());
+        if (metrics) {
+          metrics->readCalls += 1;
+          metrics->bytesRead += bytesRead;
+        }
       }
     }
     position += bytesRead;
@@ -219,4 +225,29 @@ namespace orc {
     return result.str();
   }
 
+  std::vector<ReadRange> coalesceReadRanges(std::vector<ReadRange> ranges,
+                                            uint64_t maxGap) {
+    std::sort(ranges.begin(), ranges.end(),
+              [](const ReadRange& left, const ReadRange& right) {
+                return left.offset < right.offset;
+              });
+    std::vector<ReadRange> result;
+    for (const ReadRange& range : ranges) {
+      if (range.length == 0) {
+        continue;
+      }
+      if (!result.empty()) {
+        ReadRange& last = result.back();
+        uint64_t lastEnd = last.offset + last.length;
+        if (range.offset <= lastEnd || range.offset - lastEnd <= maxGap) {
+          last.length = std::max(lastEnd, range.offset + range.length) -
+            last.offset;
+          continue;
+        }
+      }
+      result.push_back(range);
+    }
+    return result;
+  }
+
 }
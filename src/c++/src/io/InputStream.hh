@@ -94,13 +94,16 @@ namespace orc {
     std::unique_ptr<DataBuffer<char> > buffer;
     uint64_t position;
     uint64_t pushBack;
+    // where the reads are counted, if anywhere
+    StreamReadMetrics* const metrics;
 
   public:
     SeekableFileInputStream(InputStream* input,
                             uint64_t offset,
                             uint64_t byteCount,
                             MemoryPool& pool,
-                            uint64_t blockSize = 0);
+                            uint64_t blockSize = 0,
+                            StreamReadMetrics* metrics = nullptr);
     virtual ~SeekableFileInputStream() override;
 
     virtual bool Next(const void** data, int*size) override;
@@ -111,6 +114,21 @@ namespace orc {
     virtual std::string getName() const override;
   };
 
+  /**
+   * A range of bytes in a file.
+   */
+  struct ReadRange {
+    uint64_t offset;
+    uint64_t length;
+  };
+
+  /**
+   * Sort the ranges by offset and merge the ones that overlap or are at
+   * most maxGap bytes apart, so they can be read with a single read each.
+   */
+  std::vector<ReadRange> coalesceReadRanges(std::vector<ReadRange> ranges,
+                                            uint64_t maxGap);
+
 }
 
 #endif //ORC_INPUTSTREAM_HH
@@ -62,12 +62,14 @@ namespace orc {
     // init state of each row group
     uint64_t groupsInStripe =
       (rowsInStripe + mRowIndexStride - 1) / mRowIndexStride;
-    mRowGroups.resize(groupsInStripe, true);
+    mRowGroups.assign(groupsInStripe, true);
     mTotalRowsInStripe = rowsInStripe;
+    mHasSelected = groupsInStripe > 0;
+    mHasSkipped = false;
 
     // row indexes do not exist, simply read all rows
     if (rowIndexes.empty()) {
-      return true;
+      return mHasSelected;
     }
 
     const auto& leaves =
@@ -80,7 +82,9 @@ namespace orc {
       for (size_t pred = 0; pred != leaves.size(); ++pred) {
         uint64_t columnIdx = mFilterColumns[pred];
         auto rowIndexIter = rowIndexes.find(columnIdx);
-        if (columnIdx == INVALID_COLUMN_ID || rowIndexIter == rowIndexes.cend()) {
+        if (columnIdx == INVALID_COLUMN_ID ||
+            rowIndexIter == rowIndexes.cend() ||
+            static_cast<int>(rowGroup) >= rowIndexIter->second.entry_size()) {
           // this column does not exist in current file
           leafValues[pred] = TruthValue::YES_NO_NULL;
         } else {
@@ -91,8 +95,9 @@ namespace orc {
           // get bloom filter
           std::shared_ptr<BloomFilter> bloomFilter;
           auto iter = bloomFilters.find(static_cast<uint32_t>(columnIdx));
-          if (iter != bloomFilters.cend()) {
-            bloomFilter = iter->second.entries.at(rowGroup);
+          if (iter != bloomFilters.cend() &&
+              rowGroup < iter->second.entries.size()) {
+            bloomFilter = iter->second.entries[rowGroup];
           }
 
           leafValues[pred] = leaves[pred].evaluate(mWriterVersion,
@@ -109,4 +114,37 @@ namespace orc {
     return mHasSelected;
   }
 
+  bool SargsApplier::evaluateColumnStatistics(
+      const google::protobuf::RepeatedPtrField<proto::ColumnStatistics>&
+        colStats) const {
+    const auto& leaves =
+      dynamic_cast<const SearchArgumentImpl *>(mSearchArgument)->getLeaves();
+    std::vector<TruthValue> leafValues(
+      leaves.size(), TruthValue::YES_NO_NULL);
+    for (size_t pred = 0; pred != leaves.size(); ++pred) {
+      uint64_t columnIdx = mFilterColumns[pred];
+      if (columnIdx != INVALID_COLUMN_ID &&
+          columnIdx < static_cast<uint64_t>(colStats.size())) {
+        leafValues[pred] = leaves[pred].evaluate(
+          mWriterVersion, colStats.Get(static_cast<int>(columnIdx)), nullptr);
+      }
+    }
+    return isNeeded(mSearchArgument->evaluate(leafValues));
+  }
+
+  bool SargsApplier::evaluateStripeStatistics(
+                            const proto::StripeStatistics& stripeStats) {
+    if (stripeStats.colstats_size() == 0) {
+      return true;
+    }
+    return evaluateColumnStatistics(stripeStats.colstats());
+  }
+
+  bool SargsApplier::evaluateFileStatistics(const proto::Footer& footer) {
+    if (footer.statistics_size() == 0) {
+      return true;
+    }
+    return evaluateColumnStatistics(footer.statistics());
+  }
+
 }
@@ -47,6 +47,26 @@ namespace orc {
                       const std::unordered_map<uint64_t, proto::RowIndex>& rowIndexes,
                       const std::map<uint32_t, BloomFilterIndex>& bloomFilters);
 
+    /**
+     * Evaluate the search argument on the statistics of a whole stripe.
+     * @return false if no row of the stripe can match
+     */
+    bool evaluateStripeStatistics(const proto::StripeStatistics& stripeStats);
+
+    /**
+     * Evaluate the search argument on the statistics of the whole file.
+     * @return false if no row of the file can match
+     */
+    bool evaluateFileStatistics(const proto::Footer& footer);
+
+    /**
+     * The column ids the predicate leaves refer to, INVALID_COLUMN_ID for
+     * the ones that are not in the file.
+     */
+    const std::vector<uint64_t>& getFilterColumns() const {
+      return mFilterColumns;
+    }
+
     /**
      * Return a vector of bool for each row group for their selection
      * in the last evaluation
@@ -80,6 +100,10 @@ namespace orc {
     friend class TestSargsApplier_findColumnTest_Test;
     static uint64_t findColumn(const Type& type, const std::string& colName);
 
+    bool evaluateColumnStatistics(
+      const google::protobuf::RepeatedPtrField<proto::ColumnStatistics>&
+        colStats) const;
+
   private:
     const Type& mType;
     const SearchArgument * mSearchArgument;
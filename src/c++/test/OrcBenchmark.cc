@@ -0,0 +1,730 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Adaptor.hh"
+#include "ByteRLE.hh"
+#include "Compression.hh"
+#include "MemoryInputStream.hh"
+#include "MemoryOutputStream.hh"
+#include "NumberFormat.hh"
+#include "RLE.hh"
+#include "orc/ColumnPrinter.hh"
+#include "orc/OrcFile.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+/**
+ * Microbenchmarks for the RLE decoders, the codecs, the number formatting
+ * and the column printers, and an end-to-end conversion of an ORC file to
+ * JSON. The data
+ * is generated from a fixed seed, so runs are comparable. Each result is
+ * printed as a line of JSON with the rows and bytes produced per second:
+ * decoded values, compressed or decompressed bytes, or printed text.
+ * Usage: orc-bench [--time=<seconds>] [<name filter>]
+ */
+
+static double minSeconds = 0.5;
+static std::string nameFilter;
+
+static bool isSelected(const std::string& name) {
+  return name.find(nameFilter) != std::string::npos;
+}
+
+/**
+ * Run the function until at least minSeconds have passed and print the
+ * rate. Each call produces the given rows and bytes.
+ */
+template <typename Function>
+void run(const std::string& name, uint64_t rows, uint64_t bytes,
+         Function function) {
+  if (!isSelected(name)) {
+    return;
+  }
+  function();  // warm up
+  uint64_t iterations = 0;
+  double seconds = 0;
+  auto start = std::chrono::steady_clock::now();
+  do {
+    function();
+    iterations += 1;
+    seconds = std::chrono::duration<double>(
+      std::chrono::steady_clock::now() - start).count();
+  } while (seconds < minSeconds);
+  std::cout << "{\"name\": \"" << name << "\""
+            << ", \"iterations\": " << iterations
+            << ", \"seconds\": " << seconds
+            << ", \"rows\": " << rows * iterations
+            << ", \"bytes\": " << bytes * iterations
+            << ", \"rowsPerSecond\": "
+            << static_cast<uint64_t>(static_cast<double>(rows * iterations) /
+                                     seconds)
+            << ", \"bytesPerSecond\": "
+            << static_cast<uint64_t>(static_cast<double>(bytes * iterations) /
+                                     seconds)
+            << "}" << std::endl;
+}
+
+/**
+ * Fills batches of any type with values drawn from a fixed seed. It owns
+ * the strings that the batches point to.
+ */
+class BatchGenerator {
+public:
+  BatchGenerator(): random(1) {
+    // PASS
+  }
+
+  uint64_t next(uint64_t limit) {
+    return random() % limit;
+  }
+
+  void fill(const orc::Type& type, orc::ColumnVectorBatch& batch,
+            uint64_t rows, bool withNulls);
+
+private:
+  std::mt19937_64 random;
+  std::deque<std::string> strings;
+
+  char* addString(std::string value, int64_t& length) {
+    length = static_cast<int64_t>(value.size());
+    strings.push_back(std::move(value));
+    return const_cast<char*>(strings.back().data());
+  }
+
+  std::string nextString(uint64_t maxLength);
+};
+
+std::string BatchGenerator::nextString(uint64_t maxLength) {
+  static const char* const WORDS[] = {
+    "alpha", "bravo", "charlie", "delta", "echo", "foxtrot", "golf",
+    "hotel", "india", "juliett", "kilo", "lima", "mike", "november"
+  };
+  std::string result = WORDS[next(14)];
+  result += '-';
+  result += std::to_string(next(100000));
+  switch (next(50)) {
+  case 0:
+    result += " \"quoted\"";
+    break;
+  case 1:
+    result += "\ttab\nline";
+    break;
+  default:
+    break;
+  }
+  if (result.size() > maxLength) {
+    result.resize(maxLength);
+  }
+  return result;
+}
+
+void BatchGenerator::fill(const orc::Type& type,
+                          orc::ColumnVectorBatch& batch,
+                          uint64_t rows, bool withNulls) {
+  batch.resize(rows);
+  batch.numElements = rows;
+  batch.hasNulls = false;
+  for (uint64_t i = 0; i < rows; ++i) {
+    batch.notNull[i] = !withNulls || next(20) != 0;
+    batch.hasNulls = batch.hasNulls || !batch.notNull[i];
+  }
+  switch (static_cast<int64_t>(type.getKind())) {
+  case orc::BOOLEAN:
+  case orc::BYTE:
+  case orc::SHORT:
+  case orc::INT:
+  case orc::LONG:
+  case orc::DATE: {
+    static const int WIDTHS[] = {1, 8, 16, 32, 64, 0, 0, 0, 0, 0, 0, 0,
+                                 0, 0, 0, 15};
+    int width = WIDTHS[type.getKind()];
+    int64_t* data = dynamic_cast<orc::LongVectorBatch&>(batch).data.data();
+    for (uint64_t i = 0; i < rows; ++i) {
+      uint64_t value = random();
+      if (width == 64) {
+        data[i] = static_cast<int64_t>(value) >> next(64);
+      } else {
+        data[i] = static_cast<int64_t>(value >> (64 - width)) -
+          (type.getKind() == orc::BOOLEAN ? 0 : int64_t(1) << (width - 1));
+      }
+    }
+    break;
+  }
+  case orc::FLOAT:
+  case orc::DOUBLE: {
+    double* data = dynamic_cast<orc::DoubleVectorBatch&>(batch).data.data();
+    for (uint64_t i = 0; i < rows; ++i) {
+      data[i] = static_cast<double>(next(100000000)) /
+        static_cast<double>(1 + next(10000));
+      if (type.getKind() == orc::FLOAT) {
+        data[i] = static_cast<float>(data[i]);
+      }
+    }
+    break;
+  }
+  case orc::STRING:
+  case orc::VARCHAR:
+  case orc::CHAR:
+  case orc::BINARY: {
+    orc::StringVectorBatch& strs =
+      dynamic_cast<orc::StringVectorBatch&>(batch);
+    uint64_t maxLength = type.getKind() == orc::STRING ||
+      type.getKind() == orc::BINARY ? 1000 : type.getMaximumLength();
+    for (uint64_t i = 0; i < rows; ++i) {
+      std::string value = nextString(maxLength);
+      if (type.getKind() == orc::BINARY) {
+        for (char& ch : value) {
+          ch = static_cast<char>(random());
+        }
+      } else if (type.getKind() == orc::CHAR) {
+        value.resize(maxLength, ' ');
+      }
+      strs.data[i] = addString(std::move(value), strs.length[i]);
+    }
+    break;
+  }
+  case orc::TIMESTAMP: {
+    orc::TimestampVectorBatch& ts =
+      dynamic_cast<orc::TimestampVectorBatch&>(batch);
+    for (uint64_t i = 0; i < rows; ++i) {
+      ts.data[i] = static_cast<int64_t>(next(2000000000));
+      ts.nanoseconds[i] =
+        next(4) == 0 ? 0 : static_cast<int64_t>(next(1000000000));
+    }
+    break;
+  }
+  case orc::DECIMAL: {
+    if (type.getPrecision() == 0 || type.getPrecision() > 18) {
+      orc::Decimal128VectorBatch& decimals =
+        dynamic_cast<orc::Decimal128VectorBatch&>(batch);
+      decimals.precision = static_cast<int32_t>(type.getPrecision());
+      decimals.scale = static_cast<int32_t>(type.getScale());
+      for (uint64_t i = 0; i < rows; ++i) {
+        decimals.values[i] = orc::Int128(static_cast<int64_t>(random()));
+        decimals.values[i] *=
+          orc::Int128(static_cast<int64_t>(next(1000000000)));
+      }
+    } else {
+      orc::Decimal64VectorBatch& decimals =
+        dynamic_cast<orc::Decimal64VectorBatch&>(batch);
+      decimals.precision = static_cast<int32_t>(type.getPrecision());
+      decimals.scale = static_cast<int32_t>(type.getScale());
+      int64_t limit = 1;
+      for (uint64_t i = 0; i < type.getPrecision(); ++i) {
+        limit *= 10;
+      }
+      for (uint64_t i = 0; i < rows; ++i) {
+        decimals.values[i] = static_cast<int64_t>(
+          next(static_cast<uint64_t>(2 * limit - 1))) - (limit - 1);
+      }
+    }
+    break;
+  }
+  case orc::LIST:
+  case orc::MAP: {
+    orc::ListVectorBatch* lists = dynamic_cast<orc::ListVectorBatch*>(&batch);
+    orc::MapVectorBatch* maps = dynamic_cast<orc::MapVectorBatch*>(&batch);
+    int64_t* offsets = lists ? lists->offsets.data() : maps->offsets.data();
+    offsets[0] = 0;
+    for (uint64_t i = 0; i < rows; ++i) {
+      offsets[i + 1] = offsets[i] +
+        (batch.notNull[i] ? static_cast<int64_t>(next(5)) : 0);
+    }
+    uint64_t children = static_cast<uint64_t>(offsets[rows]);
+    if (lists) {
+      fill(*type.getSubtype(0), *lists->elements, children, true);
+    } else {
+      fill(*type.getSubtype(0), *maps->keys, children, false);
+      fill(*type.getSubtype(1), *maps->elements, children, true);
+    }
+    break;
+  }
+  case orc::STRUCT: {
+    orc::StructVectorBatch& structs =
+      dynamic_cast<orc::StructVectorBatch&>(batch);
+    for (uint64_t i = 0; i < type.getSubtypeCount(); ++i) {
+      fill(*type.getSubtype(i), *structs.fields[i], rows, withNulls);
+    }
+    break;
+  }
+  case orc::UNION: {
+    orc::UnionVectorBatch& unions =
+      dynamic_cast<orc::UnionVectorBatch&>(batch);
+    std::vector<uint64_t> counts(type.getSubtypeCount(), 0);
+    for (uint64_t i = 0; i < rows; ++i) {
+      unsigned char tag =
+        static_cast<unsigned char>(next(type.getSubtypeCount()));
+      unions.tags[i] = tag;
+      unions.offsets[i] = counts[tag];
+      counts[tag] += batch.notNull[i] ? 1 : 0;
+    }
+    for (uint64_t i = 0; i < type.getSubtypeCount(); ++i) {
+      fill(*type.getSubtype(i), *unions.children[i], counts[i], false);
+    }
+    break;
+  }
+  default:
+    throw std::logic_error("Can't generate " + type.toString());
+  }
+}
+
+static std::vector<char> encodeLongs(const std::vector<int64_t>& values,
+                                     orc::RleVersion version,
+                                     bool isSigned) {
+  orc::MemoryPool& pool = *orc::getDefaultPool();
+  orc::MemoryOutputStream output(
+    static_cast<ssize_t>(values.size() * 10 + 1024));
+  std::unique_ptr<orc::RleEncoder> encoder = orc::createRleEncoder(
+    std::unique_ptr<orc::BufferedOutputStream>(
+      new orc::BufferedOutputStream(pool, &output, 1024 * 1024, 64 * 1024)),
+    isSigned, version, pool, false);
+  encoder->add(values.data(), values.size(), nullptr);
+  encoder->flush();
+  return std::vector<char>(output.getData(),
+                           output.getData() + output.getLength());
+}
+
+static void benchmarkRle() {
+  const uint64_t count = 1 << 20;
+  std::mt19937_64 random(1);
+  std::vector<std::pair<std::string, std::vector<int64_t>>> inputs;
+
+  // runs of equal values; RLEv2 writes the short ones as SHORT_REPEAT
+  std::vector<int64_t> values(count);
+  for (uint64_t i = 0; i < count; ) {
+    int64_t value = static_cast<int64_t>(random() % 65536);
+    uint64_t length = std::min<uint64_t>(3 + random() % 8, count - i);
+    std::fill(values.begin() + static_cast<int64_t>(i),
+              values.begin() + static_cast<int64_t>(i + length), value);
+    i += length;
+  }
+  inputs.push_back(std::make_pair("short_repeat", values));
+
+  // arithmetic sequences become DELTA runs with a fixed delta
+  for (uint64_t i = 0; i < count; ++i) {
+    values[i] = static_cast<int64_t>(1000 + 7 * (i % 512));
+  }
+  inputs.push_back(std::make_pair("fixed_delta", values));
+
+  // increasing values with varying steps become DELTA runs with widths
+  values[0] = 0;
+  for (uint64_t i = 1; i < count; ++i) {
+    values[i] = values[i - 1] + static_cast<int64_t>(random() % 1000);
+  }
+  inputs.push_back(std::make_pair("varying_delta", values));
+
+  // small values with a few large outliers become PATCHED_BASE
+  for (uint64_t i = 0; i < count; ++i) {
+    values[i] = static_cast<int64_t>(random() % 200 == 0 ?
+                                     random() >> 24 : random() % 256);
+  }
+  inputs.push_back(std::make_pair("patched_base", values));
+
+  // random values of each width become DIRECT
+  for (uint32_t width : {1, 2, 4, 8, 12, 16, 20, 24, 32, 40, 48, 56, 64}) {
+    for (uint64_t i = 0; i < count; ++i) {
+      values[i] = static_cast<int64_t>(random() >> (64 - width));
+    }
+    inputs.push_back(std::make_pair("direct/" + std::to_string(width),
+                                    values));
+  }
+
+  std::vector<int64_t> output(1024);
+  for (orc::RleVersion version : {orc::RleVersion_1, orc::RleVersion_2}) {
+    std::string prefix = version == orc::RleVersion_1 ? "rle1/" : "rle2/";
+    for (const auto& input : inputs) {
+      std::string name = prefix + input.first;
+      if (!isSelected(name)) {
+        continue;
+      }
+      std::vector<char> encoded = encodeLongs(input.second, version, false);
+      run(name, count, count * sizeof(int64_t), [&]() {
+          std::unique_ptr<orc::RleDecoder> decoder = orc::createRleDecoder(
+            std::unique_ptr<orc::SeekableInputStream>(
+              new orc::SeekableArrayInputStream(encoded.data(),
+                                                encoded.size())),
+            false, version, *orc::getDefaultPool());
+          for (uint64_t i = 0; i < count; i += output.size()) {
+            decoder->next(output.data(), output.size(), nullptr);
+          }
+        });
+    }
+  }
+}
+
+static void benchmarkByteRle() {
+  const uint64_t count = 1 << 22;
+  std::mt19937_64 random(1);
+  std::vector<std::pair<std::string, std::vector<char>>> inputs;
+  std::vector<char> values(count);
+  for (uint64_t i = 0; i < count; ++i) {
+    values[i] = static_cast<char>(random());
+  }
+  inputs.push_back(std::make_pair("byte/literals", values));
+  for (uint64_t i = 0; i < count; ) {
+    char value = static_cast<char>(random());
+    uint64_t length = std::min<uint64_t>(3 + random() % 100, count - i);
+    memset(values.data() + i, value, length);
+    i += length;
+  }
+  inputs.push_back(std::make_pair("byte/runs", values));
+  for (uint64_t i = 0; i < count; ++i) {
+    values[i] = static_cast<char>(random() % 2);
+  }
+  inputs.push_back(std::make_pair("boolean/random", values));
+  for (uint64_t i = 0; i < count; ++i) {
+    values[i] = random() % 50 != 0;
+  }
+  inputs.push_back(std::make_pair("boolean/mostly_true", values));
+
+  orc::MemoryPool& pool = *orc::getDefaultPool();
+  std::vector<char> output(1024);
+  for (const auto& input : inputs) {
+    std::string name = input.first;
+    if (!isSelected(name)) {
+      continue;
+    }
+    bool isBoolean = name.compare(0, 7, "boolean") == 0;
+    orc::MemoryOutputStream stream(static_cast<ssize_t>(count * 2 + 1024));
+    std::unique_ptr<orc::BufferedOutputStream> buffered(
+      new orc::BufferedOutputStream(pool, &stream, 1024 * 1024, 64 * 1024));
+    std::unique_ptr<orc::ByteRleEncoder> encoder = isBoolean ?
+      orc::createBooleanRleEncoder(std::move(buffered)) :
+      orc::createByteRleEncoder(std::move(buffered));
+    encoder->add(input.second.data(), count, nullptr);
+    encoder->flush();
+    std::vector<char> encoded(stream.getData(),
+                              stream.getData() + stream.getLength());
+    run(name, count, count, [&]() {
+        std::unique_ptr<orc::SeekableInputStream> source(
+          new orc::SeekableArrayInputStream(encoded.data(), encoded.size()));
+        std::unique_ptr<orc::ByteRleDecoder> decoder = isBoolean ?
+          orc::createBooleanRleDecoder(std::move(source)) :
+          orc::createByteRleDecoder(std::move(source));
+        for (uint64_t i = 0; i < count; i += output.size()) {
+          decoder->next(output.data(), output.size(), nullptr);
+        }
+      });
+  }
+}
+
+static std::vector<char> compress(orc::CompressionKind kind,
+                                  const std::string& input,
+                                  uint64_t blockSize) {
+  orc::MemoryOutputStream output(static_cast<ssize_t>(input.size() * 2 +
+                                                      1024));
+  std::unique_ptr<orc::BufferedOutputStream> stream = orc::createCompressor(
+    kind, &output, orc::CompressionStrategy_SPEED, 1024 * 1024, blockSize,
+    *orc::getDefaultPool());
+  size_t position = 0;
+  while (position < input.size()) {
+    void* data;
+    int size;
+    stream->Next(&data, &size);
+    size_t length = std::min<size_t>(static_cast<size_t>(size),
+                                     input.size() - position);
+    memcpy(data, input.data() + position, length);
+    position += length;
+    if (length < static_cast<size_t>(size)) {
+      stream->BackUp(size - static_cast<int>(length));
+    }
+  }
+  stream->flush();
+  return std::vector<char>(output.getData(),
+                           output.getData() + output.getLength());
+}
+
+static std::string printJson(const orc::Type& type, uint64_t rows) {
+  BatchGenerator generator;
+  orc::MemoryPool& pool = *orc::getDefaultPool();
+  std::unique_ptr<orc::ColumnVectorBatch> batch =
+    type.createRowBatch(rows, pool);
+  generator.fill(type, *batch, rows, true);
+  std::string output;
+  std::unique_ptr<orc::ColumnPrinter> printer =
+    orc::createColumnPrinter(output, &type);
+  printer->reset(*batch);
+  printer->printBatch(rows);
+  return output;
+}
+
+static const std::pair<const char*, orc::CompressionKind> blockCodecs[] = {
+  {"zlib", orc::CompressionKind_ZLIB},
+  {"snappy", orc::CompressionKind_SNAPPY},
+  {"lz4", orc::CompressionKind_LZ4},
+  {"zstd", orc::CompressionKind_ZSTD}
+};
+
+static void benchmarkCompression() {
+  const uint64_t blockSize = 256 * 1024;
+  std::unique_ptr<orc::Type> type(orc::Type::buildTypeFromString(
+    "struct<id:bigint,name:string,price:double,created:timestamp>"));
+  std::string input = printJson(*type, 200000);
+  for (const auto& codec : blockCodecs) {
+    std::string name = std::string("compress/") + codec.first;
+    if (!isSelected(name)) {
+      continue;
+    }
+    run(name, 0, input.size(), [&]() {
+        compress(codec.second, input, blockSize);
+      });
+  }
+}
+
+static void benchmarkDecompression() {
+  const uint64_t blockSize = 256 * 1024;
+  std::unique_ptr<orc::Type> type(orc::Type::buildTypeFromString(
+    "struct<id:bigint,name:string,price:double,created:timestamp>"));
+  std::string input = printJson(*type, 200000);
+  for (const auto& codec : blockCodecs) {
+    std::string name = std::string("decompress/") + codec.first;
+    if (!isSelected(name)) {
+      continue;
+    }
+    std::vector<char> compressed = compress(codec.second, input, blockSize);
+    run(name, 0, input.size(), [&]() {
+        std::unique_ptr<orc::SeekableInputStream> stream =
+          orc::createDecompressor(codec.second,
+                                  std::unique_ptr<orc::SeekableInputStream>(
+                                    new orc::SeekableArrayInputStream(
+                                      compressed.data(), compressed.size())),
+                                  blockSize, *orc::getDefaultPool());
+        const void* data;
+        int size;
+        uint64_t total = 0;
+        while (stream->Next(&data, &size)) {
+          total += static_cast<uint64_t>(size);
+        }
+        if (total != input.size()) {
+          throw std::logic_error("Bad decompressed length for " + name);
+        }
+      });
+  }
+}
+
+/**
+ * Compare the number formatting used by the column printers against the
+ * snprintf calls it replaced.
+ */
+static void benchmarkNumberFormat() {
+  const uint64_t count = 1000000;
+  std::mt19937_64 random(1);
+  std::vector<int64_t> longs(count);
+  std::vector<double> doubles(count);
+  for (uint64_t i = 0; i < count; ++i) {
+    longs[i] = static_cast<int64_t>(random()) >> (random() % 64);
+    doubles[i] = static_cast<double>(random() % 100000000) /
+      static_cast<double>(1 + random() % 10000);
+  }
+
+  std::string output;
+  output.reserve(count * 25);
+  auto benchmark = [&](const std::string& name,
+                       const std::function<void(uint64_t)>& format) {
+    if (!isSelected(name)) {
+      return;
+    }
+    auto formatAll = [&]() {
+      output.clear();
+      for (uint64_t i = 0; i < count; ++i) {
+        format(i);
+      }
+    };
+    formatAll();
+    run(name, count, output.size(), formatAll);
+  };
+  auto appendPrintf = [&](const char* pattern, double value) {
+    char buffer[64];
+    int length = snprintf(buffer, sizeof(buffer), pattern, value);
+    output.append(buffer, static_cast<size_t>(length));
+  };
+
+  benchmark("format/int64/snprintf", [&](uint64_t i) {
+      char buffer[64];
+      int length = snprintf(buffer, sizeof(buffer),
+                            "%" INT64_FORMAT_STRING "d", longs[i]);
+      output.append(buffer, static_cast<size_t>(length));
+    });
+  benchmark("format/int64", [&](uint64_t i) {
+      char buffer[orc::MAX_INT64_CHARS];
+      char* end = orc::formatInt64(longs[i], buffer);
+      output.append(buffer, static_cast<size_t>(end - buffer));
+    });
+  benchmark("format/double/snprintf_14g", [&](uint64_t i) {
+      appendPrintf("%.14g", doubles[i]);
+    });
+  benchmark("format/double/snprintf_17g", [&](uint64_t i) {
+      appendPrintf("%.17g", doubles[i]);
+    });
+  benchmark("format/double", [&](uint64_t i) {
+      char buffer[orc::MAX_DOUBLE_CHARS];
+      char* end = orc::formatDouble(doubles[i], buffer);
+      output.append(buffer, static_cast<size_t>(end - buffer));
+    });
+  benchmark("format/float/snprintf_7g", [&](uint64_t i) {
+      appendPrintf("%.7g", doubles[i]);
+    });
+  benchmark("format/float", [&](uint64_t i) {
+      char buffer[orc::MAX_DOUBLE_CHARS];
+      char* end = orc::formatFloat(static_cast<float>(doubles[i]), buffer);
+      output.append(buffer, static_cast<size_t>(end - buffer));
+    });
+}
+
+static void benchmarkPrinters() {
+  const uint64_t rows = 100000;
+  const char* const types[] = {
+    "boolean", "tinyint", "smallint", "int", "bigint", "float", "double",
+    "string", "binary", "timestamp", "date", "decimal(10,2)",
+    "decimal(38,6)", "char(10)", "varchar(20)", "array<int>",
+    "map<string,int>", "struct<a:int,b:string>", "uniontype<int,string>"
+  };
+  orc::MemoryPool& pool = *orc::getDefaultPool();
+  for (const char* typeName : types) {
+    std::unique_ptr<orc::Type> type(
+      orc::Type::buildTypeFromString(typeName));
+    bool isFloating = type->getKind() == orc::FLOAT ||
+      type->getKind() == orc::DOUBLE;
+    for (orc::FloatFormat format : {orc::FloatFormat_FIXED_PRECISION,
+                                    orc::FloatFormat_SHORTEST}) {
+      if (format == orc::FloatFormat_SHORTEST && !isFloating) {
+        continue;
+      }
+      std::string name = std::string("print/") + typeName +
+        (format == orc::FloatFormat_SHORTEST ? "/shortest" : "");
+      if (!isSelected(name)) {
+        continue;
+      }
+      BatchGenerator generator;
+      std::unique_ptr<orc::ColumnVectorBatch> batch =
+        type->createRowBatch(rows, pool);
+      generator.fill(*type, *batch, rows, true);
+      std::string output;
+      std::unique_ptr<orc::ColumnPrinter> printer =
+        orc::createColumnPrinter(output, type.get(), format);
+      printer->reset(*batch);
+      printer->printBatch(rows);
+      uint64_t bytes = output.size();
+      run(name, rows, bytes, [&]() {
+          output.clear();
+          printer->reset(*batch);
+          printer->printBatch(rows);
+        });
+    }
+  }
+}
+
+static void benchmarkConversion() {
+  const uint64_t rows = 200000;
+  const uint64_t writeBatchSize = 10000;
+  std::unique_ptr<orc::Type> type(orc::Type::buildTypeFromString(
+    "struct<id:bigint,flag:boolean,price:double,name:string,"
+    "category:varchar(16),created:timestamp,amount:decimal(12,2),"
+    "tags:array<string>,attrs:map<string,int>>"));
+  const std::pair<const char*, orc::CompressionKind> codecs[] = {
+    {"none", orc::CompressionKind_NONE},
+    {"zlib", orc::CompressionKind_ZLIB},
+    {"snappy", orc::CompressionKind_SNAPPY},
+    {"lz4", orc::CompressionKind_LZ4},
+    {"zstd", orc::CompressionKind_ZSTD}
+  };
+  orc::MemoryPool& pool = *orc::getDefaultPool();
+  for (const auto& codec : codecs) {
+    std::string name = std::string("convert/") + codec.first;
+    if (!isSelected(name)) {
+      continue;
+    }
+    orc::MemoryOutputStream file(256 * 1024 * 1024);
+    orc::WriterOptions writerOpts;
+    writerOpts.setCompression(codec.second);
+    writerOpts.setMemoryPool(&pool);
+    std::unique_ptr<orc::Writer> writer =
+      orc::createWriter(*type, &file, writerOpts);
+    std::unique_ptr<orc::ColumnVectorBatch> batch =
+      writer->createRowBatch(writeBatchSize);
+    BatchGenerator generator;
+    for (uint64_t row = 0; row < rows; row += writeBatchSize) {
+      generator.fill(*type, *batch, writeBatchSize, true);
+      batch->hasNulls = false;
+      writer->add(*batch);
+    }
+    writer->close();
+
+    uint64_t bytes = 0;
+    auto convert = [&]() {
+      orc::ReaderOptions readerOpts;
+      readerOpts.setMemoryPool(pool);
+      std::unique_ptr<orc::Reader> reader = orc::createReader(
+        std::unique_ptr<orc::InputStream>(
+          new orc::MemoryInputStream(file.getData(), file.getLength())),
+        readerOpts);
+      std::unique_ptr<orc::RowReader> rowReader = reader->createRowReader();
+      std::unique_ptr<orc::ColumnVectorBatch> readBatch =
+        rowReader->createRowBatch(1024);
+      std::string output;
+      std::unique_ptr<orc::ColumnPrinter> printer =
+        orc::createColumnPrinter(output, &rowReader->getSelectedType());
+      bytes = 0;
+      while (rowReader->next(*readBatch)) {
+        output.clear();
+        printer->reset(*readBatch);
+        printer->printBatch(readBatch->numElements);
+        bytes += output.size();
+      }
+    };
+    convert();
+    run(name, rows, bytes, convert);
+  }
+}
+
+int main(int argc, char* argv[]) {
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg.compare(0, 7, "--time=") == 0) {
+      minSeconds = atof(arg.c_str() + 7);
+    } else if (arg[0] == '-') {
+      std::cerr << "Usage: orc-bench [--time=<seconds>] [<name filter>]\n";
+      return 1;
+    } else {
+      nameFilter = arg;
+    }
+  }
+  try {
+    benchmarkRle();
+    benchmarkByteRle();
+    benchmarkCompression();
+    benchmarkDecompression();
+    benchmarkNumberFormat();
+    benchmarkPrinters();
+    benchmarkConversion();
+  } catch (std::exception& ex) {
+    std::cerr << "Caught exception: " << ex.what() << "\n";
+    return 1;
+  }
+  return 0;
+}
@@ -17,13 +17,16 @@
  */
 
 #include "Adaptor.hh"
+#include "BitExpand.hh"
 #include "ByteRLE.hh"
 #include "Compression.hh"
 #include "MemoryInputStream.hh"
 #include "MemoryOutputStream.hh"
+#include "CpuInfo.hh"
 #include "OrcTest.hh"
 #include "wrap/gtest-wrapper.h"
 
+#include <algorithm>
 #include <iostream>
 #include <vector>
 
@@ -1511,4 +1514,108 @@ TEST(BooleanRle, seekBoolAndByteRLE) {
 
     delete [] decodedData;
   }
+
+typedef uint64_t (*BitExpander)(const char* input, uint64_t numBits,
+                                char* output);
+
+static void checkBitExpander(BitExpander expand) {
+  std::vector<char> packed(32);
+  for (size_t i = 0; i < packed.size(); ++i) {
+    packed[i] = static_cast<char>(i * 73 + 19);
+  }
+  for (uint64_t numBits = 0; numBits <= packed.size() * 8; ++numBits) {
+    std::vector<char> expected(numBits);
+    uint64_t expectedSet = 0;
+    for (uint64_t i = 0; i < numBits; ++i) {
+      expected[i] = (packed[i / 8] >> (7 - i % 8)) & 1;
+      expectedSet += static_cast<uint64_t>(expected[i]);
+    }
+    std::vector<char> output(numBits);
+    EXPECT_EQ(expectedSet, expand(packed.data(), numBits, output.data()));
+    EXPECT_EQ(expected, output) << "numBits " << numBits;
+
+    // expanding in place
+    std::vector<char> buffer(packed.begin(), packed.end());
+    buffer.resize(std::max<size_t>(numBits, packed.size()));
+    EXPECT_EQ(expectedSet, expand(buffer.data(), numBits, buffer.data()));
+    buffer.resize(numBits);
+    EXPECT_EQ(expected, buffer) << "numBits " << numBits;
+  }
+}
+
+TEST(BitExpand, expandBits) {
+  checkBitExpander(expandBits);
+  checkBitExpander(expandBitsScalar);
+#ifdef HAS_SSE2
+  checkBitExpander(expandBitsSse2);
+#endif
+#ifdef HAS_AVX2
+  if (cpuSupportsAvx2()) {
+    checkBitExpander(expandBitsAvx2);
+  }
+#endif
+}
+
+static void checkByteWidener(void (*widen)(int64_t*, uint64_t)) {
+  for (uint64_t numValues = 0; numValues < 70; ++numValues) {
+    std::vector<int64_t> buffer(numValues);
+    char* bytes = reinterpret_cast<char*>(buffer.data());
+    for (uint64_t i = 0; i < numValues; ++i) {
+      bytes[i] = static_cast<char>(i * 37 + 100);
+    }
+    widen(buffer.data(), numValues);
+    for (uint64_t i = 0; i < numValues; ++i) {
+      EXPECT_EQ(static_cast<char>(i * 37 + 100), buffer[i])
+        << "numValues " << numValues << " value " << i;
+    }
+  }
+}
+
+TEST(BitExpand, expandBytesToLongs) {
+  checkByteWidener(expandBytesToLongs);
+  checkByteWidener(expandBytesToLongsScalar);
+#ifdef HAS_AVX2
+  if (cpuSupportsAvx2()) {
+    checkByteWidener(expandBytesToLongsAvx2);
+  }
+#endif
+}
+
+TEST(BooleanRle, nextCountZerosWithNulls) {
+  // a literal run of 64 bytes
+  std::vector<unsigned char> buffer(1, 0xc0);
+  for (int i = 0; i < 64; ++i) {
+    buffer.push_back(static_cast<unsigned char>(i * 89 + 7));
+  }
+  std::unique_ptr<SeekableInputStream> stream
+    (new SeekableArrayInputStream(buffer.data(), buffer.size(), 11));
+  std::unique_ptr<ByteRleDecoder> rle =
+      createBooleanRleDecoder(std::move(stream));
+
+  const uint64_t numValues = 512;
+  std::vector<char> notNull(numValues);
+  for (uint64_t i = 0; i < numValues; ++i) {
+    notNull[i] = i % 5 != 0;
+  }
+  std::vector<char> data(numValues);
+  uint64_t bit = 0;
+  for (uint64_t start = 0; start < numValues; start += 37) {
+    uint64_t count = std::min<uint64_t>(37, numValues - start);
+    uint64_t expectedZeros = 0;
+    std::vector<char> expected(count);
+    for (uint64_t i = 0; i < count; ++i) {
+      if (notNull[start + i]) {
+        expected[i] = (buffer[1 + bit / 8] >> (7 - bit % 8)) & 1;
+        bit += 1;
+      }
+      expectedZeros += expected[i] ? 0 : 1;
+    }
+    EXPECT_EQ(expectedZeros,
+              rle->nextCountZeros(data.data(), count,
+                                  notNull.data() + start));
+    for (uint64_t i = 0; i < count; ++i) {
+      EXPECT_EQ(expected[i], data[i]) << "Output wrong at " << start + i;
+    }
+  }
+}
 }  // namespace orc
@@ -21,6 +21,16 @@
 #include "orc/Exceptions.hh"
 #include "wrap/gtest-wrapper.h"
 
+#include <errno.h>
+#include <fcntl.h>
+#include <limits>
+#include <stdio.h>
+#include <string.h>
+
+#ifndef _MSC_VER
+#include <unistd.h>
+#endif
+
 namespace orc {
 
   TEST(TestColumnPrinter, BooleanColumnPrinter) {
@@ -247,6 +257,67 @@ namespace orc {
     }
   }
 
+  TEST(TestColumnPrinter, CalendarEdges) {
+    std::string line;
+    std::unique_ptr<Type> type = createPrimitiveType(TIMESTAMP);
+    std::unique_ptr<ColumnPrinter> printer =
+      createColumnPrinter(line, type.get());
+    TimestampVectorBatch batch(1024, *getDefaultPool());
+    batch.numElements = 8;
+    batch.hasNulls = false;
+    batch.data[0] = -1;
+    batch.data[1] = 951868799;
+    batch.data[2] = 951868800;
+    batch.data[3] = 951782400;
+    batch.data[4] = -62135596800;
+    batch.data[5] = -62167305600;
+    batch.data[6] = 253402300800;
+    batch.data[7] = std::numeric_limits<int64_t>::max();
+    batch.nanoseconds[0] = 999999999;
+    batch.nanoseconds[1] = 123456789;
+    batch.nanoseconds[2] = 0;
+    batch.nanoseconds[3] = 500000000;
+    for (size_t i = 4; i < batch.numElements; ++i) {
+      batch.nanoseconds[i] = 0;
+    }
+    const char *expected[] = {"\"1969-12-31 23:59:59.999999999\"",
+                              "\"2000-02-29 23:59:59.123456789\"",
+                              "\"2000-03-01 00:00:00.0\"",
+                              "\"2000-02-29 00:00:00.5\"",
+                              "\"1-01-01 00:00:00.0\"",
+                              "\"-1-12-31 00:00:00.0\"",
+                              "\"10000-01-01 00:00:00.0\"",
+                              "\"0000-00-00 00:00:00\""};
+    printer->reset(batch);
+    for(uint64_t i=0; i < batch.numElements; ++i) {
+      line.clear();
+      printer->printRow(i);
+      EXPECT_EQ(expected[i], line) << "for i = " << i;
+    }
+
+    type = createPrimitiveType(DATE);
+    printer = createColumnPrinter(line, type.get());
+    LongVectorBatch dates(1024, *getDefaultPool());
+    dates.numElements = 5;
+    dates.hasNulls = false;
+    dates.data[0] = 11016;
+    dates.data[1] = 11016;
+    dates.data[2] = -719162;
+    dates.data[3] = 2932897;
+    dates.data[4] = std::numeric_limits<int64_t>::min();
+    const char *expectedDates[] = {"\"2000-02-29\"",
+                                   "\"2000-02-29\"",
+                                   "\"1-01-01\"",
+                                   "\"10000-01-01\"",
+                                   "\"0000-00-00\""};
+    printer->reset(dates);
+    for(uint64_t i=0; i < dates.numElements; ++i) {
+      line.clear();
+      printer->printRow(i);
+      EXPECT_EQ(expectedDates[i], line) << "for i = " << i;
+    }
+  }
+
   TEST(TestColumnPrinter, Decimal64ColumnPrinter) {
     std::string line;
     std::unique_ptr<Type> type = createDecimalType(16, 5);
@@ -392,6 +463,70 @@ namespace orc {
     }
   }
 
+  TEST(TestColumnPrinter, EncodedStringColumnPrinter) {
+    std::string line;
+    std::unique_ptr<Type> type = createPrimitiveType(STRING);
+    std::unique_ptr<ColumnPrinter> printer =
+      createColumnPrinter(line, type.get());
+    EncodedStringVectorBatch batch(1024, *getDefaultPool());
+    std::shared_ptr<StringDictionary> dictionary(
+      new StringDictionary(*getDefaultPool()));
+    const char blob[] = "westeast\"north\"";
+    dictionary->dictionaryBlob.resize(sizeof(blob) - 1);
+    memcpy(dictionary->dictionaryBlob.data(), blob, sizeof(blob) - 1);
+    dictionary->dictionaryOffset.resize(4);
+    dictionary->dictionaryOffset[0] = 0;
+    dictionary->dictionaryOffset[1] = 4;
+    dictionary->dictionaryOffset[2] = 8;
+    dictionary->dictionaryOffset[3] = 15;
+    batch.isEncoded = true;
+    batch.dictionary = dictionary;
+    batch.numElements = 5;
+    batch.hasNulls = true;
+    const int64_t index[] = {2, 0, 7, 1, 0};
+    const char notNull[] = {1, 1, 0, 1, 1};
+    for (size_t i = 0; i < 5; ++i) {
+      batch.index[i] = index[i];
+      batch.notNull[i] = notNull[i];
+    }
+    printer->reset(batch);
+    line.clear();
+    printer->printBatch(batch.numElements);
+    EXPECT_EQ("\"\\\"north\\\"\"\n\"west\"\nnull\n\"east\"\n\"west\"\n", line);
+
+    // a batch with a new dictionary
+    std::shared_ptr<StringDictionary> other(
+      new StringDictionary(*getDefaultPool()));
+    other->dictionaryBlob.resize(1);
+    other->dictionaryBlob[0] = '\n';
+    other->dictionaryOffset.resize(2);
+    other->dictionaryOffset[0] = 0;
+    other->dictionaryOffset[1] = 1;
+    batch.dictionary = other;
+    batch.numElements = 1;
+    batch.hasNulls = false;
+    batch.index[0] = 0;
+    printer->reset(batch);
+    line.clear();
+    printer->printRow(0);
+    EXPECT_EQ("\"\\n\"", line);
+
+    batch.index[0] = 1;
+    EXPECT_THROW(printer->printRow(0), ParseError);
+    batch.index[0] = -1;
+    EXPECT_THROW(printer->printRow(0), ParseError);
+
+    // batches that aren't encoded are printed from the values
+    StringVectorBatch plain(1024, *getDefaultPool());
+    plain.numElements = 1;
+    plain.data[0] = const_cast<char*>(blob);
+    plain.length[0] = 4;
+    printer->reset(plain);
+    line.clear();
+    printer->printRow(0);
+    EXPECT_EQ("\"west\"", line);
+  }
+
   TEST(TestColumnPrinter, BinaryColumnPrinter) {
     std::string line;
     std::unique_ptr<Type> type = createPrimitiveType(BINARY);
@@ -601,4 +736,128 @@ namespace orc {
       }
     }
   }
+
+  TEST(TestColumnPrinter, PrintBatch) {
+    std::string line;
+    std::unique_ptr<Type> type = Type::buildTypeFromString(
+      "struct<a:bigint,b:array<bigint>,c:map<bigint,string>,d:struct<e:double>>");
+    std::unique_ptr<ColumnPrinter> printer =
+      createColumnPrinter(line, type.get());
+    std::unique_ptr<ColumnVectorBatch> root =
+      type->createRowBatch(1024, *getDefaultPool());
+    StructVectorBatch& structBatch = dynamic_cast<StructVectorBatch&>(*root);
+    LongVectorBatch& longBatch =
+      dynamic_cast<LongVectorBatch&>(*structBatch.fields[0]);
+    ListVectorBatch& listBatch =
+      dynamic_cast<ListVectorBatch&>(*structBatch.fields[1]);
+    LongVectorBatch& elements =
+      dynamic_cast<LongVectorBatch&>(*listBatch.elements);
+    MapVectorBatch& mapBatch =
+      dynamic_cast<MapVectorBatch&>(*structBatch.fields[2]);
+    LongVectorBatch& keys = dynamic_cast<LongVectorBatch&>(*mapBatch.keys);
+    StringVectorBatch& values =
+      dynamic_cast<StringVectorBatch&>(*mapBatch.elements);
+    StructVectorBatch& innerBatch =
+      dynamic_cast<StructVectorBatch&>(*structBatch.fields[3]);
+    DoubleVectorBatch& doubleBatch =
+      dynamic_cast<DoubleVectorBatch&>(*innerBatch.fields[0]);
+
+    const char* words[] = {"", "a", "b\"c", "de\nf"};
+    const uint64_t rows = 50;
+    root->numElements = rows;
+    longBatch.hasNulls = true;
+    listBatch.offsets[0] = 0;
+    mapBatch.offsets[0] = 0;
+    innerBatch.hasNulls = true;
+    for (uint64_t i = 0; i < rows; ++i) {
+      longBatch.data[i] = static_cast<int64_t>(i * 1000) - 7;
+      longBatch.notNull[i] = i % 3 != 0;
+      listBatch.offsets[i + 1] = listBatch.offsets[i] + static_cast<int64_t>(i % 4);
+      mapBatch.offsets[i + 1] = mapBatch.offsets[i] + static_cast<int64_t>(i % 3);
+      innerBatch.notNull[i] = i % 5 != 0;
+      doubleBatch.data[i] = static_cast<double>(i) / 4;
+    }
+    for (int64_t i = 0; i < listBatch.offsets[rows]; ++i) {
+      elements.data[i] = -i;
+    }
+    for (int64_t i = 0; i < mapBatch.offsets[rows]; ++i) {
+      keys.data[i] = i;
+      values.data[i] = const_cast<char*>(words[i % 4]);
+      values.length[i] = static_cast<int64_t>(strlen(words[i % 4]));
+    }
+
+    std::string expected;
+    printer->reset(*root);
+    for (uint64_t i = 0; i < rows; ++i) {
+      line.clear();
+      printer->printRow(i);
+      expected += line;
+      expected += "\n";
+    }
+    line.clear();
+    printer->printBatch(rows);
+    EXPECT_EQ(expected, line);
+
+    // rows are appended to whatever is already in the buffer
+    line = "prefix";
+    printer->printBatch(rows);
+    EXPECT_EQ("prefix" + expected, line);
+
+    std::vector<uint64_t> offsets;
+    line.clear();
+    printer->printRows(3, offsets);
+    ASSERT_EQ(4, offsets.size());
+    EXPECT_EQ(0, offsets[0]);
+    EXPECT_EQ(line.size(), offsets[3]);
+  }
+
+#ifndef _MSC_VER
+  TEST(TestColumnPrinter, FileDescriptorSink) {
+    FILE* file = tmpfile();
+    ASSERT_TRUE(file != nullptr);
+    std::string expected;
+    {
+      std::unique_ptr<OutputSink> sink =
+        createFileDescriptorSink(fileno(file), 100);
+      std::string& buffer = sink->getBuffer();
+      for (int i = 0; i < 1000; ++i) {
+        std::string row = "row " + std::to_string(i) + "\n";
+        expected += row;
+        sink->getBuffer().append(row);
+        sink->commit();
+        // printers keep a reference to the buffer
+        EXPECT_EQ(&buffer, &sink->getBuffer());
+        EXPECT_LT(buffer.size(), 100 + row.size());
+      }
+      sink->flush();
+      EXPECT_EQ(0, buffer.size());
+      buffer.append("last\n");
+      expected += "last\n";
+    }
+    std::string written(expected.size() + 1, '\0');
+    ASSERT_EQ(0, fseek(file, 0, SEEK_SET));
+    written.resize(fread(&written[0], 1, written.size(), file));
+    EXPECT_EQ(expected, written);
+    fclose(file);
+  }
+
+  TEST(TestColumnPrinter, FileDescriptorSinkError) {
+    int fd = open("/dev/null", O_RDONLY);
+    ASSERT_NE(-1, fd);
+    std::unique_ptr<OutputSink> sink = createFileDescriptorSink(fd, 10);
+    sink->getBuffer().append("more than ten bytes");
+    sink->commit();
+    try {
+      sink->flush();
+      FAIL() << "flush should have thrown";
+    } catch (std::runtime_error& ex) {
+      EXPECT_NE(std::string::npos,
+                std::string(ex.what()).find(strerror(EBADF)));
+    }
+    sink->getBuffer().append("more than ten bytes");
+    EXPECT_THROW(sink->commit(), std::runtime_error);
+    sink.reset();
+    close(fd);
+  }
+#endif
 }  // namespace orc
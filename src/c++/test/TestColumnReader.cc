@@ -2675,6 +2675,101 @@ TEST(TestColumnReader, testDoubleWithNulls) {
   }
 }
 
+TEST(TestColumnReader, testDoubleAndFloatAcrossBuffers) {
+  MockStripeStreams streams;
+
+  // set getSelectedColumns()
+  std::vector<bool> selectedColumns(3, true);
+  EXPECT_CALL(streams, getSelectedColumns())
+      .WillRepeatedly(testing::Return(selectedColumns));
+
+  // set getEncoding
+  proto::ColumnEncoding directEncoding;
+  directEncoding.set_kind(proto::ColumnEncoding_Kind_DIRECT);
+  EXPECT_CALL(streams, getEncoding(testing::_))
+      .WillRepeatedly(testing::Return(directEncoding));
+
+  // set getStream
+  EXPECT_CALL(streams, getStreamProxy(0, proto::Stream_Kind_PRESENT, true))
+      .WillRepeatedly(testing::Return(nullptr));
+  EXPECT_CALL(streams, getStreamProxy(1, proto::Stream_Kind_PRESENT, true))
+      .WillRepeatedly(testing::Return(nullptr));
+
+  // the float column repeats the pattern 10110110
+  const unsigned char present[] = { 0xfb, 0xb6, 0xb6, 0xb6, 0xb6, 0xb6 };
+  EXPECT_CALL(streams, getStreamProxy(2, proto::Stream_Kind_PRESENT, true))
+      .WillRepeatedly(testing::Return(new SeekableArrayInputStream
+                                      (present, ARRAY_SIZE(present))));
+
+  const size_t numRows = 40;
+  std::vector<double> doubles(numRows);
+  std::vector<float> floats;
+  std::vector<unsigned char> doubleData;
+  std::vector<unsigned char> floatData;
+  for (size_t i = 0; i < numRows; ++i) {
+    doubles[i] = static_cast<double>(i) * 1.5 - 7.25;
+    uint64_t bits;
+    memcpy(&bits, &doubles[i], sizeof(bits));
+    for (size_t j = 0; j < 8; ++j) {
+      doubleData.push_back(static_cast<unsigned char>(bits >> (j * 8)));
+    }
+    if ((0xb6 >> (7 - i % 8)) & 1) {
+      floats.push_back(static_cast<float>(i) * 0.25f - 3.0f);
+      uint32_t floatBits;
+      memcpy(&floatBits, &floats.back(), sizeof(floatBits));
+      for (size_t j = 0; j < 4; ++j) {
+        floatData.push_back(static_cast<unsigned char>(floatBits >> (j * 8)));
+      }
+    }
+  }
+  // small blocks, so values straddle the stream's buffers
+  EXPECT_CALL(streams, getStreamProxy(1, proto::Stream_Kind_DATA, true))
+      .WillRepeatedly(testing::Return(new SeekableArrayInputStream
+                                      (doubleData.data(), doubleData.size(),
+                                       13)));
+  EXPECT_CALL(streams, getStreamProxy(2, proto::Stream_Kind_DATA, true))
+      .WillRepeatedly(testing::Return(new SeekableArrayInputStream
+                                      (floatData.data(), floatData.size(),
+                                       7)));
+
+  // create the row type
+  std::unique_ptr<Type> rowType = createStructType();
+  rowType->addStructField("myDouble", createPrimitiveType(DOUBLE));
+  rowType->addStructField("myFloat", createPrimitiveType(FLOAT));
+
+  std::unique_ptr<ColumnReader> reader =
+      buildReader(*rowType, streams);
+
+  DoubleVectorBatch *doubleBatch = new DoubleVectorBatch(1024,
+                                                         *getDefaultPool());
+  DoubleVectorBatch *floatBatch = new DoubleVectorBatch(1024,
+                                                        *getDefaultPool());
+  StructVectorBatch batch(1024, *getDefaultPool());
+  batch.fields.push_back(doubleBatch);
+  batch.fields.push_back(floatBatch);
+
+  size_t nextFloat = 0;
+  for (size_t start = 0; start < numRows; start += 17) {
+    uint64_t count = std::min<uint64_t>(17, numRows - start);
+    reader->next(batch, count, 0);
+    ASSERT_EQ(count, batch.numElements);
+    ASSERT_EQ(false, doubleBatch->hasNulls);
+    ASSERT_EQ(true, floatBatch->hasNulls);
+    for (size_t i = 0; i < count; ++i) {
+      size_t row = start + i;
+      EXPECT_EQ(doubles[row], doubleBatch->data[i]) << "Wrong value at " << row;
+      bool isPresent = (0xb6 >> (7 - row % 8)) & 1;
+      EXPECT_EQ(isPresent, floatBatch->notNull[i] != 0)
+          << "Wrong value at " << row;
+      if (isPresent) {
+        EXPECT_EQ(static_cast<double>(floats[nextFloat++]),
+                  floatBatch->data[i]) << "Wrong value at " << row;
+      }
+    }
+  }
+  EXPECT_EQ(floats.size(), nextFloat);
+}
+
 TEST(TestColumnReader, testDoubleSkipWithNulls) {
   MockStripeStreams streams;
 
@@ -338,6 +338,54 @@ namespace orc {
     protobuff_compression(CompressionKind_ZSTD, proto::ZSTD);
   }
 
+  TEST(Compression, snappy_compress_original_string) {
+    compress_original_string(CompressionKind_SNAPPY);
+  }
+
+  TEST(Compression, snappy_compress_simple_repeated_string) {
+    compress_simple_repeated_string(CompressionKind_SNAPPY);
+  }
+
+  TEST(Compression, snappy_compress_two_blocks) {
+    compress_two_blocks(CompressionKind_SNAPPY);
+  }
+
+  TEST(Compression, snappy_compress_random_letters) {
+    compress_random_letters(CompressionKind_SNAPPY);
+  }
+
+  TEST(Compression, snappy_compress_random_bytes) {
+    compress_random_bytes(CompressionKind_SNAPPY);
+  }
+
+  TEST(Compression, snappy_protobuff_compression) {
+    protobuff_compression(CompressionKind_SNAPPY, proto::SNAPPY);
+  }
+
+  TEST(Compression, lz4_compress_original_string) {
+    compress_original_string(CompressionKind_LZ4);
+  }
+
+  TEST(Compression, lz4_compress_simple_repeated_string) {
+    compress_simple_repeated_string(CompressionKind_LZ4);
+  }
+
+  TEST(Compression, lz4_compress_two_blocks) {
+    compress_two_blocks(CompressionKind_LZ4);
+  }
+
+  TEST(Compression, lz4_compress_random_letters) {
+    compress_random_letters(CompressionKind_LZ4);
+  }
+
+  TEST(Compression, lz4_compress_random_bytes) {
+    compress_random_bytes(CompressionKind_LZ4);
+  }
+
+  TEST(Compression, lz4_protobuff_compression) {
+    protobuff_compression(CompressionKind_LZ4, proto::LZ4);
+  }
+
   void testSeekDecompressionStream(CompressionKind kind) {
     MemoryOutputStream memStream(DEFAULT_MEM_STREAM_SIZE);
     MemoryPool * pool = getDefaultPool();
@@ -402,5 +450,63 @@ namespace orc {
   TEST(Compression, seekDecompressionStream) {
     testSeekDecompressionStream(CompressionKind_ZSTD);
     testSeekDecompressionStream(CompressionKind_ZLIB);
+    testSeekDecompressionStream(CompressionKind_SNAPPY);
+    testSeekDecompressionStream(CompressionKind_LZ4);
+  }
+
+  void testInterleavedStreams(CompressionKind kind) {
+    MemoryPool * pool = getDefaultPool();
+    uint64_t blockSize = 256;
+    std::vector<char> data[2];
+    MemoryOutputStream memStreams[2] = {
+      MemoryOutputStream(DEFAULT_MEM_STREAM_SIZE),
+      MemoryOutputStream(DEFAULT_MEM_STREAM_SIZE)};
+    std::unique_ptr<AppendOnlyBufferedStream> outStreams[2];
+    for (int i = 0; i < 2; ++i) {
+      data[i].resize(10000);
+      generateRandomData(data[i].data(), data[i].size(), i == 0);
+      // the streams use different levels
+      outStreams[i].reset(new AppendOnlyBufferedStream(createCompressor(
+        kind, &memStreams[i], i == 0 ? CompressionStrategy_SPEED :
+          CompressionStrategy_COMPRESSION, DEFAULT_MEM_STREAM_SIZE,
+        blockSize, *pool)));
+    }
+
+    // the streams take turns with the thread's codec context
+    for (size_t pos = 0; pos < data[0].size(); pos += 100) {
+      for (int i = 0; i < 2; ++i) {
+        outStreams[i]->write(data[i].data() + pos, 100);
+      }
+    }
+    std::unique_ptr<SeekableInputStream> inStreams[2];
+    for (int i = 0; i < 2; ++i) {
+      outStreams[i]->flush();
+      inStreams[i] = createDecompressor(kind,
+        std::unique_ptr<SeekableInputStream>(new SeekableArrayInputStream(
+          memStreams[i].getData(), memStreams[i].getLength())),
+        blockSize, *pool);
+    }
+    std::string results[2];
+    bool isDone[2] = {false, false};
+    while (!isDone[0] || !isDone[1]) {
+      for (int i = 0; i < 2; ++i) {
+        const void* chunk;
+        int size;
+        if (!isDone[i] && inStreams[i]->Next(&chunk, &size)) {
+          results[i].append(static_cast<const char*>(chunk),
+                            static_cast<size_t>(size));
+        } else {
+          isDone[i] = true;
+        }
+      }
+    }
+    for (int i = 0; i < 2; ++i) {
+      EXPECT_EQ(std::string(data[i].data(), data[i].size()), results[i]);
+    }
+  }
+
+  TEST(Compression, interleavedStreams) {
+    testInterleavedStreams(CompressionKind_ZLIB);
+    testInterleavedStreams(CompressionKind_ZSTD);
   }
 }
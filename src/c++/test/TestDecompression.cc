@@ -313,6 +313,37 @@ namespace orc {
     }
   }
 
+  TEST_F(TestDecompression, testCoalesceReadRanges) {
+    std::vector<ReadRange> ranges;
+    ranges.push_back({500, 100});
+    ranges.push_back({0, 100});
+    ranges.push_back({100, 50});
+    ranges.push_back({160, 40});
+    ranges.push_back({620, 0});
+    ranges.push_back({550, 20});
+    ranges.push_back({1000, 10});
+
+    std::vector<ReadRange> merged = coalesceReadRanges(ranges, 10);
+    ASSERT_EQ(3, merged.size());
+    EXPECT_EQ(0, merged[0].offset);
+    EXPECT_EQ(200, merged[0].length);
+    EXPECT_EQ(500, merged[1].offset);
+    EXPECT_EQ(100, merged[1].length);
+    EXPECT_EQ(1000, merged[2].offset);
+    EXPECT_EQ(10, merged[2].length);
+
+    merged = coalesceReadRanges(ranges, 0);
+    ASSERT_EQ(4, merged.size());
+    EXPECT_EQ(150, merged[0].length);
+    EXPECT_EQ(160, merged[1].offset);
+
+    merged = coalesceReadRanges(ranges, 1000);
+    ASSERT_EQ(1, merged.size());
+    EXPECT_EQ(1010, merged[0].length);
+
+    EXPECT_TRUE(coalesceReadRanges(std::vector<ReadRange>(), 10).empty());
+  }
+
   TEST_F(TestDecompression, testCreateNone) {
     std::vector<char> bytes(10);
     for(unsigned int i=0; i < bytes.size(); ++i) {
@@ -400,6 +400,68 @@ namespace orc {
     }
   }
 
+  void testHighCardinalityDictionary(double threshold) {
+    MemoryOutputStream memStream(DEFAULT_MEM_STREAM_SIZE);
+    MemoryPool * pool = getDefaultPool();
+    std::unique_ptr<Type> type(Type::buildTypeFromString("struct<col1:string>"));
+
+    WriterOptions options;
+    options.setStripeSize(16 * 1024 * 1024);
+    options.setCompressionBlockSize(1024);
+    options.setCompression(CompressionKind_ZLIB);
+    options.setMemoryPool(pool);
+    options.setDictionaryKeySizeThreshold(threshold);
+    options.setRowIndexStride(10000);
+    std::unique_ptr<Writer> writer = createWriter(*type, &memStream, options);
+
+    // distinct values share long prefixes and vary in length; they include
+    // an empty string and one larger than a dictionary arena block
+    uint64_t rowCount = 65535, distinctCount = 20000;
+    std::vector<std::string> values(distinctCount);
+    for (uint64_t i = 0; i < distinctCount; ++i) {
+      std::ostringstream os;
+      os << std::string((i * 7) % 61, 'x') << (i * 2654435761ULL) % 1000003;
+      values[i] = os.str();
+    }
+    values[1] = "";
+    values[2] = std::string(300 * 1024, 'y');
+
+    std::unique_ptr<ColumnVectorBatch> batch =
+      writer->createRowBatch(rowCount);
+    StructVectorBatch * structBatch =
+      dynamic_cast<StructVectorBatch *>(batch.get());
+    StringVectorBatch * strBatch =
+      dynamic_cast<StringVectorBatch *>(structBatch->fields[0]);
+    for (uint64_t i = 0; i < rowCount; ++i) {
+      const std::string& value = values[i % distinctCount];
+      strBatch->data[i] = const_cast<char *>(value.data());
+      strBatch->length[i] = static_cast<int64_t>(value.size());
+    }
+    structBatch->numElements = rowCount;
+    strBatch->numElements = rowCount;
+    writer->add(*batch);
+    writer->close();
+
+    std::unique_ptr<InputStream> inStream(
+      new MemoryInputStream (memStream.getData(), memStream.getLength()));
+    std::unique_ptr<Reader> reader = createReader(pool, std::move(inStream));
+    std::unique_ptr<RowReader> rowReader = createRowReader(reader.get());
+    EXPECT_EQ(rowCount, reader->getNumberOfRows());
+
+    batch = rowReader->createRowBatch(rowCount);
+    EXPECT_EQ(true, rowReader->next(*batch));
+    EXPECT_EQ(rowCount, batch->numElements);
+    structBatch = dynamic_cast<StructVectorBatch *>(batch.get());
+    strBatch = dynamic_cast<StringVectorBatch *>(structBatch->fields[0]);
+    for (uint64_t i = 0; i < rowCount; ++i) {
+      std::string str(strBatch->data[i],
+                      static_cast<size_t>(strBatch->length[i]));
+      EXPECT_EQ(values[i % distinctCount], str);
+    }
+
+    EXPECT_FALSE(rowReader->next(*batch));
+  }
+
   // test dictionary encoding with index disabled
   // the decision of using dictionary if made at the end of 1st stripe
   TEST(DictionaryEncoding, writeStringDictionaryEncodingWithoutIndex) {
@@ -453,4 +515,9 @@ namespace orc {
     testDictionaryMultipleStripes(DICT_THRESHOLD, false);
     testDictionaryMultipleStripes(FALLBACK_THRESHOLD, false);
   }
+
+  TEST(DictionaryEncoding, highCardinalityDictionary) {
+    testHighCardinalityDictionary(1.0);
+    testHighCardinalityDictionary(FALLBACK_THRESHOLD);
+  }
 }
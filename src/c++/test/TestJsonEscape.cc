@@ -0,0 +1,93 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "CpuInfo.hh"
+#include "JsonEscape.hh"
+#include "wrap/gtest-wrapper.h"
+
+#include <random>
+
+namespace orc {
+
+  static std::string escape(const std::string& text) {
+    std::string result;
+    writeJsonEscaped(result, text.data(), text.size());
+    return result;
+  }
+
+  TEST(TestJsonEscape, escapes) {
+    EXPECT_EQ("", escape(""));
+    EXPECT_EQ("abc", escape("abc"));
+    EXPECT_EQ("\\\"\\\\\\b\\f\\n\\r\\t", escape("\"\\\b\f\n\r\t"));
+    EXPECT_EQ("\\u0000\\u0001\\u001f\\u007f ~",
+              escape(std::string("\0\x01\x1f\x7f ~", 6)));
+    // UTF-8 and bytes that aren't valid UTF-8 are copied unchanged
+    EXPECT_EQ("\xc3\xa9\xe2\x82\xac\xf0\x9f\x98\x80",
+              escape("\xc3\xa9\xe2\x82\xac\xf0\x9f\x98\x80"));
+    EXPECT_EQ("\x80\xff\xc3", escape("\x80\xff\xc3"));
+    EXPECT_EQ("a long run of text with a \\\"quote\\\" after 32 bytes",
+              escape("a long run of text with a \"quote\" after 32 bytes"));
+  }
+
+  typedef size_t (*Finder)(const char*, size_t);
+
+  static void checkFinder(Finder finder) {
+    std::mt19937 random(7);
+    const char special[] = {'"', '\\', '\0', '\n', 0x1f, 0x7f};
+    std::string text;
+    for (size_t length = 0; length < 200; ++length) {
+      text.assign(length, 'x');
+      for (size_t i = 0; i < length; ++i) {
+        text[i] = static_cast<char>(0x20 + random() % 0xe0);
+        if (text[i] == '"' || text[i] == '\\' || text[i] == 0x7f) {
+          text[i] = 'x';
+        }
+      }
+      ASSERT_EQ(length, finder(text.data(), length));
+      // every special character at every position
+      for (size_t pos = 0; pos < length; ++pos) {
+        char saved = text[pos];
+        for (char ch : special) {
+          text[pos] = ch;
+          ASSERT_EQ(pos, finder(text.data(), length))
+            << "length " << length << " ch " << static_cast<int>(ch);
+          ASSERT_EQ(pos, findJsonEscapeScalar(text.data(), length));
+        }
+        text[pos] = saved;
+      }
+    }
+  }
+
+  TEST(TestJsonEscape, findScalar) {
+    checkFinder(findJsonEscapeScalar);
+  }
+
+#ifdef HAS_SSE2
+  TEST(TestJsonEscape, findSse2) {
+    checkFinder(findJsonEscapeSse2);
+  }
+#endif
+
+#ifdef HAS_AVX2
+  TEST(TestJsonEscape, findAvx2) {
+    if (cpuSupportsAvx2()) {
+      checkFinder(findJsonEscapeAvx2);
+    }
+  }
+#endif
+}
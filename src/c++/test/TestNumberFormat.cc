@@ -0,0 +1,216 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "orc/ColumnPrinter.hh"
+
+#include "Adaptor.hh"
+#include "NumberFormat.hh"
+#include "wrap/gtest-wrapper.h"
+
+#include <cmath>
+#include <limits>
+#include <random>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+namespace orc {
+
+  static std::string toString(int64_t value) {
+    char buffer[MAX_INT64_CHARS];
+    return std::string(buffer, formatInt64(value, buffer));
+  }
+
+  static std::string toString(double value) {
+    char buffer[MAX_DOUBLE_CHARS];
+    return std::string(buffer, formatDouble(value, buffer));
+  }
+
+  static std::string toString(float value) {
+    char buffer[MAX_DOUBLE_CHARS];
+    return std::string(buffer, formatFloat(value, buffer));
+  }
+
+  // the number of significant digits in a formatted number
+  static int countSignificant(const std::string& text) {
+    std::string digits;
+    for (size_t i = 0; i < text.size() && text[i] != 'e'; ++i) {
+      if (isdigit(text[i])) {
+        digits += text[i];
+      }
+    }
+    size_t first = digits.find_first_not_of('0');
+    if (first == std::string::npos) {
+      return 1;
+    }
+    size_t last = digits.find_last_not_of('0');
+    return static_cast<int>(last - first + 1);
+  }
+
+  // the fewest significant digits that read back as value
+  static int shortestDigits(double value, int maxDigits, bool isFloat) {
+    char buffer[64];
+    for (int digits = 1; digits < maxDigits; ++digits) {
+      snprintf(buffer, sizeof(buffer), "%.*e", digits - 1, value);
+      if (isFloat ? strtof(buffer, nullptr) == static_cast<float>(value) :
+          strtod(buffer, nullptr) == value) {
+        return digits;
+      }
+    }
+    return maxDigits;
+  }
+
+  TEST(TestNumberFormat, integers) {
+    EXPECT_EQ("0", toString(static_cast<int64_t>(0)));
+    EXPECT_EQ("7", toString(static_cast<int64_t>(7)));
+    EXPECT_EQ("-7", toString(static_cast<int64_t>(-7)));
+    EXPECT_EQ("10", toString(static_cast<int64_t>(10)));
+    EXPECT_EQ("-100", toString(static_cast<int64_t>(-100)));
+    EXPECT_EQ("1234567890123", toString(static_cast<int64_t>(1234567890123)));
+    EXPECT_EQ("9223372036854775807",
+              toString(std::numeric_limits<int64_t>::max()));
+    EXPECT_EQ("-9223372036854775808",
+              toString(std::numeric_limits<int64_t>::min()));
+
+    char buffer[MAX_INT64_CHARS];
+    EXPECT_EQ("18446744073709551615",
+              std::string(buffer,
+                          formatUInt64(std::numeric_limits<uint64_t>::max(),
+                                       buffer)));
+
+    std::mt19937_64 random(42);
+    char expected[32];
+    for (int i = 0; i < 100000; ++i) {
+      int64_t value = static_cast<int64_t>(random()) >> (random() % 64);
+      snprintf(expected, sizeof(expected), "%" INT64_FORMAT_STRING "d",
+               value);
+      ASSERT_EQ(expected, toString(value));
+    }
+  }
+
+  TEST(TestNumberFormat, doubles) {
+    EXPECT_EQ("0", toString(0.0));
+    EXPECT_EQ("-0", toString(-0.0));
+    EXPECT_EQ("1", toString(1.0));
+    EXPECT_EQ("-2.5", toString(-2.5));
+    EXPECT_EQ("0.1", toString(0.1));
+    EXPECT_EQ("0.3", toString(0.3));
+    EXPECT_EQ("123.456", toString(123.456));
+    EXPECT_EQ("0.0001", toString(0.0001));
+    EXPECT_EQ("1e-05", toString(0.00001));
+    EXPECT_EQ("1e-07", toString(1e-7));
+    EXPECT_EQ("10000000000000000", toString(1e16));
+    EXPECT_EQ("1e+17", toString(1e17));
+    EXPECT_EQ("1e+30", toString(1e30));
+    EXPECT_EQ("0.6666666666666666", toString(2.0 / 3.0));
+    EXPECT_EQ("9007199254740992", toString(9007199254740992.0));
+    EXPECT_EQ("1.2345678901234568e+17", toString(123456789012345678.0));
+    EXPECT_EQ("5e-324", toString(std::numeric_limits<double>::denorm_min()));
+    EXPECT_EQ("2.2250738585072014e-308",
+              toString(std::numeric_limits<double>::min()));
+    EXPECT_EQ("1.7976931348623157e+308",
+              toString(std::numeric_limits<double>::max()));
+  }
+
+  TEST(TestNumberFormat, floats) {
+    EXPECT_EQ("0", toString(0.0f));
+    EXPECT_EQ("-0", toString(-0.0f));
+    EXPECT_EQ("0.1", toString(0.1f));
+    EXPECT_EQ("652.0717", toString(652.0717f));
+    EXPECT_EQ("16777216", toString(16777216.0f));
+    EXPECT_EQ("123456790", toString(123456789.0f));
+    EXPECT_EQ("1e+09", toString(1e9f));
+    EXPECT_EQ("1e+30", toString(1e30f));
+    EXPECT_EQ("1e-45", toString(std::numeric_limits<float>::denorm_min()));
+    EXPECT_EQ("3.4028235e+38", toString(std::numeric_limits<float>::max()));
+  }
+
+  TEST(TestNumberFormat, doubleRoundTrip) {
+    std::mt19937_64 random(1);
+    for (int i = 0; i < 200000; ++i) {
+      double value;
+      if (i % 2 == 0) {
+        uint64_t bits = random();
+        memcpy(&value, &bits, sizeof(value));
+        if (!std::isfinite(value)) {
+          continue;
+        }
+      } else {
+        value = static_cast<double>(random() % 100000000) /
+          static_cast<double>(1 + random() % 10000);
+      }
+      std::string text = toString(value);
+      double result = strtod(text.c_str(), nullptr);
+      ASSERT_EQ(0, memcmp(&value, &result, sizeof(value))) << text;
+      if (i % 10 == 0) {
+        ASSERT_EQ(shortestDigits(value, 17, false), countSignificant(text))
+          << text;
+      }
+    }
+  }
+
+  TEST(TestNumberFormat, floatRoundTrip) {
+    std::mt19937_64 random(2);
+    for (int i = 0; i < 200000; ++i) {
+      uint32_t bits = static_cast<uint32_t>(random());
+      float value;
+      memcpy(&value, &bits, sizeof(value));
+      if (!std::isfinite(value)) {
+        continue;
+      }
+      std::string text = toString(value);
+      float result = strtof(text.c_str(), nullptr);
+      ASSERT_EQ(0, memcmp(&value, &result, sizeof(value))) << text;
+      if (i % 10 == 0) {
+        ASSERT_EQ(shortestDigits(value, 9, true), countSignificant(text))
+          << text;
+      }
+    }
+  }
+
+  TEST(TestNumberFormat, printerFloatFormat) {
+    std::unique_ptr<Type> type = Type::buildTypeFromString(
+      "struct<f:float,d:double>");
+    StructVectorBatch batch(2, *getDefaultPool());
+    DoubleVectorBatch* floats = new DoubleVectorBatch(2, *getDefaultPool());
+    DoubleVectorBatch* doubles = new DoubleVectorBatch(2, *getDefaultPool());
+    batch.fields.push_back(floats);
+    batch.fields.push_back(doubles);
+    batch.numElements = floats->numElements = doubles->numElements = 2;
+    batch.hasNulls = floats->hasNulls = doubles->hasNulls = false;
+    floats->data[0] = 0.1f;
+    floats->data[1] = 1.0f / 3.0f;
+    doubles->data[0] = 0.1;
+    doubles->data[1] = 1.0 / 3.0;
+
+    std::string line;
+    std::unique_ptr<ColumnPrinter> printer =
+      createColumnPrinter(line, type.get());
+    printer->reset(batch);
+    printer->printBatch(2);
+    EXPECT_EQ("{\"f\":0.1,\"d\":0.1}\n"
+              "{\"f\":0.3333333,\"d\":0.33333333333333}\n", line);
+
+    line.clear();
+    printer = createColumnPrinter(line, type.get(), FloatFormat_SHORTEST);
+    printer->reset(batch);
+    printer->printBatch(2);
+    EXPECT_EQ("{\"f\":0.1,\"d\":0.1}\n"
+              "{\"f\":0.33333334,\"d\":0.3333333333333333}\n", line);
+  }
+}
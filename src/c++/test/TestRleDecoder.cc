@@ -20,6 +20,7 @@
 #include "Compression.hh"
 #include "OrcTest.hh"
 #include "RLE.hh"
+#include "RLEV2Util.hh"
 #include "wrap/gtest-wrapper.h"
 
 #include <iostream>
@@ -2653,4 +2654,27 @@ TEST(RLEv1, testLeadingNulls) {
   }
 };
 
+TEST(RLEv2, unpackBits) {
+  std::vector<unsigned char> packed(70 * 8 + 8);
+  for (size_t i = 0; i < packed.size(); ++i) {
+    packed[i] = static_cast<unsigned char>(i * 167 + 13);
+  }
+  for (uint32_t bitWidth = 1; bitWidth <= 64; ++bitWidth) {
+    for (uint64_t count : {0, 1, 3, 4, 7, 8, 9, 33, 70}) {
+      std::vector<int64_t> values(count);
+      unpackBits(packed.data(), bitWidth, values.data(), count);
+      for (uint64_t i = 0; i < count; ++i) {
+        // read the value a bit at a time
+        uint64_t expected = 0;
+        for (uint64_t bit = i * bitWidth; bit < (i + 1) * bitWidth; ++bit) {
+          expected = (expected << 1) |
+            ((packed[bit / 8] >> (7 - bit % 8)) & 1);
+        }
+        EXPECT_EQ(expected, static_cast<uint64_t>(values[i]))
+          << "width " << bitWidth << " value " << i << " of " << count;
+      }
+    }
+  }
+}
+
 }  // namespace orc
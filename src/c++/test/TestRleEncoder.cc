@@ -16,10 +16,12 @@
  * limitations under the License.
  */
 
+#include <algorithm>
 #include <cstdlib>
 
 #include "MemoryOutputStream.hh"
 #include "RLEv1.hh"
+#include "RLEV2Util.hh"
 
 #include "wrap/orc-proto-wrapper.hh"
 #include "wrap/gtest-wrapper.h"
@@ -306,5 +308,81 @@ namespace orc {
     runExampleTest(data, 9, expectedEncoded, 13);
   }
 
+  TEST_P(RleTest, RleV2_bit_widths_small_blocks) {
+    // every bit width, read through small blocks so that the packed runs
+    // cross block boundaries, with and without nulls
+    const uint64_t numValues = 1000;
+    std::vector<int64_t> data(numValues);
+    std::vector<char> notNull(numValues);
+    for (uint32_t bits = 1; bits <= 64; ++bits) {
+      uint64_t state = bits;
+      for (uint64_t i = 0; i < numValues; ++i) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        data[i] = static_cast<int64_t>(bits == 64 ? state :
+                                       state >> (64 - bits));
+        notNull[i] = static_cast<char>(i % 7 != 3);
+      }
+      for (bool hasNulls : {false, true}) {
+        MemoryOutputStream memStream(DEFAULT_MEM_STREAM_SIZE);
+        std::unique_ptr<RleEncoder> encoder =
+          getEncoder(RleVersion_2, memStream, false);
+        const char* nulls = hasNulls ? notNull.data() : nullptr;
+        encoder->add(data.data(), numValues, nulls);
+        encoder->flush();
+
+        std::unique_ptr<RleDecoder> decoder = createRleDecoder(
+          std::unique_ptr<SeekableArrayInputStream>(
+            new SeekableArrayInputStream(memStream.getData(),
+                                         memStream.getLength(), 7)),
+          false, RleVersion_2, *getDefaultPool());
+        std::vector<int64_t> decoded(numValues);
+        for (uint64_t i = 0; i < numValues; i += 300) {
+          uint64_t count = std::min<uint64_t>(300, numValues - i);
+          decoder->next(decoded.data() + i, count, nulls ? nulls + i : nullptr);
+        }
+        for (uint64_t i = 0; i < numValues; ++i) {
+          if (!hasNulls || notNull[i]) {
+            EXPECT_EQ(data[i], decoded[i]) << "bits " << bits << " row " << i;
+          }
+        }
+      }
+    }
+  }
+
   INSTANTIATE_TEST_CASE_P(OrcTest, RleTest, Values(true, false));
+
+  TEST(RLEv2, packBitsRoundTrip) {
+    // every count up to 100 so each width ends at every bit offset and
+    // the vectorized packers hit all of their tails
+    std::vector<int64_t> values(100);
+    uint64_t seed = 1;
+    for (auto& value : values) {
+      seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+      value = static_cast<int64_t>(seed);
+    }
+    for (uint32_t bitWidth = 1; bitWidth <= 64; ++bitWidth) {
+      const uint64_t mask = ~static_cast<uint64_t>(0) >> (64 - bitWidth);
+      for (uint64_t count = 0; count <= values.size(); ++count) {
+        // one spare byte to catch writes past the end
+        uint64_t size = (count * bitWidth + 7) / 8;
+        std::vector<unsigned char> packed(size + 1, 0xff);
+        ASSERT_EQ(size, packBits(values.data(), bitWidth, count, packed.data()));
+        ASSERT_EQ(0xff, packed[size]);
+
+        std::vector<int64_t> unpacked(count);
+        unpackBits(packed.data(), bitWidth, unpacked.data(), count);
+        for (uint64_t i = 0; i < count; ++i) {
+          ASSERT_EQ(static_cast<uint64_t>(values[i]) & mask,
+                    static_cast<uint64_t>(unpacked[i]))
+            << "width " << bitWidth << " value " << i << " of " << count;
+        }
+        // the padding after the last value is zero
+        uint64_t padding = size * 8 - count * bitWidth;
+        if (padding != 0) {
+          ASSERT_EQ(0, packed[size - 1] & ((1 << padding) - 1))
+            << "width " << bitWidth << " count " << count;
+        }
+      }
+    }
+  }
 }
@@ -96,4 +96,42 @@ namespace orc {
     EXPECT_EQ(true, rowgroups[3]);
   }
 
+  TEST(TestSargsApplier, testStripeAndFileStats) {
+    auto type = std::unique_ptr<Type>(
+      Type::buildTypeFromString("struct<x:int,y:int>"));
+    auto sarg = SearchArgumentFactory::newBuilder()
+      ->startAnd()
+      .equals(
+              "x",
+              PredicateDataType::LONG,
+              Literal(static_cast<int64_t>(20)))
+      .equals(
+              "y",
+              PredicateDataType::LONG,
+              Literal(static_cast<int64_t>(40)))
+      .end()
+      .build();
+    SargsApplier applier(*type, sarg.get(), 1000, WriterVersion_ORC_135);
+
+    // col 0 is the root struct
+    proto::StripeStatistics stripeStats;
+    stripeStats.add_colstats();
+    *stripeStats.add_colstats() = createIntStats(0L, 10L);
+    *stripeStats.add_colstats() = createIntStats(0L, 50L);
+    EXPECT_FALSE(applier.evaluateStripeStatistics(stripeStats));
+    *stripeStats.mutable_colstats(1) = createIntStats(10L, 50L);
+    EXPECT_TRUE(applier.evaluateStripeStatistics(stripeStats));
+
+    proto::Footer footer;
+    footer.add_statistics();
+    *footer.add_statistics() = createIntStats(10L, 50L);
+    *footer.add_statistics() = createIntStats(50L, 100L);
+    EXPECT_FALSE(applier.evaluateFileStatistics(footer));
+    *footer.mutable_statistics(2) = createIntStats(0L, 100L);
+    EXPECT_TRUE(applier.evaluateFileStatistics(footer));
+
+    // missing statistics can't rule anything out
+    EXPECT_TRUE(applier.evaluateStripeStatistics(proto::StripeStatistics()));
+  }
+
 }  // namespace orc
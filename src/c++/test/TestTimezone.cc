@@ -148,6 +148,23 @@ namespace orc {
     EXPECT_EQ("FOO", getZoneFromRule(rule.get(), "2369-11-02 09:00:00"));
     EXPECT_EQ("FOO", getZoneFromRule(rule.get(), "2369-12-31 00:00:00"));
 
+    // the range around a time ends at the next transition
+    int64_t rangeStart;
+    int64_t rangeEnd;
+    EXPECT_EQ("BAR", rule->getVariant(3600 * 24 * 100, rangeStart,
+                                      rangeEnd).name);
+    EXPECT_EQ("FOO", rule->getVariant(rangeStart - 1).name);
+    EXPECT_EQ("BAR", rule->getVariant(rangeStart).name);
+    EXPECT_EQ("BAR", rule->getVariant(rangeEnd - 1).name);
+    EXPECT_EQ("FOO", rule->getVariant(rangeEnd).name);
+
+    // the ranges at the ends of time are clamped instead of wrapping
+    for (int64_t clk : {INT64_MIN, INT64_MAX}) {
+      rule->getVariant(clk, rangeStart, rangeEnd);
+      EXPECT_LE(rangeStart, clk);
+      EXPECT_LT(rangeStart, rangeEnd);
+    }
+
     // 2370
     EXPECT_EQ("FOO", getZoneFromRule(rule.get(), "2370-01-01 00:00:00"));
     EXPECT_EQ("FOO", getZoneFromRule(rule.get(), "2370-03-08 09:59:59"));
@@ -342,6 +359,41 @@ namespace orc {
     EXPECT_EQ("PDT", getVariantFromZone(*la, "2100-03-14 10:00:00"));
   }
 
+  TEST(TestTimezone, convertArrayToUTC) {
+    std::vector<std::string> files = {LA_VER1, LA_VER2};
+    for (const std::string& file : files) {
+      std::unique_ptr<Timezone> la = getTimezone("America/Los_Angeles",
+                                                 decodeBase64(file));
+      // from 1900 to 2500 in uneven steps, which run through many
+      // transitions, both in the table and from the future rule
+      std::vector<int64_t> clks;
+      for (int64_t clk = -2208988800; clk < 16725225600;
+           clk += 86400 * 3 + 3607) {
+        clks.push_back(clk);
+      }
+      // and back and forth across a single transition
+      for (int64_t clk = 4108010400 - 5; clk < 4108010400 + 5; ++clk) {
+        clks.push_back(clk);
+        clks.push_back(clk - 86400 * 180);
+      }
+      std::vector<char> notNull(clks.size());
+      for (size_t i = 0; i < clks.size(); ++i) {
+        notNull[i] = i % 11 != 0;
+      }
+
+      std::vector<int64_t> converted(clks);
+      la->convertToUTC(converted.data(), converted.size(), nullptr);
+      std::vector<int64_t> convertedWithNulls(clks);
+      la->convertToUTC(convertedWithNulls.data(), convertedWithNulls.size(),
+                       notNull.data());
+      for (size_t i = 0; i < clks.size(); ++i) {
+        EXPECT_EQ(la->convertToUTC(clks[i]), converted[i]) << clks[i];
+        EXPECT_EQ(notNull[i] ? la->convertToUTC(clks[i]) : clks[i],
+                  convertedWithNulls[i]) << clks[i];
+      }
+    }
+  }
+
   TEST(TestTimezone, testZoneCache) {
     const Timezone *la1 = &getTimezoneByName("America/Los_Angeles");
     const Timezone *ny1 = &getTimezoneByName("America/New_York");
@@ -18,6 +18,7 @@
 
 #include "orc/ColumnPrinter.hh"
 #include "orc/OrcFile.hh"
+#include "orc/sargs/SearchArgument.hh"
 
 #include "MemoryInputStream.hh"
 #include "MemoryOutputStream.hh"
@@ -29,6 +30,11 @@
 #include <ctime>
 #include <sstream>
 
+#ifndef _MSC_VER
+#include <stdlib.h>
+#include <unistd.h>
+#endif
+
 #ifdef __clang__
   DIAGNOSTIC_IGNORE("-Wmissing-variable-declarations")
 #endif
@@ -1678,5 +1684,805 @@ namespace orc {
     }
   }
 
+  TEST_P(WriterTest, batchMemoryBudget) {
+    MemoryOutputStream memStream(DEFAULT_MEM_STREAM_SIZE);
+    MemoryPool* pool = getDefaultPool();
+    ORC_UNIQUE_PTR<Type> type(Type::buildTypeFromString(
+      "struct<id:bigint,name:string>"));
+
+    // short names in the first stripes and long ones after them
+    uint64_t narrowRows = 200000;
+    uint64_t rowCount = narrowRows + 10000;
+    uint64_t writeBatchSize = 1000;
+    std::unique_ptr<Writer> writer = createWriter(1024 * 1024, 64 * 1024,
+                                                  CompressionKind_NONE, *type,
+                                                  pool, &memStream,
+                                                  fileVersion);
+    std::unique_ptr<ColumnVectorBatch> batch =
+      writer->createRowBatch(writeBatchSize);
+    StructVectorBatch* structBatch =
+      dynamic_cast<StructVectorBatch *>(batch.get());
+    LongVectorBatch* idBatch =
+      dynamic_cast<LongVectorBatch *>(structBatch->fields[0]);
+    StringVectorBatch* nameBatch =
+      dynamic_cast<StringVectorBatch *>(structBatch->fields[1]);
+    std::vector<std::string> names(rowCount);
+    for (uint64_t i = 0; i < rowCount; ++i) {
+      names[i] = std::to_string(i);
+      if (i >= narrowRows) {
+        names[i].append(1000, static_cast<char>('a' + i % 26));
+      }
+    }
+    for (uint64_t start = 0; start < rowCount; start += writeBatchSize) {
+      for (uint64_t i = 0; i < writeBatchSize; ++i) {
+        idBatch->data[i] = static_cast<int64_t>(start + i);
+        nameBatch->data[i] = const_cast<char*>(names[start + i].c_str());
+        nameBatch->length[i] =
+          static_cast<int64_t>(names[start + i].size());
+      }
+      structBatch->numElements = writeBatchSize;
+      idBatch->numElements = writeBatchSize;
+      nameBatch->numElements = writeBatchSize;
+      writer->add(*batch);
+    }
+    writer->close();
+
+    std::unique_ptr<InputStream> inStream(
+            new MemoryInputStream (memStream.getData(), memStream.getLength()));
+    std::unique_ptr<Reader> reader = createReader(pool, std::move(inStream));
+    EXPECT_LT(2, reader->getNumberOfStripes());
+
+    uint64_t budget = 256 * 1024;
+    RowReaderOptions rowReaderOpts;
+    rowReaderOpts.setBatchMemoryBudget(budget);
+    EXPECT_EQ(budget, rowReaderOpts.getBatchMemoryBudget());
+    std::unique_ptr<RowReader> rowReader =
+      reader->createRowReader(rowReaderOpts);
+    batch = rowReader->createRowBatch(4096);
+    structBatch = dynamic_cast<StructVectorBatch *>(batch.get());
+    idBatch = dynamic_cast<LongVectorBatch *>(structBatch->fields[0]);
+    nameBatch = dynamic_cast<StringVectorBatch *>(structBatch->fields[1]);
+
+    uint64_t row = 0;
+    uint64_t maxRows = 0;
+    uint64_t maxBlob = 0;
+    while (rowReader->next(*batch)) {
+      EXPECT_GE(4096, batch->numElements);
+      uint64_t firstRow = row;
+      for (uint64_t i = 0; i < batch->numElements; ++i, ++row) {
+        ASSERT_EQ(row, idBatch->data[i]);
+        ASSERT_EQ(names[row],
+                  std::string(nameBatch->data[i],
+                              static_cast<size_t>(nameBatch->length[i])));
+      }
+      maxRows = std::max(maxRows, batch->numElements);
+      // the statistics of the stripe with both kinds of rows don't tell
+      // where the wide ones start, so only later batches are held to the
+      // budget
+      if (firstRow >= narrowRows) {
+        maxBlob = std::max(maxBlob, nameBatch->blob.size());
+      }
+    }
+    EXPECT_EQ(rowCount, row);
+    // narrow rows fill the batch and wide ones are held near the budget
+    EXPECT_EQ(4096, maxRows);
+    EXPECT_LT(budget / 2, maxBlob);
+    EXPECT_GE(budget, maxBlob);
+  }
+
+  TEST_P(WriterTest, readerMetrics) {
+    MemoryOutputStream memStream(DEFAULT_MEM_STREAM_SIZE);
+    MemoryPool* pool = getDefaultPool();
+    ORC_UNIQUE_PTR<Type> type(Type::buildTypeFromString(
+      "struct<id:bigint,name:string>"));
+
+    uint64_t rowCount = 200000;
+    uint64_t stride = 1000;
+    std::unique_ptr<Writer> writer = createWriter(64 * 1024, 16 * 1024,
+                                                  CompressionKind_ZLIB, *type,
+                                                  pool, &memStream,
+                                                  fileVersion, stride);
+    std::unique_ptr<ColumnVectorBatch> batch = writer->createRowBatch(1000);
+    StructVectorBatch* structBatch =
+      dynamic_cast<StructVectorBatch *>(batch.get());
+    LongVectorBatch* idBatch =
+      dynamic_cast<LongVectorBatch *>(structBatch->fields[0]);
+    StringVectorBatch* nameBatch =
+      dynamic_cast<StringVectorBatch *>(structBatch->fields[1]);
+    std::vector<std::string> names(rowCount);
+    for (uint64_t start = 0; start < rowCount; start += 1000) {
+      for (uint64_t i = 0; i < 1000; ++i) {
+        names[start + i] =
+          std::to_string((start + i) * 2654435761ULL % 1000000007);
+        idBatch->data[i] = static_cast<int64_t>(start + i);
+        nameBatch->data[i] = const_cast<char*>(names[start + i].c_str());
+        nameBatch->length[i] =
+          static_cast<int64_t>(names[start + i].size());
+      }
+      structBatch->numElements = 1000;
+      idBatch->numElements = 1000;
+      nameBatch->numElements = 1000;
+      writer->add(*batch);
+    }
+    writer->close();
+
+    // nothing is counted unless asked for
+    std::unique_ptr<Reader> reader = createReader(pool,
+      std::unique_ptr<InputStream>(
+        new MemoryInputStream(memStream.getData(), memStream.getLength())));
+    EXPECT_TRUE(reader->getReaderMetrics() == nullptr);
+    EXPECT_TRUE(createRowReader(reader.get())->getReaderMetrics() == nullptr);
+
+    std::shared_ptr<ReaderMetrics> metrics(new ReaderMetrics());
+    ReaderOptions readerOpts;
+    readerOpts.setMemoryPool(*pool);
+    readerOpts.setReaderMetrics(metrics);
+    reader = createReader(std::unique_ptr<InputStream>(
+      new MemoryInputStream(memStream.getData(), memStream.getLength())),
+                          readerOpts);
+    EXPECT_EQ(metrics.get(), reader->getReaderMetrics());
+    uint64_t stripeCount = reader->getNumberOfStripes();
+    EXPECT_LT(2, stripeCount);
+    uint64_t rowGroupCount = 0;
+    for (uint64_t i = 0; i < stripeCount; ++i) {
+      rowGroupCount +=
+        (reader->getStripe(i)->getNumberOfRows() + stride - 1) / stride;
+    }
+
+    std::unique_ptr<RowReader> rowReader = createRowReader(reader.get());
+    batch = rowReader->createRowBatch(1024);
+    uint64_t rows = 0;
+    while (rowReader->next(*batch)) {
+      rows += batch->numElements;
+    }
+    EXPECT_EQ(rowCount, rows);
+    EXPECT_EQ(metrics.get(), rowReader->getReaderMetrics());
+    EXPECT_EQ(stripeCount, metrics->getStripesRead());
+    EXPECT_EQ(0, metrics->getStripesSkipped());
+    EXPECT_EQ(rowGroupCount, metrics->getRowGroupsRead());
+    EXPECT_EQ(0, metrics->getRowGroupsSkipped());
+
+    std::map<StreamKind, StreamReadMetrics> streams =
+      metrics->getStreamReads();
+    ASSERT_EQ(1, streams.count(StreamKind_DATA));
+    ASSERT_EQ(1, streams.count(StreamKind_LENGTH));
+    EXPECT_LT(0, streams[StreamKind_DATA].readCalls);
+    EXPECT_LT(0, streams[StreamKind_DATA].bytesRead);
+    EXPECT_LT(0, streams[StreamKind_LENGTH].bytesRead);
+    uint64_t bytesRead = 0;
+    for (const auto& entry : streams) {
+      bytesRead += entry.second.bytesRead;
+    }
+    EXPECT_GE(memStream.getLength(), bytesRead);
+
+    std::map<CompressionKind, DecompressionMetrics> decompression =
+      metrics->getDecompression();
+    ASSERT_EQ(1, decompression.size());
+    const DecompressionMetrics& zlib = decompression[CompressionKind_ZLIB];
+    EXPECT_LT(0, zlib.blocks);
+    // each compressed chunk has a 3 byte header
+    EXPECT_LE(zlib.compressedBytes + 3 * zlib.blocks, bytesRead);
+    EXPECT_LT(zlib.compressedBytes, zlib.decompressedBytes);
+
+    std::map<uint64_t, DecodeMetrics> columns = metrics->getColumnDecoding();
+    ASSERT_EQ(3, columns.size());
+    for (uint64_t col = 0; col < 3; ++col) {
+      EXPECT_EQ(rowCount, columns[col].values) << "column " << col;
+      EXPECT_LT(0, columns[col].calls) << "column " << col;
+    }
+    // a column's time includes its children's
+    EXPECT_LE(columns[1].nanoseconds + columns[2].nanoseconds,
+              columns[0].nanoseconds);
+
+    // only the last row group can have ids at or after rowCount - 500
+    metrics->reset();
+    EXPECT_EQ(0, metrics->getStripesRead());
+    EXPECT_TRUE(metrics->getStreamReads().empty());
+    RowReaderOptions rowReaderOpts;
+    rowReaderOpts.searchArgument(SearchArgumentFactory::newBuilder()
+      ->startNot()
+      .lessThan("id", PredicateDataType::LONG,
+                Literal(static_cast<int64_t>(rowCount - 500)))
+      .end()
+      .build());
+    rowReader = reader->createRowReader(rowReaderOpts);
+    rows = 0;
+    while (rowReader->next(*batch)) {
+      rows += batch->numElements;
+    }
+    EXPECT_EQ(stride, rows);
+    rowReader.reset();
+    EXPECT_EQ(1, metrics->getStripesRead());
+    EXPECT_EQ(stripeCount - 1, metrics->getStripesSkipped());
+    EXPECT_EQ(1, metrics->getRowGroupsRead());
+    EXPECT_EQ(rowGroupCount - 1, metrics->getRowGroupsSkipped());
+    EXPECT_EQ(stride, metrics->getColumnDecoding()[0].values);
+    EXPECT_LT(0, metrics->getStreamReads()[StreamKind_ROW_INDEX].bytesRead);
+  }
+
+  TEST_P(WriterTest, readerMetricsNested) {
+    MemoryOutputStream memStream(DEFAULT_MEM_STREAM_SIZE);
+    MemoryPool* pool = getDefaultPool();
+    ORC_UNIQUE_PTR<Type> type(Type::buildTypeFromString(
+      "struct<list:array<int>,map:map<int,int>>"));
+
+    uint64_t rowCount = 1000;
+    uint64_t maxListLength = 5;
+    std::unique_ptr<Writer> writer = createWriter(1024 * 1024, 64 * 1024,
+                                                  CompressionKind_ZLIB, *type,
+                                                  pool, &memStream,
+                                                  fileVersion);
+    std::unique_ptr<ColumnVectorBatch> batch =
+      writer->createRowBatch(rowCount * maxListLength);
+    StructVectorBatch* structBatch =
+      dynamic_cast<StructVectorBatch *>(batch.get());
+    ListVectorBatch* listBatch =
+      dynamic_cast<ListVectorBatch *>(structBatch->fields[0]);
+    MapVectorBatch* mapBatch =
+      dynamic_cast<MapVectorBatch *>(structBatch->fields[1]);
+    LongVectorBatch* elementBatch =
+      dynamic_cast<LongVectorBatch *>(listBatch->elements.get());
+    LongVectorBatch* keyBatch =
+      dynamic_cast<LongVectorBatch *>(mapBatch->keys.get());
+    LongVectorBatch* valueBatch =
+      dynamic_cast<LongVectorBatch *>(mapBatch->elements.get());
+    uint64_t offset = 0;
+    for (uint64_t i = 0; i < rowCount; ++i) {
+      listBatch->offsets[i] = static_cast<int64_t>(offset);
+      mapBatch->offsets[i] = static_cast<int64_t>(offset);
+      for (uint64_t length = i % maxListLength + 1; length != 0; --length) {
+        elementBatch->data[offset] = static_cast<int64_t>(i);
+        keyBatch->data[offset] = static_cast<int64_t>(length);
+        valueBatch->data[offset] = static_cast<int64_t>(i);
+        ++offset;
+      }
+    }
+    listBatch->offsets[rowCount] = static_cast<int64_t>(offset);
+    mapBatch->offsets[rowCount] = static_cast<int64_t>(offset);
+    structBatch->numElements = rowCount;
+    listBatch->numElements = rowCount;
+    mapBatch->numElements = rowCount;
+    writer->add(*batch);
+    writer->close();
+
+    std::shared_ptr<ReaderMetrics> metrics(new ReaderMetrics());
+    ReaderOptions readerOpts;
+    readerOpts.setMemoryPool(*pool);
+    readerOpts.setReaderMetrics(metrics);
+    std::unique_ptr<Reader> reader = createReader(
+      std::unique_ptr<InputStream>(
+        new MemoryInputStream(memStream.getData(), memStream.getLength())),
+      readerOpts);
+    std::unique_ptr<RowReader> rowReader = createRowReader(reader.get());
+    batch = rowReader->createRowBatch(rowCount);
+    while (rowReader->next(*batch)) {
+      // PASS
+    }
+
+    // the children of lists and maps are timed on their own
+    std::map<uint64_t, DecodeMetrics> columns =
+      rowReader->getReaderMetrics()->getColumnDecoding();
+    ASSERT_EQ(6, columns.size());
+    EXPECT_EQ(rowCount, columns[1].values);
+    EXPECT_EQ(offset, columns[2].values);
+    EXPECT_EQ(rowCount, columns[3].values);
+    EXPECT_EQ(offset, columns[4].values);
+    EXPECT_EQ(offset, columns[5].values);
+    EXPECT_LE(columns[4].nanoseconds + columns[5].nanoseconds,
+              columns[3].nanoseconds);
+  }
+
+  // keeps the rows with a score where id % 10 < 3 or 5000 <= id < 5600
+  class TestRowFilter: public RowFilter {
+  public:
+    void filter(const ColumnVectorBatch& batch, char* keep) const override {
+      const StructVectorBatch& structBatch =
+        dynamic_cast<const StructVectorBatch&>(batch);
+      const DoubleVectorBatch& scores =
+        dynamic_cast<const DoubleVectorBatch&>(*structBatch.fields[0]);
+      const LongVectorBatch& ids =
+        dynamic_cast<const LongVectorBatch&>(*structBatch.fields[1]);
+      for (uint64_t i = 0; i < batch.numElements; ++i) {
+        int64_t id = ids.data.data()[i];
+        keep[i] = (!scores.hasNulls || scores.notNull.data()[i]) &&
+          (id % 10 < 3 || (id >= 5000 && id < 5600));
+      }
+    }
+  };
+
+  TEST_P(WriterTest, rowFilter) {
+    MemoryOutputStream memStream(DEFAULT_MEM_STREAM_SIZE);
+    MemoryPool* pool = getDefaultPool();
+    ORC_UNIQUE_PTR<Type> type(Type::buildTypeFromString(
+      "struct<id:bigint,name:string,score:double,tags:array<int>,"
+      "cat:string,extra:bigint>"));
+
+    uint64_t rowCount = 20000;
+    std::unique_ptr<Writer> writer = createWriter(16 * 1024, 1024,
+                                                  CompressionKind_ZLIB, *type,
+                                                  pool, &memStream,
+                                                  fileVersion, 1000);
+    std::unique_ptr<ColumnVectorBatch> batch =
+      writer->createRowBatch(rowCount);
+    StructVectorBatch* structBatch =
+      dynamic_cast<StructVectorBatch *>(batch.get());
+    LongVectorBatch* idBatch =
+      dynamic_cast<LongVectorBatch *>(structBatch->fields[0]);
+    StringVectorBatch* nameBatch =
+      dynamic_cast<StringVectorBatch *>(structBatch->fields[1]);
+    DoubleVectorBatch* scoreBatch =
+      dynamic_cast<DoubleVectorBatch *>(structBatch->fields[2]);
+    ListVectorBatch* tagsBatch =
+      dynamic_cast<ListVectorBatch *>(structBatch->fields[3]);
+    LongVectorBatch* tagBatch =
+      dynamic_cast<LongVectorBatch *>(tagsBatch->elements.get());
+    StringVectorBatch* catBatch =
+      dynamic_cast<StringVectorBatch *>(structBatch->fields[4]);
+    LongVectorBatch* extraBatch =
+      dynamic_cast<LongVectorBatch *>(structBatch->fields[5]);
+    std::vector<std::string> names(rowCount);
+    std::vector<std::string> cats(rowCount);
+    tagBatch->resize(rowCount * 3);
+    nameBatch->hasNulls = true;
+    scoreBatch->hasNulls = true;
+    uint64_t tags = 0;
+    for (uint64_t i = 0; i < rowCount; ++i) {
+      idBatch->data[i] = static_cast<int64_t>(i);
+      names[i] = "name-" + std::to_string(i);
+      nameBatch->notNull[i] = i % 7 != 0;
+      nameBatch->data[i] = const_cast<char*>(names[i].c_str());
+      nameBatch->length[i] = static_cast<int64_t>(names[i].size());
+      scoreBatch->notNull[i] = i % 11 != 0;
+      scoreBatch->data[i] = static_cast<double>(i) / 4;
+      tagsBatch->offsets[i] = static_cast<int64_t>(tags);
+      for (uint64_t j = 0; j < i % 4; ++j) {
+        tagBatch->notNull[tags] = 1;
+        tagBatch->data[tags++] = static_cast<int64_t>(i + j);
+      }
+      cats[i] = "cat-" + std::to_string(i % 20);
+      catBatch->data[i] = const_cast<char*>(cats[i].c_str());
+      catBatch->length[i] = static_cast<int64_t>(cats[i].size());
+      extraBatch->data[i] = 0;
+    }
+    tagsBatch->offsets[rowCount] = static_cast<int64_t>(tags);
+    tagBatch->numElements = tags;
+    structBatch->numElements = rowCount;
+    for (ColumnVectorBatch* field : structBatch->fields) {
+      field->numElements = rowCount;
+    }
+    writer->add(*batch);
+    writer->close();
+
+    std::unique_ptr<InputStream> inStream(
+            new MemoryInputStream (memStream.getData(), memStream.getLength()));
+    std::unique_ptr<Reader> reader = createReader(pool, std::move(inStream));
+
+    for (bool lazyDecoding : {false, true}) {
+      RowReaderOptions rowReaderOpts;
+      rowReaderOpts.include({0, 1, 2, 3, 4});
+      rowReaderOpts.setEnableLazyDecoding(lazyDecoding);
+      rowReaderOpts.setRowFilter({2, 0}, std::make_shared<TestRowFilter>());
+      std::unique_ptr<RowReader> rowReader =
+        reader->createRowReader(rowReaderOpts);
+      batch = rowReader->createRowBatch(777);
+      structBatch = dynamic_cast<StructVectorBatch *>(batch.get());
+      ASSERT_EQ(5, structBatch->fields.size());
+      idBatch = dynamic_cast<LongVectorBatch *>(structBatch->fields[0]);
+      nameBatch = dynamic_cast<StringVectorBatch *>(structBatch->fields[1]);
+      scoreBatch = dynamic_cast<DoubleVectorBatch *>(structBatch->fields[2]);
+      tagsBatch = dynamic_cast<ListVectorBatch *>(structBatch->fields[3]);
+      catBatch = dynamic_cast<StringVectorBatch *>(structBatch->fields[4]);
+
+      uint64_t expected = 0;
+      while (rowReader->next(*batch)) {
+        ASSERT_LT(0, batch->numElements);
+        tagBatch = dynamic_cast<LongVectorBatch *>(tagsBatch->elements.get());
+        for (uint64_t i = 0; i < batch->numElements; ++i) {
+          while (expected % 11 == 0 ||
+                 !(expected % 10 < 3 || (expected >= 5000 && expected < 5600))) {
+            expected += 1;
+          }
+          ASSERT_EQ(expected, idBatch->data[i]);
+          EXPECT_EQ(static_cast<double>(expected) / 4, scoreBatch->data[i]);
+          EXPECT_EQ(expected % 7 != 0,
+                    !nameBatch->hasNulls || nameBatch->notNull[i]);
+          if (expected % 7 != 0) {
+            EXPECT_EQ(names[expected],
+                      std::string(nameBatch->data[i],
+                                  static_cast<size_t>(nameBatch->length[i])));
+          }
+          ASSERT_EQ(expected % 4, tagsBatch->offsets[i + 1] -
+                                    tagsBatch->offsets[i]);
+          for (uint64_t j = 0; j < expected % 4; ++j) {
+            EXPECT_EQ(expected + j, tagBatch->data[
+              static_cast<uint64_t>(tagsBatch->offsets[i]) + j]);
+          }
+          char* cat = catBatch->data[i];
+          int64_t catLength = catBatch->length[i];
+          if (catBatch->isEncoded) {
+            dynamic_cast<EncodedStringVectorBatch*>(catBatch)->dictionary
+              ->getValueByIndex(dynamic_cast<EncodedStringVectorBatch*>(
+                                  catBatch)->index[i], cat, catLength);
+          }
+          EXPECT_EQ(cats[expected],
+                    std::string(cat, static_cast<size_t>(catLength)));
+          expected += 1;
+        }
+      }
+      // every row after the last one returned is filtered out
+      for (; expected < rowCount; ++expected) {
+        EXPECT_TRUE(expected % 11 == 0 || (expected % 10 >= 3 &&
+                    (expected < 5000 || expected >= 5600)));
+      }
+      EXPECT_EQ(0, batch->numElements);
+    }
+
+    // the filter columns must be selected
+    RowReaderOptions rowReaderOpts;
+    rowReaderOpts.include({0, 1});
+    rowReaderOpts.setRowFilter({2, 0}, std::make_shared<TestRowFilter>());
+    EXPECT_THROW(reader->createRowReader(rowReaderOpts), std::logic_error);
+
+    // and each one can only be given once
+    rowReaderOpts = RowReaderOptions();
+    rowReaderOpts.setRowFilter({2, 0, 2}, std::make_shared<TestRowFilter>());
+    EXPECT_THROW(reader->createRowReader(rowReaderOpts), std::logic_error);
+  }
+
+  TEST_P(WriterTest, pushDownSearchArgument) {
+    MemoryOutputStream memStream(DEFAULT_MEM_STREAM_SIZE);
+    MemoryPool* pool = getDefaultPool();
+    ORC_UNIQUE_PTR<Type> type(Type::buildTypeFromString("struct<col1:bigint>"));
+
+    uint64_t stripeSize = 16 * 1024; // 16K
+    uint64_t compressionBlockSize = 1024; // 1k
+    uint64_t rowCount = 10000;
+
+    std::unique_ptr<Writer> writer = createWriter(
+                                      stripeSize,
+                                      compressionBlockSize,
+                                      CompressionKind_ZLIB,
+                                      *type,
+                                      pool,
+                                      &memStream,
+                                      fileVersion,
+                                      1000);
+    std::unique_ptr<ColumnVectorBatch> batch = writer->createRowBatch(rowCount);
+    StructVectorBatch* structBatch =
+      dynamic_cast<StructVectorBatch *>(batch.get());
+    LongVectorBatch* longBatch =
+      dynamic_cast<LongVectorBatch *>(structBatch->fields[0]);
+    for (uint64_t i = 0; i < rowCount; ++i) {
+      longBatch->data[i] = static_cast<int64_t>(i);
+    }
+    structBatch->numElements = rowCount;
+    longBatch->numElements = rowCount;
+    writer->add(*batch);
+    writer->close();
+
+    std::unique_ptr<InputStream> inStream(
+            new MemoryInputStream (memStream.getData(), memStream.getLength()));
+    std::unique_ptr<Reader> reader = createReader(pool, std::move(inStream));
+
+    // 4500 <= col1 < 6000 only needs the row groups from 4000 to 5999
+    RowReaderOptions rowReaderOpts;
+    rowReaderOpts.searchArgument(SearchArgumentFactory::newBuilder()
+      ->startAnd()
+      .startNot()
+      .lessThan("col1", PredicateDataType::LONG,
+                Literal(static_cast<int64_t>(4500)))
+      .end()
+      .lessThan("col1", PredicateDataType::LONG,
+                Literal(static_cast<int64_t>(6000)))
+      .end()
+      .build());
+    std::unique_ptr<RowReader> rowReader =
+      reader->createRowReader(rowReaderOpts);
+    batch = rowReader->createRowBatch(700);
+    structBatch = dynamic_cast<StructVectorBatch *>(batch.get());
+    longBatch = dynamic_cast<LongVectorBatch *>(structBatch->fields[0]);
+    std::vector<int64_t> values;
+    while (rowReader->next(*batch)) {
+      EXPECT_EQ(longBatch->data[0], rowReader->getRowNumber());
+      for (uint64_t i = 0; i < batch->numElements; ++i) {
+        values.push_back(longBatch->data[i]);
+      }
+    }
+    EXPECT_EQ(rowCount, rowReader->getRowNumber());
+    ASSERT_EQ(2000, values.size());
+    for (size_t i = 0; i < values.size(); ++i) {
+      EXPECT_EQ(4000 + static_cast<int64_t>(i), values[i]);
+    }
+
+    // seeking into a skipped row group moves on to the next selected one
+    rowReader->seekToRow(1234);
+    EXPECT_TRUE(rowReader->next(*batch));
+    EXPECT_EQ(4000, longBatch->data[0]);
+    EXPECT_EQ(4000, rowReader->getRowNumber());
+
+    // nothing matches
+    rowReaderOpts.searchArgument(SearchArgumentFactory::newBuilder()
+      ->equals("col1", PredicateDataType::LONG,
+               Literal(static_cast<int64_t>(20000)))
+      .build());
+    rowReader = reader->createRowReader(rowReaderOpts);
+    EXPECT_FALSE(rowReader->next(*batch));
+    EXPECT_EQ(0, batch->numElements);
+  }
+
+  TEST_P(WriterTest, prefetchStripes) {
+    MemoryOutputStream memStream(DEFAULT_MEM_STREAM_SIZE);
+    MemoryPool* pool = getDefaultPool();
+    ORC_UNIQUE_PTR<Type> type(Type::buildTypeFromString("struct<col1:bigint>"));
+
+    uint64_t stripeSize = 1024; // 1K
+    uint64_t compressionBlockSize = 1024; // 1k
+
+    std::unique_ptr<Writer> writer = createWriter(
+                                      stripeSize,
+                                      compressionBlockSize,
+                                      CompressionKind_ZLIB,
+                                      *type,
+                                      pool,
+                                      &memStream,
+                                      fileVersion);
+    std::unique_ptr<ColumnVectorBatch> batch = writer->createRowBatch(65535);
+    StructVectorBatch* structBatch =
+      dynamic_cast<StructVectorBatch*>(batch.get());
+    LongVectorBatch* longBatch =
+      dynamic_cast<LongVectorBatch*>(structBatch->fields[0]);
+    for (uint64_t j = 0; j < 5; ++j) {
+      for (uint64_t i = 0; i < 65535; ++i) {
+        // scrambled, so each batch is big enough to fill a stripe
+        longBatch->data[i] = static_cast<int64_t>((j * 65535 + i) * 7919 % 1000003);
+      }
+      structBatch->numElements = 65535;
+      longBatch->numElements = 65535;
+      writer->add(*batch);
+    }
+    writer->close();
+
+    std::unique_ptr<InputStream> inStream(
+            new MemoryInputStream (memStream.getData(), memStream.getLength()));
+    std::unique_ptr<Reader> reader = createReader(pool, std::move(inStream));
+    EXPECT_EQ(5, reader->getNumberOfStripes());
+
+    // prefetched stripes are read into memory whether or not reads are
+    // coalesced
+    for (bool isCoalesced : {false, true}) {
+      RowReaderOptions rowReaderOpts;
+      rowReaderOpts.setPrefetchDepth(3);
+      rowReaderOpts.setEnableCoalescedReads(isCoalesced);
+      std::unique_ptr<RowReader> rowReader =
+        reader->createRowReader(rowReaderOpts);
+      batch = rowReader->createRowBatch(10000);
+      structBatch = dynamic_cast<StructVectorBatch*>(batch.get());
+      longBatch = dynamic_cast<LongVectorBatch*>(structBatch->fields[0]);
+
+      uint64_t expected = 0;
+      bool hasSeeked = false;
+      while (rowReader->next(*batch)) {
+        for (uint64_t i = 0; i < batch->numElements; ++i) {
+          EXPECT_EQ(static_cast<int64_t>(expected * 7919 % 1000003),
+                    longBatch->data[i]);
+          ++expected;
+        }
+        // seek back once later stripes are being prefetched
+        if (!hasSeeked && expected >= 200000) {
+          rowReader->seekToRow(70000);
+          expected = 70000;
+          hasSeeked = true;
+        }
+      }
+      EXPECT_TRUE(hasSeeked);
+      EXPECT_EQ(5 * 65535, expected);
+    }
+  }
+
+#ifndef _MSC_VER
+  TEST_P(WriterTest, readMemoryMappedFile) {
+    MemoryOutputStream memStream(DEFAULT_MEM_STREAM_SIZE);
+    MemoryPool* pool = getDefaultPool();
+    ORC_UNIQUE_PTR<Type> type(
+      Type::buildTypeFromString("struct<col1:bigint,col2:string>"));
+    uint64_t rowCount = 5000;
+
+    std::unique_ptr<Writer> writer = createWriter(
+                                      16 * 1024,
+                                      1024,
+                                      CompressionKind_ZLIB,
+                                      *type,
+                                      pool,
+                                      &memStream,
+                                      fileVersion,
+                                      1000);
+    std::unique_ptr<ColumnVectorBatch> batch = writer->createRowBatch(rowCount);
+    StructVectorBatch* structBatch =
+      dynamic_cast<StructVectorBatch *>(batch.get());
+    LongVectorBatch* longBatch =
+      dynamic_cast<LongVectorBatch *>(structBatch->fields[0]);
+    StringVectorBatch* strBatch =
+      dynamic_cast<StringVectorBatch *>(structBatch->fields[1]);
+    std::vector<std::string> strs(rowCount);
+    for (uint64_t i = 0; i < rowCount; ++i) {
+      longBatch->data[i] = static_cast<int64_t>(i * 3);
+      strs[i] = "value" + std::to_string(i % 37);
+      strBatch->data[i] = const_cast<char*>(strs[i].c_str());
+      strBatch->length[i] = static_cast<int64_t>(strs[i].size());
+    }
+    structBatch->numElements = rowCount;
+    longBatch->numElements = rowCount;
+    strBatch->numElements = rowCount;
+    writer->add(*batch);
+    writer->close();
+
+    char filename[] = "/tmp/orc-mmap-XXXXXX";
+    int fd = mkstemp(filename);
+    ASSERT_NE(-1, fd);
+    ASSERT_EQ(static_cast<ssize_t>(memStream.getLength()),
+              ::write(fd, memStream.getData(), memStream.getLength()));
+    close(fd);
+
+    ReaderOptions readerOpts;
+    readerOpts.setMemoryPool(*pool);
+    readerOpts.setUseMemoryMapping(true);
+    std::unique_ptr<InputStream> inStream = readFile(filename, readerOpts);
+    ASSERT_NE(nullptr, inStream->getData(0, inStream->getLength()));
+    EXPECT_THROW(inStream->getData(inStream->getLength(), 1), ParseError);
+    std::unique_ptr<Reader> reader =
+      createReader(std::move(inStream), readerOpts);
+    std::unique_ptr<RowReader> rowReader = createRowReader(reader.get());
+
+    batch = rowReader->createRowBatch(1500);
+    structBatch = dynamic_cast<StructVectorBatch *>(batch.get());
+    longBatch = dynamic_cast<LongVectorBatch *>(structBatch->fields[0]);
+    strBatch = dynamic_cast<StringVectorBatch *>(structBatch->fields[1]);
+    uint64_t row = 0;
+    while (rowReader->next(*batch)) {
+      for (uint64_t i = 0; i < batch->numElements; ++i, ++row) {
+        EXPECT_EQ(static_cast<int64_t>(row * 3), longBatch->data[i]);
+        EXPECT_EQ(strs[row], std::string(strBatch->data[i],
+                                         static_cast<size_t>(strBatch->length[i])));
+      }
+    }
+    EXPECT_EQ(rowCount, row);
+    unlink(filename);
+  }
+#endif
+
+  static std::string writeWithThreads(FileVersion version,
+                                      uint64_t workerThreads,
+                                      uint64_t stripesInFlight) {
+    MemoryOutputStream memStream(DEFAULT_MEM_STREAM_SIZE);
+    ORC_UNIQUE_PTR<Type> type(Type::buildTypeFromString(
+      "struct<id:bigint,name:string,tags:array<string>,"
+      "info:struct<score:double,code:varchar(8)>>"));
+    WriterOptions options;
+    options.setStripeSize(64 * 1024);
+    options.setCompressionBlockSize(4 * 1024);
+    options.setCompression(CompressionKind_ZLIB);
+    options.setMemoryPool(getDefaultPool());
+    options.setRowIndexStride(1000);
+    options.setFileVersion(version);
+    options.setDictionaryKeySizeThreshold(0.5);
+    options.setColumnsUseBloomFilter({1, 2});
+    options.setWorkerThreads(workerThreads);
+    options.setMaxStripesInFlight(stripesInFlight);
+    std::unique_ptr<Writer> writer = createWriter(*type, &memStream, options);
+
+    uint64_t batchSize = 1500;
+    std::unique_ptr<ColumnVectorBatch> batch =
+      writer->createRowBatch(batchSize);
+    StructVectorBatch* structBatch =
+      dynamic_cast<StructVectorBatch *>(batch.get());
+    LongVectorBatch* idBatch =
+      dynamic_cast<LongVectorBatch *>(structBatch->fields[0]);
+    StringVectorBatch* nameBatch =
+      dynamic_cast<StringVectorBatch *>(structBatch->fields[1]);
+    ListVectorBatch* tagsBatch =
+      dynamic_cast<ListVectorBatch *>(structBatch->fields[2]);
+    StringVectorBatch* tagBatch =
+      dynamic_cast<StringVectorBatch *>(tagsBatch->elements.get());
+    StructVectorBatch* infoBatch =
+      dynamic_cast<StructVectorBatch *>(structBatch->fields[3]);
+    DoubleVectorBatch* scoreBatch =
+      dynamic_cast<DoubleVectorBatch *>(infoBatch->fields[0]);
+    StringVectorBatch* codeBatch =
+      dynamic_cast<StringVectorBatch *>(infoBatch->fields[1]);
+    tagBatch->resize(batchSize * 2);
+
+    std::vector<std::string> names(batchSize);
+    std::vector<std::string> codes(batchSize);
+    const char* tags[] = {"red", "green", "blue"};
+    for (uint64_t start = 0; start < 30000; start += batchSize) {
+      uint64_t tagCount = 0;
+      nameBatch->hasNulls = true;
+      for (uint64_t i = 0; i < batchSize; ++i) {
+        uint64_t row = start + i;
+        idBatch->data[i] = static_cast<int64_t>(row);
+        names[i] = std::to_string(row * 2654435761ULL % 1000000007);
+        nameBatch->notNull[i] = row % 7 != 0;
+        nameBatch->data[i] = const_cast<char*>(names[i].c_str());
+        nameBatch->length[i] = static_cast<int64_t>(names[i].size());
+        tagsBatch->offsets[i] = static_cast<int64_t>(tagCount);
+        for (uint64_t j = 0; j < row % 3; ++j, ++tagCount) {
+          const char* tag = tags[(row + j) % 3];
+          tagBatch->data[tagCount] = const_cast<char*>(tag);
+          tagBatch->length[tagCount] = static_cast<int64_t>(strlen(tag));
+          tagBatch->notNull[tagCount] = 1;
+        }
+        scoreBatch->data[i] = static_cast<double>(row) / 8;
+        codes[i] = "c" + std::to_string(row % 50);
+        codeBatch->data[i] = const_cast<char*>(codes[i].c_str());
+        codeBatch->length[i] = static_cast<int64_t>(codes[i].size());
+      }
+      tagsBatch->offsets[batchSize] = static_cast<int64_t>(tagCount);
+      structBatch->numElements = batchSize;
+      idBatch->numElements = batchSize;
+      nameBatch->numElements = batchSize;
+      tagsBatch->numElements = batchSize;
+      tagBatch->numElements = tagCount;
+      infoBatch->numElements = batchSize;
+      scoreBatch->numElements = batchSize;
+      codeBatch->numElements = batchSize;
+      writer->add(*batch);
+      if (start == 15000) {
+        writer->addUserMetadata("half", std::to_string(start));
+      }
+    }
+    writer->close();
+    return std::string(memStream.getData(), memStream.getLength());
+  }
+
+  TEST_P(WriterTest, workerThreads) {
+    std::string serial = writeWithThreads(fileVersion, 0, 0);
+    std::string parallel = writeWithThreads(fileVersion, 3, 0);
+    EXPECT_TRUE(serial == parallel);
+
+    std::unique_ptr<Reader> reader = createReader(getDefaultPool(),
+      std::unique_ptr<InputStream>(
+        new MemoryInputStream(parallel.data(), parallel.size())));
+    EXPECT_EQ(30000, reader->getNumberOfRows());
+    EXPECT_LT(1, reader->getNumberOfStripes());
+
+    std::unique_ptr<RowReader> rowReader = createRowReader(reader.get());
+    std::unique_ptr<ColumnVectorBatch> batch = rowReader->createRowBatch(1024);
+    StructVectorBatch* structBatch =
+      dynamic_cast<StructVectorBatch *>(batch.get());
+    LongVectorBatch* idBatch =
+      dynamic_cast<LongVectorBatch *>(structBatch->fields[0]);
+    StringVectorBatch* nameBatch =
+      dynamic_cast<StringVectorBatch *>(structBatch->fields[1]);
+    uint64_t row = 0;
+    while (rowReader->next(*batch)) {
+      for (uint64_t i = 0; i < batch->numElements; ++i, ++row) {
+        EXPECT_EQ(static_cast<int64_t>(row), idBatch->data[i]);
+        if (row % 7 == 0) {
+          EXPECT_FALSE(nameBatch->notNull[i]);
+        } else {
+          EXPECT_EQ(std::to_string(row * 2654435761ULL % 1000000007),
+                    std::string(nameBatch->data[i],
+                                static_cast<size_t>(nameBatch->length[i])));
+        }
+      }
+    }
+    EXPECT_EQ(30000, row);
+  }
+
+  TEST_P(WriterTest, stripesInFlight) {
+    std::string serial = writeWithThreads(fileVersion, 0, 0);
+    EXPECT_TRUE(serial == writeWithThreads(fileVersion, 0, 1));
+    EXPECT_TRUE(serial == writeWithThreads(fileVersion, 0, 3));
+    EXPECT_TRUE(serial == writeWithThreads(fileVersion, 2, 2));
+
+    std::unique_ptr<Reader> reader = createReader(getDefaultPool(),
+      std::unique_ptr<InputStream>(
+        new MemoryInputStream(serial.data(), serial.size())));
+    EXPECT_LT(3, reader->getNumberOfStripes());
+    EXPECT_EQ("15000", reader->getMetadataValue("half"));
+    std::unique_ptr<ColumnStatistics> idStats = reader->getColumnStatistics(1);
+    EXPECT_EQ(30000, idStats->getNumberOfValues());
+  }
+
   INSTANTIATE_TEST_CASE_P(OrcTest, WriterTest, Values(FileVersion::v_0_11(), FileVersion::v_0_12()));
 }
@@ -294,9 +294,31 @@ void usage() {
             << "                  [-s <size>] [--stripe=<size>]\n"
             << "                  [-c <size>] [--block=<size>]\n"
             << "                  [-b <size>] [--batch=<size>]\n"
+            << "                  [-t <count>] [--threads=<count>]\n"
+            << "                  [-z <codec>] [--compression=<codec>]\n"
             << "                  <schema> <input> <output>\n"
             << "Import CSV file into an Orc file using the specified schema.\n"
-            << "Compound types are not yet supported.\n";
+            << "Compound types are not yet supported.\n"
+            << "The codec is one of none, zlib (the default), snappy, lz4 "
+            << "and zstd.\n";
+}
+
+bool parseCompression(const std::string& name,
+                      orc::CompressionKind& compression) {
+  const std::pair<const char*, orc::CompressionKind> codecs[] = {
+    {"none", orc::CompressionKind_NONE},
+    {"zlib", orc::CompressionKind_ZLIB},
+    {"snappy", orc::CompressionKind_SNAPPY},
+    {"lz4", orc::CompressionKind_LZ4},
+    {"zstd", orc::CompressionKind_ZSTD}
+  };
+  for (const auto& codec : codecs) {
+    if (name == codec.first) {
+      compression = codec.second;
+      return true;
+    }
+  }
+  return false;
 }
 
 int main(int argc, char* argv[]) {
@@ -306,6 +328,7 @@ int main(int argc, char* argv[]) {
   uint64_t stripeSize = (128 << 20); // 128M
   uint64_t blockSize = 64 << 10;     // 64K
   uint64_t batchSize = 1024;
+  uint64_t workerThreads = 0;
   orc::CompressionKind compression = orc::CompressionKind_ZLIB;
 
   static struct option longOptions[] = {
@@ -314,13 +337,15 @@ int main(int argc, char* argv[]) {
     {"stripe", required_argument, ORC_NULLPTR, 'p'},
     {"block", required_argument, ORC_NULLPTR, 'c'},
     {"batch", required_argument, ORC_NULLPTR, 'b'},
+    {"threads", required_argument, ORC_NULLPTR, 't'},
+    {"compression", required_argument, ORC_NULLPTR, 'z'},
     {ORC_NULLPTR, 0, ORC_NULLPTR, 0}
   };
   bool helpFlag = false;
   int opt;
   char *tail;
   do {
-    opt = getopt_long(argc, argv, "i:o:s:b:c:p:h", longOptions, ORC_NULLPTR);
+    opt = getopt_long(argc, argv, "i:o:s:b:c:p:t:z:h", longOptions, ORC_NULLPTR);
     switch (opt) {
       case '?':
       case 'h':
@@ -351,6 +376,19 @@ int main(int argc, char* argv[]) {
           return 1;
         }
         break;
+      case 't':
+        workerThreads = strtoul(optarg, &tail, 10);
+        if (*tail != '\0') {
+          fprintf(stderr, "The --threads parameter requires an integer option.\n");
+          return 1;
+        }
+        break;
+      case 'z':
+        if (!parseCompression(optarg, compression)) {
+          fprintf(stderr, "Unknown codec for --compression: %s\n", optarg);
+          return 1;
+        }
+        break;
     }
   } while (opt != -1);
 
@@ -378,6 +416,7 @@ int main(int argc, char* argv[]) {
   options.setStripeSize(stripeSize);
   options.setCompressionBlockSize(blockSize);
   options.setCompression(compression);
+  options.setWorkerThreads(workerThreads);
 
   ORC_UNIQUE_PTR<orc::OutputStream> outStream = orc::writeLocalFile(output);
   ORC_UNIQUE_PTR<orc::Writer> writer =
@@ -19,46 +19,357 @@
 #include "orc/orc-config.hh"
 #include "orc/ColumnPrinter.hh"
 #include "orc/Exceptions.hh"
+#include "orc/sargs/SearchArgument.hh"
 
+#include <algorithm>
+#include <condition_variable>
+#include <map>
+#include <exception>
+#include <limits>
 #include <memory>
+#include <mutex>
+#include <stdexcept>
 #include <string>
 #include <iostream>
 #include <string>
+#include <thread>
+#include <vector>
 
-void printContents(const char* filename, const orc::RowReaderOptions& rowReaderOpts) {
+void printStripeContents(const orc::Reader& reader,
+                         const orc::RowReaderOptions& rowReaderOpts,
+                         const orc::StripeInformation& stripe,
+                         orc::FloatFormat floatFormat,
+                         std::string& output) {
+  orc::RowReaderOptions stripeOpts(rowReaderOpts);
+  stripeOpts.range(stripe.getOffset(), stripe.getLength());
+  std::unique_ptr<orc::RowReader> rowReader =
+    reader.createRowReader(stripeOpts);
+
+  std::unique_ptr<orc::ColumnVectorBatch> batch = rowReader->createRowBatch(1000);
+  std::unique_ptr<orc::ColumnPrinter> printer =
+    createColumnPrinter(output, &rowReader->getSelectedType(), floatFormat);
+
+  while (rowReader->next(*batch)) {
+    printer->reset(*batch);
+    printer->printBatch(batch->numElements);
+  }
+}
+
+/**
+ * Print the file with one task per stripe spread over numThreads workers.
+ * Each worker renders a stripe into its own buffer through its own RowReader
+ * and the calling thread writes the buffers out in stripe order, so the
+ * output is identical to the single-threaded one. At most 2 * numThreads
+ * rendered stripes are held in memory at any time.
+ */
+void printContentsParallel(const orc::Reader& reader,
+                           const orc::RowReaderOptions& rowReaderOpts,
+                           orc::FloatFormat floatFormat,
+                           unsigned int numThreads,
+                           orc::OutputSink& sink) {
+  std::vector<std::unique_ptr<orc::StripeInformation>> stripes;
+  uint64_t rangeStart = rowReaderOpts.getOffset();
+  uint64_t rangeEnd = rowReaderOpts.getLength() >
+    std::numeric_limits<uint64_t>::max() - rangeStart ?
+      std::numeric_limits<uint64_t>::max() :
+      rangeStart + rowReaderOpts.getLength();
+  for (uint64_t i = 0; i < reader.getNumberOfStripes(); ++i) {
+    std::unique_ptr<orc::StripeInformation> stripe = reader.getStripe(i);
+    if (stripe->getOffset() >= rangeStart && stripe->getOffset() < rangeEnd) {
+      stripes.push_back(std::move(stripe));
+    }
+  }
+
+  const size_t window = 2 * static_cast<size_t>(numThreads);
+  std::vector<std::string> outputs(stripes.size());
+  std::vector<bool> finished(stripes.size(), false);
+  size_t nextStripe = 0;
+  size_t nextToWrite = 0;
+  bool failed = false;
+  std::exception_ptr error;
+  std::mutex mutex;
+  std::condition_variable cond;
+
+  auto worker = [&]() {
+    while (true) {
+      size_t stripeIx;
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        cond.wait(lock, [&]() {
+            return failed || nextStripe >= stripes.size() ||
+              nextStripe < nextToWrite + window;
+          });
+        if (failed || nextStripe >= stripes.size()) {
+          return;
+        }
+        stripeIx = nextStripe++;
+      }
+      std::string output;
+      try {
+        printStripeContents(reader, rowReaderOpts, *stripes[stripeIx],
+                            floatFormat, output);
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!failed) {
+          failed = true;
+          error = std::current_exception();
+        }
+        cond.notify_all();
+        return;
+      }
+      std::lock_guard<std::mutex> lock(mutex);
+      outputs[stripeIx].swap(output);
+      finished[stripeIx] = true;
+      cond.notify_all();
+    }
+  };
+
+  std::vector<std::thread> workers;
+  for (unsigned int i = 0; i < numThreads; ++i) {
+    workers.push_back(std::thread(worker));
+  }
+
+  while (true) {
+    std::string output;
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      cond.wait(lock, [&]() {
+          return failed || nextToWrite >= stripes.size() ||
+            finished[nextToWrite];
+        });
+      if (failed || nextToWrite >= stripes.size()) {
+        break;
+      }
+      output.swap(outputs[nextToWrite]);
+      nextToWrite += 1;
+      cond.notify_all();
+    }
+    // hand the stripe over without copying it. A stripe smaller than the
+    // sink's buffer is appended to what is already there, so the writes
+    // stay large.
+    try {
+      std::string& buffer = sink.getBuffer();
+      if (buffer.empty()) {
+        buffer.swap(output);
+      } else {
+        buffer.append(output);
+      }
+      sink.commit();
+    } catch (...) {
+      // stop the workers, which have to be joined before the error is
+      // thrown
+      std::lock_guard<std::mutex> lock(mutex);
+      if (!failed) {
+        failed = true;
+        error = std::current_exception();
+      }
+      cond.notify_all();
+      break;
+    }
+  }
+
+  for (auto& thread : workers) {
+    thread.join();
+  }
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+/**
+ * Build a search argument from a filter of the form <column><op><value>,
+ * where column is a top-level column name and op is one of =, <, <=, >
+ * and >=.
+ */
+std::unique_ptr<orc::SearchArgument> buildFilter(const orc::Type& schema,
+                                                 const std::string& filter) {
+  size_t opStart = filter.find_first_of("<>=");
+  if (opStart == 0 || opStart == std::string::npos) {
+    throw std::invalid_argument("Bad filter: " + filter);
+  }
+  size_t opEnd = filter.find_first_not_of("<>=", opStart);
+  if (opEnd == std::string::npos) {
+    throw std::invalid_argument("Bad filter: " + filter);
+  }
+  std::string column = filter.substr(0, opStart);
+  std::string op = filter.substr(opStart, opEnd - opStart);
+  std::string value = filter.substr(opEnd);
+
+  const orc::Type* columnType = ORC_NULLPTR;
+  for (uint64_t i = 0; i < schema.getSubtypeCount(); ++i) {
+    if (schema.getFieldName(i) == column) {
+      columnType = schema.getSubtype(i);
+    }
+  }
+  if (columnType == ORC_NULLPTR) {
+    throw std::invalid_argument("Unknown filter column: " + column);
+  }
+
+  orc::PredicateDataType type;
+  std::unique_ptr<orc::Literal> literal;
+  switch (columnType->getKind()) {
+  case orc::BYTE:
+  case orc::SHORT:
+  case orc::INT:
+  case orc::LONG:
+    type = orc::PredicateDataType::LONG;
+    literal.reset(new orc::Literal(
+      static_cast<int64_t>(std::stoll(value))));
+    break;
+  case orc::FLOAT:
+  case orc::DOUBLE:
+    type = orc::PredicateDataType::FLOAT;
+    literal.reset(new orc::Literal(std::stod(value)));
+    break;
+  case orc::STRING:
+  case orc::VARCHAR:
+  case orc::CHAR:
+    type = orc::PredicateDataType::STRING;
+    literal.reset(new orc::Literal(value.c_str(), value.size()));
+    break;
+  default:
+    throw std::invalid_argument("Can't filter on column " + column +
+                                " of type " + columnType->toString());
+  }
+
+  std::unique_ptr<orc::SearchArgumentBuilder> builder =
+    orc::SearchArgumentFactory::newBuilder();
+  if (op == "=") {
+    builder->equals(column, type, *literal);
+  } else if (op == "<") {
+    builder->lessThan(column, type, *literal);
+  } else if (op == "<=") {
+    builder->lessThanEquals(column, type, *literal);
+  } else if (op == ">") {
+    builder->startNot().lessThanEquals(column, type, *literal).end();
+  } else if (op == ">=") {
+    builder->startNot().lessThan(column, type, *literal).end();
+  } else {
+    throw std::invalid_argument("Bad filter operator: " + op);
+  }
+  return builder->build();
+}
+
+/**
+ * Print the reader metrics as a JSON object.
+ */
+void printMetrics(const orc::ReaderMetrics& metrics, std::ostream& out) {
+  out << "{\"streams\": {";
+  const char* separator = "";
+  for (const auto& entry : metrics.getStreamReads()) {
+    out << separator << "\"" << orc::streamKindToString(entry.first)
+        << "\": {\"readCalls\": " << entry.second.readCalls
+        << ", \"bytesRead\": " << entry.second.bytesRead << "}";
+    separator = ", ";
+  }
+  out << "},\n \"decompression\": {";
+  separator = "";
+  for (const auto& entry : metrics.getDecompression()) {
+    out << separator << "\"" << orc::compressionKindToString(entry.first)
+        << "\": {\"blocks\": " << entry.second.blocks
+        << ", \"compressedBytes\": " << entry.second.compressedBytes
+        << ", \"decompressedBytes\": " << entry.second.decompressedBytes
+        << ", \"nanoseconds\": " << entry.second.nanoseconds << "}";
+    separator = ", ";
+  }
+  out << "},\n \"columns\": {";
+  separator = "";
+  for (const auto& entry : metrics.getColumnDecoding()) {
+    out << separator << "\"" << entry.first
+        << "\": {\"calls\": " << entry.second.calls
+        << ", \"values\": " << entry.second.values
+        << ", \"nanoseconds\": " << entry.second.nanoseconds << "}";
+    separator = ",\n   ";
+  }
+  out << "},\n \"stripesRead\": " << metrics.getStripesRead()
+      << ", \"stripesSkipped\": " << metrics.getStripesSkipped()
+      << ", \"rowGroupsRead\": " << metrics.getRowGroupsRead()
+      << ", \"rowGroupsSkipped\": " << metrics.getRowGroupsSkipped()
+      << "}\n";
+}
+
+void printContents(const char* filename, const orc::RowReaderOptions& options,
+                   const std::string& filter, orc::FloatFormat floatFormat,
+                   unsigned int numThreads, bool printStats,
+                   bool useMemoryMapping) {
   orc::ReaderOptions readerOpts;
+  // the stripes are decoded straight from the mapped file, but a file
+  // that shrinks while it is mapped kills the process with SIGBUS
+  readerOpts.setUseMemoryMapping(useMemoryMapping);
+  std::shared_ptr<orc::ReaderMetrics> metrics;
+  if (printStats) {
+    metrics.reset(new orc::ReaderMetrics());
+    readerOpts.setReaderMetrics(metrics);
+  }
   std::unique_ptr<orc::Reader> reader;
   std::unique_ptr<orc::RowReader> rowReader;
-  reader = orc::createReader(orc::readFile(std::string(filename)), readerOpts);
+  reader = orc::createReader(orc::readFile(std::string(filename), readerOpts),
+                             readerOpts);
+  orc::RowReaderOptions rowReaderOpts(options);
+  if (!filter.empty()) {
+    rowReaderOpts.searchArgument(buildFilter(reader->getType(), filter));
+  }
+  std::unique_ptr<orc::OutputSink> sink =
+    orc::createFileDescriptorSink(fileno(stdout));
+  if (numThreads > 1) {
+    printContentsParallel(*reader, rowReaderOpts, floatFormat, numThreads,
+                          *sink);
+    sink->flush();
+    if (metrics) {
+      printMetrics(*metrics, std::cerr);
+    }
+    return;
+  }
   rowReader = reader->createRowReader(rowReaderOpts);
 
   std::unique_ptr<orc::ColumnVectorBatch> batch = rowReader->createRowBatch(1000);
-  std::string line;
   std::unique_ptr<orc::ColumnPrinter> printer =
-    createColumnPrinter(line, &rowReader->getSelectedType());
+    createColumnPrinter(sink->getBuffer(), &rowReader->getSelectedType(),
+                        floatFormat);
 
   while (rowReader->next(*batch)) {
     printer->reset(*batch);
-    for(unsigned long i=0; i < batch->numElements; ++i) {
-      line.clear();
-      printer->printRow(i);
-      line += "\n";
-      const char* str = line.c_str();
-      fwrite(str, 1, strlen(str), stdout);
-    }
+    printer->printBatch(batch->numElements);
+    sink->commit();
+  }
+  sink->flush();
+  if (metrics) {
+    printMetrics(*rowReader->getReaderMetrics(), std::cerr);
   }
 }
 
 int main(int argc, char* argv[]) {
   if (argc < 2) {
-    std::cout << "Usage: orc-contents <filename> [--columns=1,2,...]\n"
+    std::cout << "Usage: orc-contents <filename> [--columns=1,2,...] [--threads=<n>]"
+              << " [--shortest-floats] [--filter=<column><op><value>]"
+              << " [--stats] [--mmap]\n"
               << "Print contents of <filename>.\n"
-              << "If columns are specified, only these top-level (logical) columns are printed.\n" ;
+              << "If columns are specified, only these top-level (logical) columns are printed.\n"
+              << "If a filter is given, stripes and row groups whose statistics show that\n"
+              << "no row can match are skipped. The op is one of =, <, <=, > and >=.\n"
+              << "Rows that are read are printed whether they match or not.\n"
+              << "If threads is greater than 1, stripes are converted in parallel.\n"
+              << "If shortest-floats is given, floating point values are printed with\n"
+              << "all the digits needed to read them back exactly.\n"
+              << "If stats is given, the bytes read, the decompression and the\n"
+              << "decoding time by column are printed to stderr as JSON.\n"
+              << "If mmap is given, the file is memory mapped rather than read.\n"
+              << "The file must not be truncated while it is printed.\n" ;
     return 1;
   }
   try {
     const std::string COLUMNS_PREFIX = "--columns=";
+    const std::string THREADS_PREFIX = "--threads=";
+    const std::string SHORTEST_FLOATS = "--shortest-floats";
+    const std::string FILTER_PREFIX = "--filter=";
+    const std::string STATS = "--stats";
+    const std::string MMAP = "--mmap";
+    std::string filter;
+    bool printStats = false;
+    bool useMemoryMapping = false;
     std::list<uint64_t> cols;
+    unsigned int numThreads = 1;
+    orc::FloatFormat floatFormat = orc::FloatFormat_FIXED_PRECISION;
     char* filename = ORC_NULLPTR;
 
     // Read command-line options
@@ -70,16 +381,40 @@ int main(int argc, char* argv[]) {
           cols.push_back(static_cast<uint64_t>(std::atoi(value)));
           value = std::strtok(ORC_NULLPTR, "," );
         }
+      } else if ( (param = std::strstr(argv[i], THREADS_PREFIX.c_str())) ) {
+        int threads = std::atoi(param + THREADS_PREFIX.length());
+        if (threads < 1) {
+          std::cerr << "The --threads parameter requires a positive integer.\n";
+          return 1;
+        }
+        numThreads = static_cast<unsigned int>(threads);
+      } else if ( (param = std::strstr(argv[i], FILTER_PREFIX.c_str())) ) {
+        filter = param + FILTER_PREFIX.length();
+      } else if (SHORTEST_FLOATS == argv[i]) {
+        floatFormat = orc::FloatFormat_SHORTEST;
+      } else if (STATS == argv[i]) {
+        printStats = true;
+      } else if (MMAP == argv[i]) {
+        useMemoryMapping = true;
       } else {
         filename = argv[i];
       }
     }
     orc::RowReaderOptions rowReaderOpts;
+    // dictionary encoded strings are printed straight from the dictionary
+    rowReaderOpts.setEnableLazyDecoding(true);
+    // every stripe is read whole, so read its columns with a few large
+    // reads
+    rowReaderOpts.setEnableCoalescedReads(true);
+    // read the next stripe while this one is printed, which readFile's
+    // local file streams allow
+    rowReaderOpts.setPrefetchDepth(1);
     if (cols.size() > 0) {
       rowReaderOpts.include(cols);
     }
     if (filename != ORC_NULLPTR) {
-      printContents(filename, rowReaderOpts);
+      printContents(filename, rowReaderOpts, filter, floatFormat, numThreads,
+                    printStats, useMemoryMapping);
     }
   } catch (std::exception& ex) {
     std::cerr << "Caught exception: " << ex.what() << "\n";
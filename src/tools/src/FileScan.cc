@@ -26,11 +26,15 @@
 #include <iostream>
 #include <string>
 
-void scanFile(std::ostream & out, const char* filename, uint64_t batchSize) {
+void scanFile(std::ostream & out, const char* filename, uint64_t batchSize,
+              uint64_t batchMemory) {
   orc::ReaderOptions readerOpts;
   std::unique_ptr<orc::Reader> reader =
     orc::createReader(orc::readFile(filename), readerOpts);
-  std::unique_ptr<orc::RowReader> rowReader = reader->createRowReader();
+  orc::RowReaderOptions rowReaderOpts;
+  rowReaderOpts.setBatchMemoryBudget(batchMemory);
+  std::unique_ptr<orc::RowReader> rowReader =
+    reader->createRowReader(rowReaderOpts);
   std::unique_ptr<orc::ColumnVectorBatch> batch =
     rowReader->createRowBatch(batchSize);
 
@@ -48,14 +52,16 @@ int main(int argc, char* argv[]) {
   static struct option longOptions[] = {
     {"help", no_argument, ORC_NULLPTR, 'h'},
     {"batch", required_argument, ORC_NULLPTR, 'b'},
+    {"memory", required_argument, ORC_NULLPTR, 'm'},
     {ORC_NULLPTR, 0, ORC_NULLPTR, 0}
   };
   bool helpFlag = false;
   uint64_t batchSize = 1024;
+  uint64_t batchMemory = 0;
   int opt;
   char *tail;
   do {
-    opt = getopt_long(argc, argv, "hb:", longOptions, ORC_NULLPTR);
+    opt = getopt_long(argc, argv, "hb:m:", longOptions, ORC_NULLPTR);
     switch (opt) {
     case '?':
     case 'h':
@@ -69,6 +75,13 @@ int main(int argc, char* argv[]) {
         return 1;
       }
       break;
+    case 'm':
+      batchMemory = strtoul(optarg, &tail, 10);
+      if (*tail != '\0') {
+        fprintf(stderr, "The --memory parameter requires an integer option.\n");
+        return 1;
+      }
+      break;
     }
   } while (opt != -1);
   argc -= optind;
@@ -76,12 +89,13 @@ int main(int argc, char* argv[]) {
 
   if (argc < 1 || helpFlag) {
     std::cerr << "Usage: orc-scan [-h] [--help]\n"
-              << "                [-b<size>] [--batch=<size>] <filename>\n";
+              << "                [-b<size>] [--batch=<size>]\n"
+              << "                [-m<bytes>] [--memory=<bytes>] <filename>\n";
     return 1;
   } else {
     for(int i=0; i < argc; ++i) {
       try {
-        scanFile(std::cout, argv[i], batchSize);
+        scanFile(std::cout, argv[i], batchSize, batchMemory);
       } catch (std::exception& ex) {
         std::cerr << "Caught exception in " << argv[i]
                   << ": " << ex.what() << "\n";
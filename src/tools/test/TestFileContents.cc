@@ -67,3 +67,18 @@ TEST (TestFileContents, testSelectedColumns) {
   EXPECT_EQ(expected, output);
   EXPECT_EQ("", error);
 }
+
+TEST (TestFileContents, testThreads) {
+  const std::string pgm = findProgram("tools/src/orc-contents");
+  const std::string file = findExample("demo-12-zlib.orc");
+
+  std::string expected;
+  std::string output;
+  std::string error;
+
+  EXPECT_EQ(0, runProgram({pgm, file}, expected, error));
+  EXPECT_EQ("", error);
+  EXPECT_EQ(0, runProgram({pgm, "--threads=4", file}, output, error));
+  EXPECT_EQ(expected, output);
+  EXPECT_EQ("", error);
+}
@@ -104,7 +104,8 @@ TEST (TestFileScan, testBadCommand) {
   EXPECT_EQ("", output);
   EXPECT_EQ("orc-scan: option requires an argument -- b\n"
             "Usage: orc-scan [-h] [--help]\n"
-            "                [-b<size>] [--batch=<size>] <filename>\n",
+            "                [-b<size>] [--batch=<size>]\n"
+            "                [-m<bytes>] [--memory=<bytes>] <filename>\n",
             removeChars(stripPrefix(error, "orc-scan: "),"'`"));
 
   EXPECT_EQ(1, runProgram({pgm, file, std::string("-b"),
@@ -122,7 +123,8 @@ TEST (TestFileScan, testBadCommand) {
   EXPECT_EQ("", output);
   EXPECT_EQ("orc-scan: option --batch requires an argument\n"
             "Usage: orc-scan [-h] [--help]\n"
-            "                [-b<size>] [--batch=<size>] <filename>\n",
+            "                [-b<size>] [--batch=<size>]\n"
+            "                [-m<bytes>] [--memory=<bytes>] <filename>\n",
             removeChars(stripPrefix(error, "orc-scan: "), "'`"));
 
   EXPECT_EQ(1, runProgram({pgm, file, std::string("--batch"),